@@ -0,0 +1,85 @@
+//  boost/timer/async_sink.hpp  --------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_ASYNC_SINK_HPP                  
+#define BOOST_TIMER_ASYNC_SINK_HPP
+
+#include <boost/timer/timer.hpp>
+
+#if defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+# error <boost/timer/async_sink.hpp> requires C++11 atomics, threads, and thread_local
+#endif
+
+#include <boost/cstdint.hpp>
+#include <cstddef>
+#include <iosfwd>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+//--------------------------------------------------------------------------------------//
+
+//  An async_sink formats and writes reports on a background thread, so that the threads
+//  being timed never wait for I/O. push() copies the times and a format_view into a
+//  bounded lock-free ring; the background thread formats whatever has accumulated and
+//  writes it to the stream in one batch.
+//
+//  When the ring is full, push() either drops the report (drop_on_overflow, counted by
+//  dropped()) or waits for the background thread to make room (block_on_overflow).
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  class BOOST_TIMER_DECL async_sink
+  {
+  public:
+    enum overflow_policy { drop_on_overflow, block_on_overflow };
+
+    //  capacity is rounded up to a power of two. os is written only by the background
+    //  thread until the async_sink is destroyed.
+    explicit async_sink(std::ostream& os, std::size_t capacity = 1024,
+                        overflow_policy policy = drop_on_overflow);
+
+    //  Writes any reports still in the ring and flushes the stream. No push() may be
+    //  in progress or follow.
+   ~async_sink();
+
+    //  The text and segments referred to by fmt must remain valid until the report
+    //  is written; flush() guarantees that. Returns false if the report was dropped.
+    bool              push(const cpu_times& times, short places, const format_view& fmt);
+    bool              push(const cpu_times& times, short places = default_places)
+                        { return push(times, places, default_view()); }
+
+    //  Returns once every report pushed before the call has been written and the
+    //  stream flushed.
+    void              flush();
+
+    std::ostream&     stream() const;
+    std::size_t       capacity() const;
+    overflow_policy   policy() const;
+    format_view       default_view() const;  // of default_format()
+    boost::uint64_t   written() const;
+    boost::uint64_t   dropped() const;
+
+  private:
+    struct impl;
+    impl*  m_impl;
+
+    async_sink(const async_sink&);             // noncopyable
+    async_sink& operator=(const async_sink&);
+  };
+
+} // namespace timer
+} // namespace boost
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_ASYNC_SINK_HPP
@@ -0,0 +1,147 @@
+//  boost/timer/baseline.hpp  ----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_BASELINE_HPP
+#define BOOST_TIMER_BASELINE_HPP
+
+#include <boost/timer/benchmark.hpp>
+#include <boost/cstdint.hpp>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+#   if defined(_MSC_VER)
+#     pragma warning(push)           // Save warning settings
+#     pragma warning(disable : 4251) // disable warning: class 'std::basic_string<_Elem,_Traits,_Ax>'
+#   endif                            // needs to have dll-interface...
+
+//--------------------------------------------------------------------------------------//
+
+//  A baseline keeps the samples of benchmark results, with the machine and clocks they
+//  were measured on, so that later results can be compared with them. compare() tests
+//  each case for a difference with a Mann-Whitney U test, which assumes nothing about
+//  the distribution of the samples, and gives a bootstrap confidence interval for the
+//  ratio of the medians.
+//
+//  File format, a line per item, in the classic locale:
+//    boost_timer_baseline 1
+//    meta <key> <value to the end of the line>     zero or more
+//    case <iterations> <overhead> <name to the end of the line>
+//    sample <wall> <user> <system>                 one or more per case, of the
+//                                                  iterations, in nanoseconds
+//  Readers ignore meta keys and line types they do not know.
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+
+//  baseline  --------------------------------------------------------------------------//
+
+  struct baseline_metadata
+  {
+    std::string           host;                  // empty if unknown
+    std::string           label;                 // as given, e.g. a commit id
+    boost::int_least64_t  created;               // seconds since the epoch
+    std::string           wall_clock;            // wall_clock_name(wall_clock())
+    bool                  wall_clock_steady;
+    bool                  tsc_invariant;
+    double                tsc_frequency;         // ticks per second; 0 if not
+                                                 //   invariant
+    std::string           cpu_clock;             // cpu_clock_name(cpu_clock())
+    nanosecond_type       cpu_clock_resolution;  // nominal; -1 if unavailable
+    cpu_times             timer_overhead;        // timer_overhead<
+                                                 //   process_times_policy>()
+  };
+
+  struct baseline_case
+  {
+    std::string             name;
+    boost::uint64_t         iterations;      // per sample
+    double                  overhead;        // ns to subtract from each sample's wall
+    std::vector<cpu_times>  samples;         // each of iterations, as measured
+  };
+
+  struct baseline
+  {
+    baseline_metadata           metadata;
+    std::vector<baseline_case>  cases;
+  };
+
+  //  The metadata of this machine and its clocks, as they are now.
+  BOOST_TIMER_DECL baseline_metadata current_metadata(const std::string& label = "");
+
+  //  Makes a baseline of results, with current_metadata(label).
+  BOOST_TIMER_DECL baseline make_baseline(const std::vector<benchmark_result>& results,
+                                          const std::string& label = "");
+
+  BOOST_TIMER_DECL void  write_baseline(std::ostream& os, const baseline& b);
+
+  //  Returns false, leaving b unspecified, if in is not a baseline of a known version,
+  //  or is malformed.
+  BOOST_TIMER_DECL bool  read_baseline(std::istream& in, baseline& b);
+
+//  comparison  ------------------------------------------------------------------------//
+
+  //  The two-sided p-value of the Mann-Whitney U test of a and b being samples of the
+  //  same distribution; exact if there are no ties and both have at most 50 values,
+  //  else by the normal approximation with a correction for ties. 1 if either is empty.
+  BOOST_TIMER_DECL double mann_whitney_p(const std::vector<double>& a,
+                                         const std::vector<double>& b);
+
+  struct compare_options
+  {
+    bool              cpu;         // compare user + system time rather than wall time;
+                                   //   default false
+    double            alpha;       // significance level; default 0.05
+    double            threshold;   // relative change of the medians below which a
+                                   //   difference is ignored; default 0.01
+    double            confidence;  // of the bootstrap interval; default 0.95
+    unsigned          resamples;   // bootstrap resamples; default 2000
+
+    compare_options()
+      : cpu(false), alpha(0.05), threshold(0.01), confidence(0.95), resamples(2000) {}
+  };
+
+  enum compare_verdict { unchanged, improved, regressed };
+
+  struct case_comparison
+  {
+    std::string       name;
+    double            baseline_median;   // ns per iteration
+    double            candidate_median;
+    double            ratio;             // candidate_median / baseline_median
+    double            ratio_low;         // bootstrap confidence interval of ratio
+    double            ratio_high;
+    double            p_value;           // mann_whitney_p()
+    compare_verdict   verdict;           // regressed or improved if p_value < alpha
+                                         //   and ratio is beyond 1 +/- threshold
+  };
+
+  //  Compares each case of candidate with the case of the same name in base, in the
+  //  order of candidate; cases in only one of them are skipped. The bootstrap is
+  //  seeded from the case name, so results are repeatable.
+  BOOST_TIMER_DECL
+  std::vector<case_comparison> compare(const baseline& base, const baseline& candidate,
+                                       const compare_options& options = compare_options());
+
+} // namespace timer
+} // namespace boost
+
+#   if defined(_MSC_VER)
+#     pragma warning(pop) // restore warning settings.
+#   endif
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_BASELINE_HPP
@@ -0,0 +1,132 @@
+//  boost/timer/benchmark.hpp  ---------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_BENCHMARK_HPP                  
+#define BOOST_TIMER_BENCHMARK_HPP
+
+#include <boost/timer/timer.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+#   if defined(_MSC_VER)
+#     pragma warning(push)           // Save warning settings
+#     pragma warning(disable : 4251) // disable warning: class 'std::basic_string<_Elem,_Traits,_Ax>'
+#   endif                            // needs to have dll-interface...
+
+//--------------------------------------------------------------------------------------//
+
+//  A microbenchmark runner. Each registered callable is run repeatedly for a warmup
+//  period, its iteration count is scaled until one sample takes the target time, and
+//  then a number of samples are timed with a cpu_timer. Samples more than
+//  outlier_threshold scaled median absolute deviations from the median are rejected,
+//  and the cost of timing a sample, timer_overhead<cpu_timer::policy_type>(), is
+//  subtracted before dividing by the iterations.
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+
+//  sample_statistics  -----------------------------------------------------------------//
+
+  struct sample_statistics
+  {
+    std::size_t   count;     // samples kept
+    std::size_t   rejected;  // samples rejected as outliers
+    double        mean;
+    double        median;
+    double        stddev;    // sample standard deviation of the kept samples
+    double        min;
+    double        max;
+  };
+
+  //  Sorts values, rejects outliers, and summarizes the rest. A threshold of 0 rejects
+  //  nothing. A value is an outlier if |value - median| > threshold * 1.4826 * MAD,
+  //  1.4826 * MAD being a robust estimate of the standard deviation.
+  BOOST_TIMER_DECL
+  sample_statistics summarize(std::vector<double>& values, double outlier_threshold = 0.0);
+
+//  benchmark  -------------------------------------------------------------------------//
+
+  struct BOOST_TIMER_DECL benchmark_options
+  {
+    nanosecond_type   warmup_time;         // default 50ms
+    nanosecond_type   sample_time;         // target wall time per sample; default 10ms
+    unsigned          samples;             // default 10
+    double            outlier_threshold;   // see summarize(); default 3.5
+    bool              subtract_overhead;   // default true
+
+    benchmark_options();
+  };
+
+  struct benchmark_result
+  {
+    std::string       name;
+    boost::uint64_t   iterations;          // per sample
+    double            overhead;            // ns subtracted from each sample's wall time
+    sample_statistics wall;                // ns per iteration
+    sample_statistics cpu;                 // user + system ns per iteration
+    cpu_times         total;               // of all samples, as measured
+    std::vector<cpu_times> samples;        // each of iterations, as measured
+  };
+
+  class BOOST_TIMER_DECL benchmark
+  {
+  public:
+    explicit benchmark(const benchmark_options& options = benchmark_options())
+      : m_options(options) {}
+
+    //  f is called with no arguments, repeatedly
+    template <class F>
+    void        add(const std::string& name, F f)
+                  { m_cases.push_back(std::make_pair(name, boost::function<void()>(f))); }
+
+    //  Runs every case not yet run, in the order added
+    void        run();
+
+    const std::vector<benchmark_result>& results() const { return m_results; }
+    const benchmark_options&             options() const { return m_options; }
+
+    //  One line per result, giving the per-iteration statistics and the total as
+    //  format(total, places, fmt) would
+    void        report(std::ostream& os, short places = 3,
+                  const std::string& fmt = " %ws wall, %ts CPU (%p%)") const;
+    void        write_json(std::ostream& os) const;
+    void        write_csv(std::ostream& os) const;  // with a header line
+
+    //  Times f by itself
+    static benchmark_result measure(const std::string& name,
+                  const boost::function<void()>& f,
+                  const benchmark_options& options = benchmark_options());
+
+  private:
+    benchmark_options                                         m_options;
+    std::vector<std::pair<std::string, boost::function<void()> > > m_cases;
+    std::vector<benchmark_result>                             m_results;
+  };
+
+} // namespace timer
+} // namespace boost
+
+#   if defined(_MSC_VER)
+#     pragma warning(pop) // restore warning settings.
+#   endif 
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_BENCHMARK_HPP
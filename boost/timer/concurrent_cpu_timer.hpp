@@ -0,0 +1,154 @@
+//  boost/timer/concurrent_cpu_timer.hpp  ----------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_CONCURRENT_CPU_TIMER_HPP
+#define BOOST_TIMER_CONCURRENT_CPU_TIMER_HPP
+
+#include <boost/timer/timer.hpp>
+#include <boost/cstdint.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+# include <atomic>
+# include <mutex>
+#endif
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+#   if defined(_MSC_VER)
+#     pragma warning(push)           // Save warning settings
+#     pragma warning(disable : 4251) // disable warning: class 'std::basic_string<_Elem,_Traits,_Ax>'
+#     pragma warning(disable : 4324) // disable warning: structure was padded due to alignment
+#   endif
+
+//--------------------------------------------------------------------------------------//
+
+//  A concurrent_cpu_timer measures one logical operation done by many threads, such as
+//  a parallel sort. Any thread may time segments of the operation against it; each
+//  segment's wall and thread CPU times are added to accumulators sharded by thread,
+//  without locks. It reports the total thread CPU time of all segments, and as wall
+//  time the critical path, from the first segment opening to the last closing.
+//
+//  The timer itself requires C++11 atomics and thread_local; concurrency_stats and
+//  the format fields that show them do not.
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  struct concurrency_stats
+  {
+    boost::int_least64_t  segments;  // number of segments closed
+    boost::int_least64_t  threads;   // number of threads that closed segments
+    nanosecond_type       busy;      // sum of the segments' wall times
+
+    void clear()                                   { segments = threads = busy = 0; }
+  };
+
+  //  " %ws critical path, %ts thread CPU (%p%), %n segments on %N threads,"
+  //  " %E% efficiency\n"
+  BOOST_TIMER_DECL const std::string&  default_concurrent_format();
+
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+
+  namespace detail
+  {
+    //  One per cache line, so that threads adding to different shards do not
+    //  contend. A thread claims a shard of its own on its first add(); more threads
+    //  than shards share them, which the atomic additions keep correct.
+    struct alignas(64) concurrent_shard
+    {
+      std::atomic<boost::uint_least64_t> owner;     // the claiming thread's id; 0 if
+                                                    //   none
+      std::atomic<boost::int_least64_t>  segments;
+      std::atomic<nanosecond_type>       busy;
+      std::atomic<nanosecond_type>       user;
+      std::atomic<nanosecond_type>       system;
+      std::atomic<nanosecond_type>       first_open;  // wall clock
+      std::atomic<nanosecond_type>       last_close;  // wall clock
+    };
+  }
+
+//  concurrent_cpu_timer  --------------------------------------------------------------//
+
+  class BOOST_TIMER_DECL concurrent_cpu_timer
+  {
+  public:
+    static const std::size_t  shard_count = 64;
+
+    //  Times the thread's work from construction to close() or destruction, which
+    //  must be on the constructing thread, and adds it to the timer unless the timer
+    //  is stopped by then.
+    class BOOST_TIMER_DECL segment
+    {
+    public:
+      explicit segment(concurrent_cpu_timer& timer);
+     ~segment()                                    { close(); }
+
+      void                  close();  // no effect after the first call
+
+    private:
+      concurrent_cpu_timer* m_timer;
+      cpu_times             m_start;
+
+      segment(const segment&);
+      segment& operator=(const segment&);
+    };
+
+    concurrent_cpu_timer()                         { start(); }
+
+    //  observers; these may be concurrent with segments
+    bool                    is_stopped() const
+                              { return m_is_stopped.load(std::memory_order_relaxed); }
+    cpu_times               elapsed() const;        // wall is the critical path
+    concurrency_stats       elapsed_stats() const;
+    //  total thread CPU / (critical path * threads), or 0 if nothing was timed
+    double                  parallel_efficiency() const;
+    std::string             format(short places = default_places,
+                              const std::string& format = default_concurrent_format())
+                                                                                  const;
+    //  actions; these must not be concurrent with each other or with observers
+    void                    start();  // discards all segments; none may be open
+    void                    stop();   // later closes are not added
+
+  private:
+    detail::concurrent_shard  m_shards[shard_count];
+    std::atomic<bool>         m_is_stopped;
+    boost::uint_least64_t     m_generation;  // unique to each start()
+    cpu_times                 m_times;   // valid when stopped
+    concurrency_stats         m_stats;   // valid when stopped
+
+    //  the ids of threads that found no shard to claim
+    mutable std::mutex                  m_overflow_mutex;
+    std::vector<boost::uint_least64_t>  m_overflow_threads;
+
+    std::size_t             shard_index();
+    void                    add(const cpu_times& start, const cpu_times& finish);
+    void                    collect(cpu_times& times, concurrency_stats& stats) const;
+
+    concurrent_cpu_timer(const concurrent_cpu_timer&);
+    concurrent_cpu_timer& operator=(const concurrent_cpu_timer&);
+  };
+
+#endif  // !BOOST_TIMER_NO_CXX11_CONCURRENCY
+
+} // namespace timer
+} // namespace boost
+
+#   if defined(_MSC_VER)
+#     pragma warning(pop) // restore warning settings.
+#   endif
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_CONCURRENT_CPU_TIMER_HPP
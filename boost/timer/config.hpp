@@ -29,6 +29,30 @@
 # define BOOST_TIMER_DECL
 #endif
 
+//  C++11 concurrency support  ----------------------------------------------------------//
+
+//  Components that accumulate or report from several threads at once (such as the
+//  region registry) need C++11 atomics, threads, and thread_local storage. They are
+//  not available, and are omitted from the library build, without them.
+
+#if defined(BOOST_NO_CXX11_HDR_ATOMIC) || defined(BOOST_NO_CXX11_HDR_MUTEX) \
+  || defined(BOOST_NO_CXX11_HDR_THREAD) || defined(BOOST_NO_CXX11_THREAD_LOCAL)
+# define BOOST_TIMER_NO_CXX11_CONCURRENCY
+#endif
+
+//  Compile-time formats (<boost/timer/static_format.hpp>) take the format string as a
+//  template argument, which needs C++20 class-type non-type template parameters.
+
+#if !defined(__cpp_nontype_template_args) || __cpp_nontype_template_args < 201911L
+# define BOOST_TIMER_NO_CXX20_STATIC_FORMAT
+#endif
+
+//  Coroutine task timers (<boost/timer/task_timer.hpp>) need C++20 coroutines.
+
+#if !defined(__cpp_impl_coroutine) || __cpp_impl_coroutine < 201902L
+# define BOOST_TIMER_NO_CXX20_COROUTINES
+#endif
+
 //  enable automatic library variant selection  ----------------------------------------//
 
 #if !defined(BOOST_TIMER_SOURCE) && !defined(BOOST_ALL_NO_LIB) && !defined(BOOST_TIMER_NO_LIB)
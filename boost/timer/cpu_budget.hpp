@@ -0,0 +1,263 @@
+//  boost/timer/cpu_budget.hpp  --------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_CPU_BUDGET_HPP
+#define BOOST_TIMER_CPU_BUDGET_HPP
+
+#include <boost/timer/timer.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+
+//--------------------------------------------------------------------------------------//
+
+//  A cpu_budget limits the CPU time, the wall time, or both, of a unit of work that
+//  calls check() in its inner loop. check() is a decrement and a branch: the clocks
+//  are polled only once every stride() calls, and the stride adapts, after each
+//  poll, to the cost of the calls measured since the previous poll, so that polls
+//  are rare far from the limits and every call is a poll close to them.
+//
+//  A budget may be nested in a parent budget, which it is charged against: the child
+//  is exceeded when it or any of its ancestors is.
+//
+//    boost::timer::cpu_budget query(50 * 1000000LL);          // 50 ms of CPU
+//    for (row r = first; r != last; ++r)
+//    {
+//      if (query.check())
+//        return partial_result();
+//      ...
+//    }
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  namespace detail
+  {
+    template <class Policy>
+    struct measures_cpu                   { static const bool value = true; };
+
+    template <unsigned Fields>
+    struct measures_cpu<capture_policy<Fields> >
+    {
+      static const bool value = (Fields & (user_field | system_field)) != 0;
+    };
+  }
+
+  template <class Policy>
+  class basic_cpu_budget
+  {
+  public:
+    typedef Policy                                     policy_type;
+    typedef boost::function<void(basic_cpu_budget&)>  callback_type;
+
+    static const nanosecond_type  unlimited = -1;
+    static const boost::uint32_t  default_max_stride = 1u << 20;
+
+    //  Starts a budget of limit nanoseconds of user plus system time, or of wall time
+    //  if Policy captures neither, as for wall_budget; and of wall_limit nanoseconds of
+    //  wall time. on_exceeded, if not empty, is called once, by the poll that finds the
+    //  budget exceeded.
+    explicit basic_cpu_budget(nanosecond_type limit,
+                              nanosecond_type wall_limit = unlimited,
+                              const callback_type& on_exceeded = callback_type())
+      : m_parent(0), m_callback(on_exceeded), m_max_stride(default_max_stride)
+                                                 { set_limits(limit, wall_limit); }
+
+    //  Starts a budget charged against parent, which must outlive it.
+    basic_cpu_budget(basic_cpu_budget& parent, nanosecond_type limit,
+                     nanosecond_type wall_limit = unlimited,
+                     const callback_type& on_exceeded = callback_type())
+      : m_parent(&parent), m_callback(on_exceeded), m_max_stride(default_max_stride)
+                                                 { set_limits(limit, wall_limit); }
+
+    //  observers
+    bool               exceeded() const          { return m_exceeded; }
+    nanosecond_type    cpu_limit() const         { return m_cpu_limit; }   // or
+    nanosecond_type    wall_limit() const        { return m_wall_limit; }  //   unlimited
+    basic_cpu_budget*  parent() const            { return m_parent; }
+    boost::uint32_t    stride() const            { return m_stride; }
+    boost::uint32_t    max_stride() const        { return m_max_stride; }
+    boost::uint64_t    polls() const             { return m_polls; }
+    cpu_times          elapsed() const;          // since start(); polls the clocks
+
+    //  actions
+    void               start();                  // restarts, not exceeded, stride 1
+
+    //  Returns exceeded(), polling the clocks once every stride() calls.
+    bool               check()
+    {
+      if (--m_countdown != 0)
+        return m_exceeded;
+      return poll();
+    }
+
+    //  Polls the clocks now, and returns exceeded().
+    bool               poll();
+
+    //  Limits the adaptive stride to max_stride; a max_stride of 1 polls on every
+    //  check(). Takes effect from the next poll.
+    void               set_max_stride(boost::uint32_t max_stride)
+                           { m_max_stride = max_stride ? max_stride : 1; }
+
+  private:
+    basic_cpu_budget*  m_parent;
+    nanosecond_type    m_cpu_limit;
+    nanosecond_type    m_wall_limit;
+    callback_type      m_callback;
+    boost::uint32_t    m_max_stride;
+
+    cpu_times          m_start;
+    cpu_times          m_last;         // as of the last poll
+    boost::uint32_t    m_stride;       // calls from the last poll to the next
+    boost::uint32_t    m_countdown;    // to the next poll
+    boost::uint64_t    m_polls;
+    bool               m_exceeded;
+
+    //  The least of the budget's and its ancestors' remaining time, in each of wall
+    //  and cpu; sets the exceeded ones.
+    void               charge(const cpu_times& current, nanosecond_type& wall,
+                              nanosecond_type& cpu);
+    void               exceed();
+    void               set_limits(nanosecond_type limit, nanosecond_type wall_limit);
+
+    basic_cpu_budget(const basic_cpu_budget&);             // noncopyable
+    basic_cpu_budget& operator=(const basic_cpu_budget&);
+  };
+
+  typedef basic_cpu_budget<process_times_policy>  cpu_budget;
+  typedef basic_cpu_budget<thread_times_policy>   thread_cpu_budget;
+  typedef basic_cpu_budget<wall_time_policy>      wall_budget;
+
+  template <class Policy>
+  const nanosecond_type basic_cpu_budget<Policy>::unlimited;
+
+  template <class Policy>
+  const boost::uint32_t basic_cpu_budget<Policy>::default_max_stride;
+
+  template <class Policy>
+  void basic_cpu_budget<Policy>::set_limits(nanosecond_type limit,
+    nanosecond_type wall_limit)
+  {
+    m_cpu_limit = unlimited;
+    m_wall_limit = wall_limit;
+    if (detail::measures_cpu<Policy>::value)
+      m_cpu_limit = limit;
+    else if (wall_limit == unlimited || limit < wall_limit)
+      m_wall_limit = limit;
+    start();
+  }
+
+  template <class Policy>
+  void basic_cpu_budget<Policy>::start()
+  {
+    Policy::get(m_start);
+    m_last = m_start;
+    m_stride = 1;
+    m_countdown = 1;
+    m_polls = 0;
+    m_exceeded = false;
+  }
+
+  template <class Policy>
+  cpu_times basic_cpu_budget<Policy>::elapsed() const
+  {
+    cpu_times current;
+    Policy::get(current);
+    current.wall -= m_start.wall;
+    current.user -= m_start.user;
+    current.system -= m_start.system;
+    return current;
+  }
+
+  template <class Policy>
+  void basic_cpu_budget<Policy>::exceed()
+  {
+    if (m_exceeded)
+      return;
+    m_exceeded = true;
+    if (m_callback)
+      m_callback(*this);
+  }
+
+  template <class Policy>
+  void basic_cpu_budget<Policy>::charge(const cpu_times& current, nanosecond_type& wall,
+    nanosecond_type& cpu)
+  {
+    if (m_parent)
+    {
+      m_parent->charge(current, wall, cpu);  // outermost first
+      if (m_parent->m_exceeded)
+        exceed();
+    }
+    if (m_wall_limit != unlimited)
+    {
+      const nanosecond_type left = m_wall_limit - (current.wall - m_start.wall);
+      if (left <= 0)
+        exceed();
+      if (wall == unlimited || left < wall)
+        wall = left;
+    }
+    if (m_cpu_limit != unlimited)
+    {
+      const nanosecond_type left = m_cpu_limit
+        - (current.user - m_start.user + current.system - m_start.system);
+      if (left <= 0)
+        exceed();
+      if (cpu == unlimited || left < cpu)
+        cpu = left;
+    }
+  }
+
+  template <class Policy>
+  bool basic_cpu_budget<Policy>::poll()
+  {
+    ++m_polls;
+    if (m_exceeded)
+    {
+      m_countdown = m_max_stride;
+      return true;
+    }
+
+    cpu_times current;
+    Policy::get(current);
+    nanosecond_type wall = unlimited, cpu = unlimited;
+    charge(current, wall, cpu);
+    if (m_exceeded)
+    {
+      m_countdown = m_max_stride;
+      return true;
+    }
+
+    //  Aim the next poll at half the time left, at the cost per call since the last
+    //  poll, so that polls come closer together as a limit nears, and at most double
+    //  the stride, so that a burst of cheap calls does not overshoot.
+    double calls = m_max_stride;
+    const double used_wall = static_cast<double>(current.wall - m_last.wall);
+    const double used_cpu = static_cast<double>(current.user - m_last.user
+      + current.system - m_last.system);
+    if (wall != unlimited && used_wall > 0)
+      calls = wall / 2 / (used_wall / m_stride);
+    if (cpu != unlimited && used_cpu > 0 && cpu / 2 / (used_cpu / m_stride) < calls)
+      calls = cpu / 2 / (used_cpu / m_stride);
+    if (calls > 2.0 * m_stride)
+      calls = 2.0 * m_stride;
+    if (calls > m_max_stride)
+      calls = m_max_stride;
+    m_stride = calls < 1.0 ? 1 : static_cast<boost::uint32_t>(calls);
+    m_countdown = m_stride;
+    m_last = current;
+    return false;
+  }
+
+} // namespace timer
+} // namespace boost
+
+#endif  // BOOST_TIMER_CPU_BUDGET_HPP
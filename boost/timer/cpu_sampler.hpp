@@ -0,0 +1,110 @@
+//  boost/timer/cpu_sampler.hpp  -------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_CPU_SAMPLER_HPP
+#define BOOST_TIMER_CPU_SAMPLER_HPP
+
+#include <boost/timer/timer.hpp>
+
+#if defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+# error <boost/timer/cpu_sampler.hpp> requires C++11 atomics, threads, and thread_local
+#endif
+
+#include <boost/cstdint.hpp>
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+//--------------------------------------------------------------------------------------//
+
+//  A cpu_sampler takes a snapshot of the process's cpu_times every interval on a
+//  thread of its own, and keeps the CPU time used in each interval in a ring of the
+//  most recent samples, giving a timeline of utilization: each sample formats with %p
+//  as the interval's utilization. Optionally, on Linux, it also samples the CPU time
+//  of each of the process's threads, from /proc/self/task.
+//
+//  All memory is allocated by the constructor; sampling allocates nothing and takes no
+//  lock that other threads take. Readers copy samples out of the ring, so queries
+//  may be made at any time, from any thread.
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  struct cpu_sample
+  {
+    boost::uint64_t   sequence;  // 0 for the first interval
+    nanosecond_type   start;     // wall clock at the start of the interval
+    cpu_times         times;     // wall: the interval's length; user, system: the CPU
+                                 //   time used in it
+  };
+
+  struct sampled_thread
+  {
+    long              id;        // the kernel's thread id
+    char              name[16];  // as set by pthread_setname_np() or prctl()
+  };
+
+  class BOOST_TIMER_DECL cpu_sampler
+  {
+  public:
+    //  Starts sampling every interval_ms milliseconds, keeping the last capacity
+    //  samples. If max_threads is not 0, also samples up to max_threads threads, in the
+    //  order they are first seen, where the platform allows; see has_threads().
+    explicit cpu_sampler(unsigned interval_ms, std::size_t capacity = 1024,
+                         std::size_t max_threads = 0);
+   ~cpu_sampler();                            // stop()s
+
+    //  Ends sampling, discarding the interval in progress, and joins the sampling
+    //  thread. The samples taken remain available.
+    void              stop();
+
+    bool              is_stopped() const;
+    unsigned          interval_ms() const;
+    std::size_t       capacity() const;
+    std::size_t       max_threads() const;
+    bool              has_threads() const;    // threads are being sampled
+    boost::uint64_t   samples_taken() const;
+    boost::uint64_t   untracked_threads() const;  // in the latest sample, beyond
+                                                //   max_threads()
+
+    //  Replaces samples by those still in the ring, oldest first.
+    void              snapshot(std::vector<cpu_sample>& samples) const;
+
+    //  Also replaces threads by the threads sampled so far, and thread_times by their
+    //  CPU time in each sample: thread_times[i * threads.size() + j] is that of
+    //  threads[j] in samples[i], with wall the interval's length. Threads that had not
+    //  been seen by, or had exited before, a sample have 0 CPU time in it. A thread id
+    //  the kernel reuses for a new thread appears again, as another thread.
+    void              snapshot(std::vector<cpu_sample>& samples,
+                               std::vector<sampled_thread>& threads,
+                               std::vector<cpu_times>& thread_times) const;
+
+    //  One row per sample, oldest first: sequence, start_ns, wall_ns, user_ns,
+    //  system_ns and cpu_percent, then a percentage column per sampled thread.
+    void              write_csv(std::ostream& os) const;
+
+  private:
+    struct impl;
+    impl*  m_impl;
+
+    cpu_sampler(const cpu_sampler&);             // noncopyable
+    cpu_sampler& operator=(const cpu_sampler&);
+  };
+
+} // namespace timer
+} // namespace boost
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_CPU_SAMPLER_HPP
@@ -0,0 +1,173 @@
+//  boost/timer/detail/counter_timer.hpp  ----------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_DETAIL_COUNTER_TIMER_HPP
+#define BOOST_TIMER_DETAIL_COUNTER_TIMER_HPP
+
+#include <boost/timer/timer.hpp>
+
+namespace boost
+{
+namespace timer
+{
+namespace detail
+{
+
+//  counter_timer  ---------------------------------------------------------------------//
+
+  //  The timing shared by the timers that capture counters alongside cpu_times:
+  //  resource_timer, sched_timer, io_timer, and perf_counter_timer. The cpu_times are
+  //  those of process_times_policy or thread_times_policy, and behave as a
+  //  basic_cpu_timer's do, subtract_overhead() included. The counters are read before
+  //  the times by start() and resume(), and after them by stop(), so that reading them
+  //  is outside the interval timed.
+  //
+  //  Source supplies the counters:
+  //    typedef ... counters_type;
+  //    bool read(counters_type& current) const;  // false, with current cleared, if
+  //                                              //   the counters are not available
+  //    static void subtract(counters_type& lhs, const counters_type& rhs);
+  //    void complete(counters_type& elapsed, const cpu_times& times) const;
+  //                                              // sets values derived from times
+
+  template <class Source>
+  class counter_timer
+  {
+  public:
+    typedef typename Source::counters_type  counters_type;
+
+    //  observers
+    bool                is_stopped() const           { return m_is_stopped; }
+    bool                subtracts_overhead() const   { return m_subtract_overhead; }
+    cpu_times           elapsed() const;  // does not stop()
+
+    //  actions
+    void                start();
+    const cpu_times&    stop();
+    void                resume();
+
+    //  As basic_cpu_timer's, with the overhead of the policy of the cpu_times
+    void                subtract_overhead(bool subtract = true)
+                          { if (subtract) overhead();
+                            m_subtract_overhead = subtract; }
+
+  protected:
+    //  Both start the timer. thread_times selects thread_times_policy rather than
+    //  process_times_policy; arg, if given, is passed to the Source constructor.
+    explicit counter_timer(bool thread_times)
+      : m_thread_times(thread_times), m_subtract_overhead(false)    { start(); }
+    template <class Arg>
+    counter_timer(bool thread_times, const Arg& arg)
+      : m_source(arg), m_thread_times(thread_times), m_subtract_overhead(false)
+                                                                    { start(); }
+
+    const Source&       source() const               { return m_source; }
+    bool                has_counters() const         { return m_has_counters; }
+    void                elapsed(cpu_times& times, counters_type& counters) const;
+
+  private:
+    Source              m_source;
+    cpu_times           m_times;
+    counters_type       m_counters;
+    bool                m_thread_times;
+    bool                m_is_stopped;
+    bool                m_subtract_overhead;
+    bool                m_has_counters;  // as read by start()
+
+    void                get(cpu_times& times) const
+                          { if (m_thread_times) thread_times_policy::get(times);
+                            else process_times_policy::get(times); }
+    const overhead_calibration& overhead() const
+                          { return m_thread_times
+                              ? timer_overhead<thread_times_policy>()
+                              : timer_overhead<process_times_policy>(); }
+  };
+
+  template <class Source>
+  void counter_timer<Source>::start()
+  {
+    m_is_stopped = false;
+    m_has_counters = m_source.read(m_counters);
+    get(m_times);
+  }
+
+  template <class Source>
+  const cpu_times& counter_timer<Source>::stop()
+  {
+    if (is_stopped())
+      return m_times;
+    m_is_stopped = true;
+
+    cpu_times current;
+    get(current);
+    counters_type counters;
+    m_source.read(counters);
+    m_times.wall = current.wall - m_times.wall;
+    m_times.user = current.user - m_times.user;
+    m_times.system = current.system - m_times.system;
+    if (m_subtract_overhead)
+      remove_overhead(m_times, overhead().overhead);
+    Source::subtract(counters, m_counters);
+    if (m_has_counters)
+      m_source.complete(counters, m_times);
+    m_counters = counters;
+    return m_times;
+  }
+
+  template <class Source>
+  void counter_timer<Source>::resume()
+  {
+    if (is_stopped())
+    {
+      cpu_times times(m_times);
+      counters_type counters(m_counters);
+      start();
+      m_times.wall -= times.wall;
+      m_times.user -= times.user;
+      m_times.system -= times.system;
+      Source::subtract(m_counters, counters);
+    }
+  }
+
+  template <class Source>
+  cpu_times counter_timer<Source>::elapsed() const
+  {
+    if (is_stopped())
+      return m_times;
+    cpu_times current;
+    get(current);
+    current.wall -= m_times.wall;
+    current.user -= m_times.user;
+    current.system -= m_times.system;
+    if (m_subtract_overhead)
+      remove_overhead(current, overhead().overhead);
+    return current;
+  }
+
+  template <class Source>
+  void counter_timer<Source>::elapsed(cpu_times& times, counters_type& counters) const
+  {
+    if (is_stopped())
+    {
+      times = m_times;
+      counters = m_counters;
+      return;
+    }
+    times = elapsed();
+    m_source.read(counters);
+    Source::subtract(counters, m_counters);
+    if (m_has_counters)
+      m_source.complete(counters, times);
+  }
+
+} // namespace detail
+} // namespace timer
+} // namespace boost
+
+#endif  // BOOST_TIMER_DETAIL_COUNTER_TIMER_HPP
@@ -0,0 +1,45 @@
+//  boost/timer/detail/json.hpp  -------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_DETAIL_JSON_HPP
+#define BOOST_TIMER_DETAIL_JSON_HPP
+
+#include <ostream>
+#include <string>
+
+//  Helpers for the library's JSON output; not part of the interface.
+
+namespace boost
+{
+namespace timer
+{
+namespace detail
+{
+  //  Writes s as a quoted JSON string
+  inline void put_json_string(std::ostream& os, const std::string& s)
+  {
+    static const char hex[] = "0123456789abcdef";
+    os << '"';
+    for (std::string::const_iterator it = s.begin(); it != s.end(); ++it)
+    {
+      unsigned char c = static_cast<unsigned char>(*it);
+      if (c == '"' || c == '\\')
+        os << '\\' << *it;
+      else if (c < 0x20)
+        os << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+      else
+        os << *it;
+    }
+    os << '"';
+  }
+} // namespace detail
+} // namespace timer
+} // namespace boost
+
+#endif  // BOOST_TIMER_DETAIL_JSON_HPP
@@ -0,0 +1,67 @@
+//  boost/timer/detail/tsc.hpp  --------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_DETAIL_TSC_HPP
+#define BOOST_TIMER_DETAIL_TSC_HPP
+
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+
+//  BOOST_TIMER_HAS_TSC is defined if the processor has a time stamp counter that can be
+//  read with an intrinsic. Whether the counter is usable as a clock (i.e. is invariant)
+//  can only be determined at run time; see tsc_is_invariant() in timer.hpp.
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+# include <x86intrin.h>
+# include <cpuid.h>
+# define BOOST_TIMER_HAS_TSC
+#elif defined(BOOST_MSVC) && (defined(_M_X64) || defined(_M_IX86))
+# include <intrin.h>
+# define BOOST_TIMER_HAS_TSC
+#endif
+
+#if defined(BOOST_TIMER_HAS_TSC)
+
+namespace boost
+{
+namespace timer
+{
+namespace detail
+{
+  inline boost::uint64_t read_tsc()
+  {
+    return __rdtsc();
+  }
+
+  //  CPUID.80000007H:EDX[8] reports an invariant TSC, which runs at a constant rate in
+  //  all ACPI P-, C-, and T-states and is synchronized across cores.
+  inline bool cpuid_invariant_tsc()
+  {
+# if defined(BOOST_MSVC)
+    int regs[4];
+    __cpuid(regs, 0x80000000);
+    if (static_cast<unsigned>(regs[0]) < 0x80000007u)
+      return false;
+    __cpuid(regs, 0x80000007);
+    return (regs[3] & (1 << 8)) != 0;
+# else
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx))
+      return false;  // leaf not supported
+    return (edx & (1u << 8)) != 0;
+# endif
+  }
+
+} // namespace detail
+} // namespace timer
+} // namespace boost
+
+#endif  // BOOST_TIMER_HAS_TSC
+
+#endif  // BOOST_TIMER_DETAIL_TSC_HPP
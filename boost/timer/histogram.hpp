@@ -0,0 +1,117 @@
+//  boost/timer/histogram.hpp  ---------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_HISTOGRAM_HPP                  
+#define BOOST_TIMER_HISTOGRAM_HPP
+
+#include <boost/timer/timer.hpp>
+#include <boost/cstdint.hpp>
+#include <cstddef>
+#include <string>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+//--------------------------------------------------------------------------------------//
+
+//  Log-linear histograms of nanosecond durations, in the style of HdrHistogram. Values
+//  below 2^sub_bucket_bits are recorded exactly; larger values are recorded with a
+//  relative error of at most 2^-(sub_bucket_bits-1), i.e. better than 1.6%. Values of
+//  2^48ns (about 78 hours) or more share the last bucket. Memory is fixed, and
+//  recording a value costs a count-leading-zeros, a shift, and an increment.
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+
+//  histogram  -------------------------------------------------------------------------//
+
+  class BOOST_TIMER_DECL histogram
+  {
+  public:
+    BOOST_STATIC_CONSTANT(unsigned, sub_bucket_bits = 7);
+    BOOST_STATIC_CONSTANT(unsigned, magnitude_bits = 48);
+    BOOST_STATIC_CONSTANT(std::size_t, bucket_count = (1u << sub_bucket_bits)
+      + (magnitude_bits - sub_bucket_bits) * (1u << (sub_bucket_bits - 1)));
+
+    histogram()                                    { clear(); }
+
+    //  observers
+    boost::uint64_t   count() const                { return m_count; }
+    nanosecond_type   min() const                  { return m_count ? m_min : 0; }
+    nanosecond_type   max() const                  { return m_max; }
+    double            mean() const;
+    nanosecond_type   percentile(double p) const;  // p in [0, 100]; 0 if empty
+
+    //  Appends a compact binary form to out, and reads it back. deserialize() returns
+    //  false, leaving *this unchanged, if in does not begin with a valid histogram;
+    //  otherwise it returns true and sets pos to just past the consumed bytes.
+    void              serialize(std::string& out) const;
+    bool              deserialize(const std::string& in, std::size_t& pos);
+
+    //  modifiers
+    void              record(nanosecond_type ns)   { record(ns, 1); }
+    void              record(nanosecond_type ns, boost::uint64_t n);
+    void              merge(const histogram& other);
+    void              clear();
+
+    //  Bucket mapping, exposed for testing and for external tools.
+    static std::size_t      bucket_index(nanosecond_type ns);
+    static nanosecond_type  bucket_lowest(std::size_t index);
+    static nanosecond_type  bucket_highest(std::size_t index);
+
+  private:
+    boost::uint64_t   m_counts[bucket_count];
+    boost::uint64_t   m_count;
+    boost::uint64_t   m_sum;   // of the recorded values, modulo 2^64
+    nanosecond_type   m_min;
+    nanosecond_type   m_max;
+  };
+
+//  cpu_times_histogram  ---------------------------------------------------------------//
+
+  //  Three histograms, one for each member of cpu_times. percentile() packages the
+  //  three percentiles as a cpu_times, so it can be passed to format():
+  //
+  //    format(h.percentile(99.0), 3, "p99 %ws wall, %ts CPU\n")
+  //
+  //  The members of a percentile are computed independently, so %t and %p combine
+  //  the user and system percentiles, not the percentile of their sum.
+
+  class BOOST_TIMER_DECL cpu_times_histogram
+  {
+  public:
+    //  observers
+    boost::uint64_t   count() const                { return wall.count(); }
+    cpu_times         percentile(double p) const;
+    cpu_times         min() const;
+    cpu_times         max() const;
+    cpu_times         mean() const;  // rounded to the nearest nanosecond
+
+    void              serialize(std::string& out) const;
+    bool              deserialize(const std::string& in, std::size_t& pos);
+
+    //  modifiers
+    void              record(const cpu_times& times);
+    void              merge(const cpu_times_histogram& other);
+    void              clear();
+
+    histogram         wall;
+    histogram         user;
+    histogram         system;
+  };
+
+} // namespace timer
+} // namespace boost
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_HISTOGRAM_HPP
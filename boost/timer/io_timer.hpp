@@ -0,0 +1,113 @@
+//  boost/timer/io_timer.hpp  ----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_IO_TIMER_HPP                  
+#define BOOST_TIMER_IO_TIMER_HPP
+
+#include <boost/timer/timer.hpp>
+#include <boost/timer/detail/counter_timer.hpp>
+#include <boost/cstdint.hpp>
+#include <string>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+#   if defined(_MSC_VER)
+#     pragma warning(push)           // Save warning settings
+#     pragma warning(disable : 4251) // disable warning: class 'std::basic_string<_Elem,_Traits,_Ax>'
+                                     // needs to have dll-interface...
+#     pragma warning(disable : 4275) // disable warning: non dll-interface class used as
+#   endif                            // base for dll-interface class
+
+//--------------------------------------------------------------------------------------//
+
+//  An io_timer times a region as cpu_timer does, and also captures how much I/O the
+//  process did over it, from the Linux /proc/self/io, so that a slow region can be
+//  seen to be I/O bound, and its throughput measured. Elsewhere, or if the kernel
+//  does not provide the counters, only the cpu_times are captured.
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  struct io_counters
+  {
+    boost::int_least64_t  read_chars;    // rchar: bytes read by read() and the like,
+                                         //   whether from storage or the page cache
+    boost::int_least64_t  write_chars;   // wchar: bytes written by write() and the like
+    boost::int_least64_t  read_calls;    // syscr: read system calls
+    boost::int_least64_t  write_calls;   // syscw: write system calls
+    boost::int_least64_t  read_bytes;    // read_bytes: bytes fetched from storage
+    boost::int_least64_t  write_bytes;   // write_bytes: bytes sent to storage
+
+    void clear()
+    {
+      read_chars = write_chars = read_calls = write_calls = read_bytes = write_bytes
+        = 0;
+    }
+  };
+
+  //  Sets the process's totals. Returns false, with current cleared, if they are not
+  //  available. The file is opened on first use and kept open, so each call is a
+  //  single pread(); a child process opens its own on its first call after fork().
+  BOOST_TIMER_DECL bool  current_io_counters(io_counters& current);
+
+  //  " %ws wall, %ts CPU (%p%), %R bytes read (%a MB/s), %W written (%A MB/s)\n"
+  BOOST_TIMER_DECL const std::string&  default_io_format();
+
+  namespace detail
+  {
+    struct io_source
+    {
+      typedef io_counters counters_type;
+
+      bool read(io_counters& current) const  { return current_io_counters(current); }
+      static void subtract(io_counters& lhs, const io_counters& rhs)
+      {
+        lhs.read_chars -= rhs.read_chars;
+        lhs.write_chars -= rhs.write_chars;
+        lhs.read_calls -= rhs.read_calls;
+        lhs.write_calls -= rhs.write_calls;
+        lhs.read_bytes -= rhs.read_bytes;
+        lhs.write_bytes -= rhs.write_bytes;
+      }
+      void complete(io_counters&, const cpu_times&) const {}
+    };
+  }
+
+//  io_timer  --------------------------------------------------------------------------//
+
+  //  Like cpu_timer. If the counters are not available, io is all zeros, and formats
+  //  show its fields as n/a. The actions, subtract_overhead(), and the other observers
+  //  are those of detail::counter_timer.
+
+  class BOOST_TIMER_DECL io_timer : public detail::counter_timer<detail::io_source>
+  {
+  public:
+    io_timer() : detail::counter_timer<detail::io_source>(false) {}
+
+    //  observers
+    bool                   has_io() const          { return has_counters(); }
+    io_counters            elapsed_io() const;     // does not stop()
+    std::string            format(short places = default_places,
+                                  const std::string& format = default_io_format())
+                                                                                  const;
+  };
+
+} // namespace timer
+} // namespace boost
+
+#   if defined(_MSC_VER)
+#     pragma warning(pop) // restore warning settings.
+#   endif 
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_IO_TIMER_HPP
@@ -0,0 +1,145 @@
+//  boost/timer/perf_counter_timer.hpp  ------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_PERF_COUNTER_TIMER_HPP                  
+#define BOOST_TIMER_PERF_COUNTER_TIMER_HPP
+
+#include <boost/timer/timer.hpp>
+#include <boost/timer/detail/counter_timer.hpp>
+#include <boost/cstdint.hpp>
+#include <string>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+#   if defined(_MSC_VER)
+#     pragma warning(push)           // Save warning settings
+#     pragma warning(disable : 4251) // disable warning: class 'std::basic_string<_Elem,_Traits,_Ax>'
+                                     // needs to have dll-interface...
+#     pragma warning(disable : 4275) // disable warning: non dll-interface class used as
+#   endif                            // base for dll-interface class
+
+//--------------------------------------------------------------------------------------//
+
+//  A perf_counter_timer times a region of a thread as thread_cpu_timer does, and also
+//  reads the Linux perf_event counters of the thread: hardware events, from which
+//  instructions per cycle and cache miss rates follow, and software events.
+//
+//  Each thread opens its counters once, on first use, as two groups, hardware and
+//  software, each read with a single read() so that its counts are consistent with
+//  one another. Where the kernel allows user space to read the hardware counters
+//  directly, and they are not being multiplexed, the hardware group is read with
+//  the x86 rdpmc instruction instead, without a system call. Events that cannot be
+//  opened, as hardware events cannot where there is no PMU (in many virtual machines
+//  and containers) or perf_event_open() is not permitted, are not available, and are
+//  shown as n/a.
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  enum perf_event_type
+  {
+    cycles_event,            // hardware
+    instructions_event,
+    cache_misses_event,
+    branch_misses_event,
+    task_clock_event,        // software; ns
+    page_faults_event,
+    context_switches_event,
+    perf_event_count
+  };
+
+  struct perf_counters
+  {
+    boost::int_least64_t  value[perf_event_count];
+    unsigned              available;  // bit 1 << event for each event counted
+
+    bool  has(perf_event_type event) const   { return (available & (1u << event)) != 0; }
+    void  clear()
+    {
+      for (int i = 0; i != perf_event_count; ++i)
+        value[i] = 0;
+      available = 0;
+    }
+  };
+
+  BOOST_TIMER_DECL const char*  perf_event_name(perf_event_type event);  // as by perf
+
+  //  The events the calling thread can count, opening its counters if need be; bit
+  //  1 << event for each
+  BOOST_TIMER_DECL unsigned     perf_events_available();
+  BOOST_TIMER_DECL bool         perf_rdpmc_available();  // for the calling thread
+
+  //  " %ws wall, %ts CPU, %K cycles, %I instructions (%P IPC), %M cache misses
+  //  (%H per 1000 instructions), %B branch misses\n"
+  BOOST_TIMER_DECL const std::string&  default_perf_format();
+
+  namespace detail
+  {
+    struct perf_group_set;
+
+    //  The calling thread's counters
+    class BOOST_TIMER_DECL perf_source
+    {
+    public:
+      typedef perf_counters counters_type;
+
+      perf_source();
+     ~perf_source();
+
+      unsigned available() const;
+      bool read(perf_counters& current) const;  // false if no event is available
+      static void subtract(perf_counters& lhs, const perf_counters& rhs)
+      {
+        for (int e = 0; e != perf_event_count; ++e)
+          lhs.value[e] -= rhs.value[e];
+      }
+      void complete(perf_counters&, const cpu_times&) const {}
+
+    private:
+      perf_group_set*  m_groups;   // the thread's
+      bool             m_owns_groups;
+
+      perf_source(const perf_source&);
+      perf_source& operator=(const perf_source&);
+    };
+  }
+
+//  perf_counter_timer  ----------------------------------------------------------------//
+
+  //  Like thread_cpu_timer, and like it must be started, stopped, and resumed on the
+  //  same thread. The actions, subtract_overhead(), and the other observers are those
+  //  of detail::counter_timer.
+
+  class BOOST_TIMER_DECL perf_counter_timer
+    : public detail::counter_timer<detail::perf_source>
+  {
+  public:
+    perf_counter_timer() : detail::counter_timer<detail::perf_source>(true) {}
+
+    //  observers
+    unsigned               available() const       { return source().available(); }
+    perf_counters          elapsed_counters() const;  // does not stop()
+    std::string            format(short places = default_places,
+                                  const std::string& format = default_perf_format())
+                                                                                  const;
+  };
+
+} // namespace timer
+} // namespace boost
+
+#   if defined(_MSC_VER)
+#     pragma warning(pop) // restore warning settings.
+#   endif 
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_PERF_COUNTER_TIMER_HPP
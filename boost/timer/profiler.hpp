@@ -0,0 +1,112 @@
+//  boost/timer/profiler.hpp  ----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_PROFILER_HPP                  
+#define BOOST_TIMER_PROFILER_HPP
+
+#include <boost/timer/timer.hpp>
+
+#if defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+# error <boost/timer/profiler.hpp> requires C++11 atomics, threads, and thread_local
+#endif
+
+#include <boost/cstdint.hpp>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+#   if defined(_MSC_VER)
+#     pragma warning(push)           // Save warning settings
+#     pragma warning(disable : 4251) // disable warning: class 'std::basic_string<_Elem,_Traits,_Ax>'
+#   endif                            // needs to have dll-interface...
+
+//--------------------------------------------------------------------------------------//
+
+//  A hierarchical profiler. Each thread keeps a call tree of the named zones it has
+//  entered, with call counts and inclusive times; a zone entered within another is its
+//  child. Once a thread has entered each of its paths through the zones, entering and
+//  leaving zones allocates nothing. A thread's tree is merged into the global profile
+//  when the thread exits or calls flush_thread_profile().
+//
+//  Times are those of thread_times_policy: wall-clock time, and user and system time
+//  charged to the thread.
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  struct profile_node
+  {
+    std::string                name;      // empty for the root
+    boost::uint64_t            count;     // calls
+    cpu_times                  inclusive;
+    cpu_times                  exclusive; // inclusive less the children's inclusive
+    std::vector<profile_node>  children;  // in order of first entry
+  };
+
+//  profile_zone  ----------------------------------------------------------------------//
+
+  class BOOST_TIMER_DECL profile_zone
+  {
+  public:
+    //  name must have static storage duration, e.g. be a string literal. Zones are
+    //  identified within a thread by the name's address, and merged by its value.
+    explicit profile_zone(const char* name);
+   ~profile_zone();
+
+  private:
+    profile_zone(const profile_zone&);
+    profile_zone& operator=(const profile_zone&);
+  };
+
+//  the global profile  ----------------------------------------------------------------//
+
+  //  Merges the calling thread's times into the global profile, and zeroes them. A
+  //  zone still active is merged when it is left, after a later flush.
+  BOOST_TIMER_DECL void          flush_thread_profile();
+
+  //  The global profile, with exclusive times computed. Times of threads still running
+  //  are included only as of their last flush_thread_profile().
+  BOOST_TIMER_DECL profile_node  profile_snapshot();
+
+  BOOST_TIMER_DECL void          reset_profile();
+
+  //  One line per zone, indented two spaces per level, giving the calls and the
+  //  inclusive and exclusive times formatted by format(times, places, fmt). Line
+  //  breaks in names are written as '_'.
+  BOOST_TIMER_DECL void          write_profile_report(std::ostream& os,
+    const profile_node& root, short places = 3,
+    const std::string& fmt = "%ws wall, %ts CPU");
+
+  //  One line per zone with a non-zero exclusive time, "outer;inner;zone ns", as read
+  //  by flame-graph tools. ns is the sum of the exclusive times named by fields, a
+  //  cpu_times_field bitmask. ';' and line breaks in names are written as '_'.
+  BOOST_TIMER_DECL void          write_folded_stacks(std::ostream& os,
+    const profile_node& root, unsigned fields = wall_field);
+
+} // namespace timer
+} // namespace boost
+
+//  Profiles the rest of the enclosing scope as a zone named by a string literal
+
+#define BOOST_TIMER_PROFILE_ZONE(name) \
+  ::boost::timer::profile_zone BOOST_JOIN(boost_timer_profile_zone_, __LINE__)(name)
+
+#   if defined(_MSC_VER)
+#     pragma warning(pop) // restore warning settings.
+#   endif 
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_PROFILER_HPP
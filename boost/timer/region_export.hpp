@@ -0,0 +1,142 @@
+//  boost/timer/region_export.hpp  -----------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_REGION_EXPORT_HPP
+#define BOOST_TIMER_REGION_EXPORT_HPP
+
+#include <boost/timer/registry.hpp>
+
+#if defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+# error <boost/timer/region_export.hpp> requires C++11 atomics, threads, and thread_local
+#endif
+
+#include <boost/cstdint.hpp>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+#   if defined(_MSC_VER)
+#     pragma warning(push)           // Save warning settings
+#     pragma warning(disable : 4251) // disable warning: class 'std::basic_string<_Elem,_Traits,_Ax>'
+#     pragma warning(disable : 4324) // disable warning: structure was padded due to alignment
+#   endif
+
+//--------------------------------------------------------------------------------------//
+
+//  Exports the registry's regions to a POSIX shared memory object, such as
+//  /dev/shm/boost_timer.<pid> on Linux, so that other processes can read the totals of
+//  a running process without it doing any I/O. A background thread, or calls to
+//  publish_regions(), copy snapshot_regions() into the object; threads adding times to
+//  regions are not involved, and never wait.
+//
+//  Layout, in the byte order of the exporting machine:
+//    export_header, at offset 0
+//    capacity export_records, from offset header_size, record_size bytes apart
+//  Each record is written only by the exporting process, under a sequence lock: its
+//  sequence is odd while an update is in progress, so readers retry torn reads.
+//  Records are never removed, and their names never change once published.
+//
+//  Readers reject a major_version they do not know. Minor versions only add fields at
+//  the end of the header or of records, growing header_size or record_size, so a
+//  reader ignores what it does not know, using the sizes to find the records.
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  const boost::uint16_t  export_major_version = 1;
+  const boost::uint16_t  export_minor_version = 0;
+
+  struct alignas(64) export_header
+  {
+    char                               magic[8];       // "BTEXPORT"
+    boost::uint16_t                    major_version;
+    boost::uint16_t                    minor_version;
+    boost::uint32_t                    header_size;
+    boost::uint32_t                    record_size;
+    boost::uint32_t                    capacity;       // of records
+    std::atomic<boost::uint32_t>       record_count;   // published; only grows
+    std::atomic<boost::uint32_t>       region_count;   // may exceed capacity
+    boost::int_least64_t               pid;
+    std::atomic<boost::uint64_t>       publications;   // 0 until the header is
+                                                       //   complete
+    std::atomic<boost::int_least64_t>  updated;        // current_wall_time() of the
+                                                       //   last publication
+  };
+
+  struct alignas(64) export_record
+  {
+    std::atomic<boost::uint32_t>       sequence;       // odd while being updated
+    boost::uint32_t                    name_size;      // of name, at most 56
+    char                               name[56];       // not null-terminated;
+                                                       //   truncated if longer
+    std::atomic<boost::int_least64_t>  count;
+    std::atomic<boost::int_least64_t>  total[3];       // wall, user, and system
+    std::atomic<boost::int_least64_t>  min[3];
+    std::atomic<boost::int_least64_t>  max[3];
+    boost::uint32_t                    sampling_period;  // 1 unless sampled
+    boost::uint32_t                    sampling;         // a sampling_method
+  };
+
+//  exporting  -------------------------------------------------------------------------//
+
+  //  Creates the shared memory object name, replacing any of that name, with room for
+  //  capacity regions; an empty name is "/boost_timer.<pid>". If interval_ms is not 0,
+  //  publishes the regions every interval_ms milliseconds until stop_export().
+  //  Returns false, with errno set, if an export is already active (EBUSY), capacity
+  //  is 0 (EINVAL), the platform has no shared memory (ENOSYS), or the object cannot
+  //  be created.
+  BOOST_TIMER_DECL bool  start_export(const std::string& name = std::string(),
+                                      unsigned interval_ms = 1000,
+                                      std::size_t capacity = 512);
+
+  //  Publishes once more, stops publishing, and unmaps the object; it is removed too
+  //  if remove is true, else it stays for readers until the system is restarted.
+  BOOST_TIMER_DECL void  stop_export(bool remove = true);
+
+  //  Copies every region's current totals into the export; does nothing if none is
+  //  active. Serialized with the background thread.
+  BOOST_TIMER_DECL void  publish_regions();
+
+  BOOST_TIMER_DECL bool         export_active();
+  BOOST_TIMER_DECL std::string  export_name();  // empty if none is active
+
+//  reading  ---------------------------------------------------------------------------//
+
+  struct export_snapshot
+  {
+    boost::int_least64_t       pid;
+    boost::uint16_t            minor_version;
+    boost::uint64_t            publications;
+    nanosecond_type            updated;         // wall clock of the exporting machine
+    boost::uint32_t            region_count;    // greater than regions.size() if
+                                                //   the export ran out of capacity
+    std::vector<region_stats>  regions;         // sum_of_squares 0
+  };
+
+  //  Maps the shared memory object name read-only and copies a consistent snapshot of
+  //  each record. Returns false, with errno set, if it cannot be opened, or is not an
+  //  export of a known major version (EPROTO).
+  BOOST_TIMER_DECL bool  read_export(const std::string& name, export_snapshot& snapshot);
+
+} // namespace timer
+} // namespace boost
+
+#   if defined(_MSC_VER)
+#     pragma warning(pop) // restore warning settings.
+#   endif
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_REGION_EXPORT_HPP
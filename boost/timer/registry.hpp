@@ -0,0 +1,139 @@
+//  boost/timer/registry.hpp  ----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_REGISTRY_HPP                  
+#define BOOST_TIMER_REGISTRY_HPP
+
+#include <boost/timer/timer.hpp>
+
+#if defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+# error <boost/timer/registry.hpp> requires C++11 atomics, threads, and thread_local
+#endif
+
+#include <boost/cstdint.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+#   if defined(_MSC_VER)
+#     pragma warning(push)           // Save warning settings
+#     pragma warning(disable : 4251) // disable warning: class 'std::basic_string<_Elem,_Traits,_Ax>'
+#   endif                            // needs to have dll-interface...
+
+//--------------------------------------------------------------------------------------//
+
+//  A registry of named regions, each accumulating the cpu_times of the scopes timed
+//  against it. Adding times is lock-free: each thread accumulates into its own slots,
+//  and snapshot_regions() merges the slots of all threads, past and present. Only
+//  registering a region name takes a lock, once per region.
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  //  How the executions whose times are added to a region were chosen; see
+  //  <boost/timer/sampled_timer.hpp>.
+  enum sampling_method
+  {
+    systematic_sampling,  // every sampling_period'th execution
+    random_sampling       // each execution independently, with probability 1/period
+  };
+
+  struct region_stats
+  {
+    std::string       name;
+    boost::uint64_t   count;   // number of times added
+    cpu_times         total;
+    cpu_times         min;     // minimum of each member, independently
+    cpu_times         max;     // maximum of each member, independently
+    double            sum_of_squares[3];  // of wall, user, and system, for variances
+    boost::uint32_t   sampling_period;    // 1 unless registered as sampled
+    sampling_method   sampling;
+  };
+
+//  region  ----------------------------------------------------------------------------//
+
+  class BOOST_TIMER_DECL region
+  {
+  public:
+    //  Registers name, or finds the region already registered with that name. Throws
+    //  std::length_error if the registry is full; see max_regions().
+    explicit region(const std::string& name);
+
+    //  Registers name as a region whose added times are a sample of one in
+    //  sampling_period executions, chosen by method. Also throws
+    //  std::invalid_argument if sampling_period is 0, or if name is already
+    //  registered with a different sampling_period or method.
+    region(const std::string& name, boost::uint32_t sampling_period,
+      sampling_method method);
+
+    const std::string&  name() const;
+    std::size_t         id() const                 { return m_id; }
+
+    void                add(const cpu_times& times) const;  // lock-free
+
+  private:
+    std::size_t         m_id;
+
+    void                register_name(const std::string& name,
+                          boost::uint32_t sampling_period, sampling_method method);
+  };
+
+  BOOST_TIMER_DECL std::size_t  max_regions();
+
+  //  One entry per registered region, in order of registration. Regions that have
+  //  not been added to have a count of 0 and all times 0.
+  BOOST_TIMER_DECL void         snapshot_regions(std::vector<region_stats>& stats);
+
+//  basic_scoped_region_timer  ---------------------------------------------------------//
+
+  //  Times its own lifetime and adds the result to a region on destruction.
+
+  template <class Policy>
+  class basic_scoped_region_timer
+  {
+  public:
+    explicit basic_scoped_region_timer(const region& r) : m_region(r) {}
+   ~basic_scoped_region_timer()                    { m_region.add(m_timer.stop()); }
+
+    basic_cpu_timer<Policy>&  timer()              { return m_timer; }
+
+  private:
+    const region&             m_region;
+    basic_cpu_timer<Policy>   m_timer;  // declared last so it starts last
+
+    basic_scoped_region_timer(const basic_scoped_region_timer&);
+    basic_scoped_region_timer& operator=(const basic_scoped_region_timer&);
+  };
+
+  typedef basic_scoped_region_timer<process_times_policy>  scoped_region_timer;
+  typedef basic_scoped_region_timer<thread_times_policy>   scoped_thread_region_timer;
+
+} // namespace timer
+} // namespace boost
+
+//  Times the rest of the enclosing scope against a region named by a string literal;
+//  the region is registered the first time control passes through.
+
+#define BOOST_TIMER_SCOPED_REGION(name)                                                \
+  static const ::boost::timer::region BOOST_JOIN(boost_timer_region_, __LINE__)(name); \
+  ::boost::timer::scoped_region_timer                                                  \
+    BOOST_JOIN(boost_timer_region_scope_, __LINE__)(BOOST_JOIN(boost_timer_region_, __LINE__))
+
+#   if defined(_MSC_VER)
+#     pragma warning(pop) // restore warning settings.
+#   endif 
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_REGISTRY_HPP
@@ -0,0 +1,132 @@
+//  boost/timer/resource_timer.hpp  ----------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_RESOURCE_TIMER_HPP                  
+#define BOOST_TIMER_RESOURCE_TIMER_HPP
+
+#include <boost/timer/timer.hpp>
+#include <boost/timer/detail/counter_timer.hpp>
+#include <boost/cstdint.hpp>
+#include <string>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+#   if defined(_MSC_VER)
+#     pragma warning(push)           // Save warning settings
+#     pragma warning(disable : 4251) // disable warning: class 'std::basic_string<_Elem,_Traits,_Ax>'
+                                     // needs to have dll-interface...
+#     pragma warning(disable : 4275) // disable warning: non dll-interface class used as
+#   endif                            // base for dll-interface class
+
+//--------------------------------------------------------------------------------------//
+
+//  A resource_timer times a region as cpu_timer does, and also captures how the
+//  operating system's resource usage counters (getrusage() on POSIX) changed over it.
+//  Page faults and context switches often explain where the CPU time went, or why
+//  wall-clock time exceeds it.
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  struct resource_usage
+  {
+    boost::int_least64_t  minor_faults;          // page faults serviced without I/O
+    boost::int_least64_t  major_faults;          // page faults requiring I/O
+    boost::int_least64_t  voluntary_switches;    // context switches while waiting
+    boost::int_least64_t  involuntary_switches;  // context switches by preemption
+    boost::int_least64_t  block_inputs;          // file system input operations
+    boost::int_least64_t  block_outputs;         // file system output operations
+    boost::int_least64_t  max_rss;               // peak resident set size in KB; as
+                                                 //   a difference, the peak's growth
+
+    void clear()
+    {
+      minor_faults = major_faults = voluntary_switches = involuntary_switches
+        = block_inputs = block_outputs = max_rss = 0;
+    }
+  };
+
+  enum resource_scope
+  {
+    process_resources,
+    thread_resources   // charged to the calling thread; max_rss is still the process's
+  };
+
+  //  Returns false, with current cleared, if the counters are not available: on
+  //  Windows, and for thread_resources where getrusage(RUSAGE_THREAD) is missing.
+  BOOST_TIMER_DECL bool  current_resource_usage(resource_usage& current,
+                                                resource_scope scope = process_resources);
+
+  //  " %ws wall, %ts CPU (%p%), %f+%F faults, %c+%C switches, %i+%o blocks, %m KB\n"
+  BOOST_TIMER_DECL const std::string&  default_resource_format();
+
+  namespace detail
+  {
+    struct resource_source
+    {
+      typedef resource_usage counters_type;
+
+      resource_scope scope;
+
+      explicit resource_source(resource_scope s = process_resources) : scope(s) {}
+
+      bool read(resource_usage& current) const
+        { return current_resource_usage(current, scope); }
+      static void subtract(resource_usage& lhs, const resource_usage& rhs)
+      {
+        lhs.minor_faults -= rhs.minor_faults;
+        lhs.major_faults -= rhs.major_faults;
+        lhs.voluntary_switches -= rhs.voluntary_switches;
+        lhs.involuntary_switches -= rhs.involuntary_switches;
+        lhs.block_inputs -= rhs.block_inputs;
+        lhs.block_outputs -= rhs.block_outputs;
+        lhs.max_rss -= rhs.max_rss;
+      }
+      void complete(resource_usage&, const cpu_times&) const {}
+    };
+  }
+
+//  resource_timer  --------------------------------------------------------------------//
+
+  //  Like cpu_timer, with process or thread CPU times as selected by scope. A
+  //  thread_resources timer must be started, stopped, and resumed on the same thread.
+  //  If the counters are not available, usage is all zeros, and formats show its
+  //  fields as n/a. The actions, subtract_overhead(), and the other observers are
+  //  those of detail::counter_timer.
+
+  class BOOST_TIMER_DECL resource_timer
+    : public detail::counter_timer<detail::resource_source>
+  {
+  public:
+    explicit resource_timer(resource_scope scope = process_resources)
+      : detail::counter_timer<detail::resource_source>(scope == thread_resources,
+                                                       scope) {}
+
+    //  observers
+    resource_scope         scope() const           { return source().scope; }
+    bool                   has_usage() const       { return has_counters(); }
+    resource_usage         elapsed_usage() const;  // does not stop()
+    std::string            format(short places = default_places,
+                                  const std::string& format = default_resource_format())
+                                                                                  const;
+  };
+
+} // namespace timer
+} // namespace boost
+
+#   if defined(_MSC_VER)
+#     pragma warning(pop) // restore warning settings.
+#   endif 
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_RESOURCE_TIMER_HPP
@@ -0,0 +1,158 @@
+//  boost/timer/sampled_timer.hpp  -----------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_SAMPLED_TIMER_HPP
+#define BOOST_TIMER_SAMPLED_TIMER_HPP
+
+#include <boost/timer/registry.hpp>
+
+#if defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+# error <boost/timer/sampled_timer.hpp> requires C++11 atomics, threads, and thread_local
+#endif
+
+#include <boost/cstdint.hpp>
+#include <string>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+#   if defined(_MSC_VER)
+#     pragma warning(push)           // Save warning settings
+#     pragma warning(disable : 4251) // disable warning: class 'std::basic_string<_Elem,_Traits,_Ax>'
+#   endif                            // needs to have dll-interface...
+
+//--------------------------------------------------------------------------------------//
+
+//  Sampled timers time only one in every so many executions of a scope, and add the
+//  times of those to a region, so that scopes too hot to time every execution can be
+//  timed at all. A skipped execution costs a decrement of a thread_local countdown and
+//  a branch. estimate_totals() extrapolates a sampled region's totals to all
+//  executions, with error bounds, for comparison with regions timed in full.
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  struct sampled_estimate
+  {
+    double            executions;  // estimated number, sampled or not
+    cpu_times         total;       // estimated total of all executions
+    cpu_times         error;       // half-width of an approximate 95% confidence
+                                   // interval for each member of total
+  };
+
+  //  For a region that is not sampled, the executions and total are exact and the
+  //  error is 0. For one sampled systematically, the error treats the samples as a
+  //  simple random sample, which holds unless the durations vary in step with the
+  //  sampling period. For one sampled at random, the error also allows for the
+  //  number of executions being uncertain.
+  BOOST_TIMER_DECL sampled_estimate estimate_totals(const region_stats& stats);
+
+//  sampled_region  --------------------------------------------------------------------//
+
+  class BOOST_TIMER_DECL sampled_region : public region
+  {
+  public:
+    //  Throws as region(name, period, method).
+    sampled_region(const std::string& name, boost::uint32_t period,
+      sampling_method method = systematic_sampling)
+      : region(name, period, method), m_period(period), m_method(method) {}
+
+    boost::uint32_t       period() const           { return m_period; }
+    sampling_method       method() const           { return m_method; }
+
+    //  The number of executions from one sample to the next: period for systematic
+    //  sampling, or for random sampling drawn from a geometric distribution with
+    //  mean period by a per-thread generator.
+    boost::int_least32_t  next_interval() const;
+
+  private:
+    boost::uint32_t       m_period;
+    sampling_method       m_method;
+  };
+
+//  basic_scoped_sampled_timer  --------------------------------------------------------//
+
+  //  Times its own lifetime, if countdown says this execution is sampled, and adds the
+  //  result to a sampled_region on destruction. countdown is the number of executions
+  //  left until the next sample; it should be thread_local and belong to one calling
+  //  site, and start at 0 so that the first execution is sampled.
+
+  template <class Policy>
+  class basic_scoped_sampled_timer
+  {
+  public:
+    basic_scoped_sampled_timer(const sampled_region& r, boost::int_least32_t& countdown)
+      : m_region(r), m_is_sampled(--countdown <= 0)
+    {
+      if (m_is_sampled)
+      {
+        countdown = r.next_interval();
+        Policy::get(m_start);
+      }
+    }
+
+   ~basic_scoped_sampled_timer()
+    {
+      if (m_is_sampled)
+      {
+        cpu_times current;
+        Policy::get(current);
+        current.wall -= m_start.wall;
+        current.user -= m_start.user;
+        current.system -= m_start.system;
+        m_region.add(current);
+      }
+    }
+
+    bool                  is_sampled() const       { return m_is_sampled; }
+
+  private:
+    const sampled_region& m_region;
+    const bool            m_is_sampled;
+    cpu_times             m_start;
+
+    basic_scoped_sampled_timer(const basic_scoped_sampled_timer&);
+    basic_scoped_sampled_timer& operator=(const basic_scoped_sampled_timer&);
+  };
+
+  typedef basic_scoped_sampled_timer<process_times_policy>  scoped_sampled_timer;
+  typedef basic_scoped_sampled_timer<thread_times_policy>   scoped_thread_sampled_timer;
+
+} // namespace timer
+} // namespace boost
+
+//  Times one in period executions of the rest of the enclosing scope against a region
+//  named by a string literal. The first execution on each thread is sampled, then
+//  every period'th, or for the RANDOMLY form each with probability 1/period.
+
+#define BOOST_TIMER_DETAIL_SAMPLED_REGION(name, period, method)                        \
+  static const ::boost::timer::sampled_region                                          \
+    BOOST_JOIN(boost_timer_sampled_, __LINE__)(name, period, method);                  \
+  static thread_local ::boost::int_least32_t                                           \
+    BOOST_JOIN(boost_timer_countdown_, __LINE__) = 0;                                  \
+  ::boost::timer::scoped_sampled_timer                                                 \
+    BOOST_JOIN(boost_timer_sampled_scope_, __LINE__)(                                  \
+      BOOST_JOIN(boost_timer_sampled_, __LINE__),                                      \
+      BOOST_JOIN(boost_timer_countdown_, __LINE__))
+
+#define BOOST_TIMER_SAMPLED_REGION(name, period)                                       \
+  BOOST_TIMER_DETAIL_SAMPLED_REGION(name, period, ::boost::timer::systematic_sampling)
+
+#define BOOST_TIMER_RANDOMLY_SAMPLED_REGION(name, period)                              \
+  BOOST_TIMER_DETAIL_SAMPLED_REGION(name, period, ::boost::timer::random_sampling)
+
+#   if defined(_MSC_VER)
+#     pragma warning(pop) // restore warning settings.
+#   endif
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_SAMPLED_TIMER_HPP
@@ -0,0 +1,126 @@
+//  boost/timer/sched_timer.hpp  -------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_SCHED_TIMER_HPP                  
+#define BOOST_TIMER_SCHED_TIMER_HPP
+
+#include <boost/timer/timer.hpp>
+#include <boost/timer/detail/counter_timer.hpp>
+#include <string>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+#   if defined(_MSC_VER)
+#     pragma warning(push)           // Save warning settings
+#     pragma warning(disable : 4251) // disable warning: class 'std::basic_string<_Elem,_Traits,_Ax>'
+                                     // needs to have dll-interface...
+#     pragma warning(disable : 4275) // disable warning: non dll-interface class used as
+#   endif                            // base for dll-interface class
+
+//--------------------------------------------------------------------------------------//
+
+//  A sched_timer splits the wall-clock time of a region of a thread by what the
+//  scheduler was doing with the thread: running it, holding it runnable on a run
+//  queue while other threads used the CPUs, or neither, because it was blocked on
+//  I/O, a lock, or a sleep. Much runnable time means the CPUs are saturated; much
+//  blocked time means the thread is waiting on something else.
+//
+//  The running and runnable times are the scheduler's, from the Linux
+//  /proc/thread-self/schedstat. Elsewhere, or if the kernel does not provide them,
+//  only the cpu_times are captured.
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  struct sched_times
+  {
+    nanosecond_type  running;    // on a CPU
+    nanosecond_type  runnable;   // waiting on a run queue
+    nanosecond_type  blocked;    // neither; as a difference, the rest of the wall time
+
+    void clear() { running = runnable = blocked = 0LL; }
+  };
+
+  //  Sets the calling thread's total running and runnable times, and blocked to 0.
+  //  Returns false, with current cleared, if they are not available.
+  BOOST_TIMER_DECL bool  current_sched_times(sched_times& current);
+
+  //  " %ws wall: %es running, %qs runnable, %bs blocked\n"
+  BOOST_TIMER_DECL const std::string&  default_sched_format();
+
+  namespace detail
+  {
+    //  Keeps the calling thread's statistics file open, so that each read costs one
+    //  system call
+    class BOOST_TIMER_DECL sched_source
+    {
+    public:
+      typedef sched_times counters_type;
+
+      sched_source();
+     ~sched_source();
+
+      bool is_open() const { return m_fd >= 0; }
+      bool read(sched_times& current) const;
+      //  blocked is derived, so is not subtracted
+      static void subtract(sched_times& lhs, const sched_times& rhs)
+      {
+        lhs.running -= rhs.running;
+        lhs.runnable -= rhs.runnable;
+      }
+      //  The clocks differ, so blocked is limited to reaching zero
+      void complete(sched_times& elapsed, const cpu_times& times) const
+      {
+        nanosecond_type blocked = times.wall - elapsed.running - elapsed.runnable;
+        elapsed.blocked = blocked > 0 ? blocked : 0;
+      }
+
+    private:
+      int m_fd;  // -1 if not available
+
+      sched_source(const sched_source&);
+      sched_source& operator=(const sched_source&);
+    };
+  }
+
+//  sched_timer  -----------------------------------------------------------------------//
+
+  //  Like thread_cpu_timer, and like it must be started, stopped, and resumed on the
+  //  same thread. The statistics file is kept open, so that each capture costs one
+  //  system call for them. If they are not available, has_sched() is false, sched is all
+  //  zeros, and formats show its fields as n/a. The actions, subtract_overhead(), and
+  //  the other observers are those of detail::counter_timer.
+
+  class BOOST_TIMER_DECL sched_timer
+    : public detail::counter_timer<detail::sched_source>
+  {
+  public:
+    sched_timer() : detail::counter_timer<detail::sched_source>(true) {}
+
+    //  observers
+    bool                   has_sched() const       { return source().is_open(); }
+    sched_times            elapsed_sched() const;  // does not stop()
+    std::string            format(short places = default_places,
+                                  const std::string& format = default_sched_format())
+                                                                                  const;
+  };
+
+} // namespace timer
+} // namespace boost
+
+#   if defined(_MSC_VER)
+#     pragma warning(pop) // restore warning settings.
+#   endif 
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_SCHED_TIMER_HPP
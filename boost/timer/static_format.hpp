@@ -0,0 +1,155 @@
+//  boost/timer/static_format.hpp  -----------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_STATIC_FORMAT_HPP                  
+#define BOOST_TIMER_STATIC_FORMAT_HPP
+
+#include <boost/timer/timer.hpp>
+
+#if defined(BOOST_TIMER_NO_CXX20_STATIC_FORMAT)
+# error <boost/timer/static_format.hpp> requires C++20 class-type template arguments
+#endif
+
+#include <cstddef>
+
+//--------------------------------------------------------------------------------------//
+
+//  A format string given as a template argument is parsed into format segments at
+//  compile time. A % followed by a letter that is not a field ("wustp" or an extended
+//  field) is a compile-time error rather than literal text; a % followed by anything
+//  else is literal text, as it is for formats parsed at run time.
+//
+//    auto_cpu_timer t(std::cout, 3, fmt<" %ws wall, %ts CPU\n">);
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  namespace detail
+  {
+    template <std::size_t N>
+    struct format_literal
+    {
+      char text[N];
+
+      constexpr format_literal(const char (&s)[N]) : text()
+      {
+        for (std::size_t i = 0; i != N; ++i)
+          text[i] = s[i];
+      }
+
+      static constexpr std::size_t size() { return N - 1; }
+    };
+
+    constexpr bool is_format_field(char c)
+    {
+      return c == 'w' || c == 'u' || c == 's' || c == 't' || c == 'p'
+        || c == 'f' || c == 'F' || c == 'c' || c == 'C' || c == 'i' || c == 'o'
+        || c == 'm' || c == 'e' || c == 'q' || c == 'b' || c == 'R' || c == 'W'
+        || c == 'd' || c == 'D' || c == 'y' || c == 'Y' || c == 'a' || c == 'A'
+        || c == 'K' || c == 'I' || c == 'P' || c == 'M' || c == 'H' || c == 'B'
+        || c == 'T' || c == 'G' || c == 'S' || c == 'n' || c == 'N' || c == 'L'
+        || c == 'E';
+    }
+
+    constexpr bool is_format_letter(char c)
+    {
+      return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    template <std::size_t N>
+    constexpr bool valid_format(const format_literal<N>& f)
+    {
+      for (std::size_t i = 0; i + 1 < f.size(); ++i)
+        if (f.text[i] == '%' && is_format_letter(f.text[i+1])
+          && !is_format_field(f.text[i+1]))
+          return false;
+      return true;
+    }
+
+    //  Same segmentation as parsed_format's constructor
+
+    template <std::size_t N>
+    constexpr std::size_t format_segment_count(const format_literal<N>& f)
+    {
+      std::size_t count = 0;
+      std::size_t literal_size = 0;
+      for (std::size_t i = 0; i < f.size(); ++i)
+      {
+        if (f.text[i] == '%' && i + 1 < f.size() && is_format_field(f.text[i+1]))
+        {
+          ++i;
+          ++count;
+          literal_size = 0;
+        }
+        else
+          ++literal_size;
+      }
+      return literal_size ? count + 1 : count;
+    }
+
+    template <format_literal F, std::size_t Count>
+    struct format_segments
+    {
+      format_segment segment[Count ? Count : 1];
+
+      constexpr format_segments() : segment()
+      {
+        format_segment current = { 0, 0, '\0' };
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < F.size(); ++i)
+        {
+          if (F.text[i] == '%' && i + 1 < F.size() && is_format_field(F.text[i+1]))
+          {
+            current.field = F.text[++i];
+            segment[n++] = current;
+            current.literal_begin = i + 1;
+            current.literal_size = 0;
+            current.field = '\0';
+          }
+          else
+            ++current.literal_size;
+        }
+        if (current.literal_size)
+          segment[n] = current;
+      }
+    };
+  } // namespace detail
+
+  //  static_format  -------------------------------------------------------------------//
+
+  template <detail::format_literal F>
+  class static_format
+  {
+    static_assert(detail::valid_format(F),
+      "boost::timer format: % followed by a letter that is not a format field");
+
+    static constexpr std::size_t count = detail::format_segment_count(F);
+    static constexpr detail::format_segments<F, count> segments{};
+
+  public:
+    static constexpr const char* str()     { return F.text; }
+
+    static constexpr format_view view()
+    {
+      return format_view{ F.text, segments.segment, segments.segment + count };
+    }
+
+    constexpr operator format_view() const { return view(); }
+  };
+
+  template <detail::format_literal F>
+  inline constexpr static_format<F> fmt{};
+
+} // namespace timer
+} // namespace boost
+
+#endif  // BOOST_TIMER_STATIC_FORMAT_HPP
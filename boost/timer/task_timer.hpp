@@ -0,0 +1,258 @@
+//  boost/timer/task_timer.hpp  --------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_TASK_TIMER_HPP
+#define BOOST_TIMER_TASK_TIMER_HPP
+
+#include <boost/timer/timer.hpp>
+
+#if defined(BOOST_TIMER_NO_CXX20_COROUTINES)
+# error <boost/timer/task_timer.hpp> requires C++20 coroutines
+#endif
+
+#include <boost/cstdint.hpp>
+#include <coroutine>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+//--------------------------------------------------------------------------------------//
+
+//  A task_timer times a coroutine only while it runs. Each run, from a resumption to
+//  the next suspension, is timed by a thread_cpu_timer started and stopped on the
+//  thread the coroutine runs on, so a coroutine that moves between threads is charged
+//  the CPU time of each thread while it ran there, and none while it is suspended.
+//
+//  A coroutine's co_await expressions are timed by wrapping them with timed(), or by
+//  deriving its promise type from task_timer_promise, which wraps all of them:
+//
+//    co_await boost::timer::timed(timer, socket.async_read(buffer));
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+
+//  task_timer  ------------------------------------------------------------------------//
+
+  struct task_times
+  {
+    cpu_times         active;       // wall: time running; user, system: CPU time of
+                                    //   the threads it ran on, while it ran
+    nanosecond_type   suspended;    // wall time suspended
+    boost::uint64_t   suspensions;
+  };
+
+  class task_timer
+  {
+  public:
+    //  Runs on the calling thread from construction if running is true; otherwise
+    //  starts stopped, until on_resume().
+    explicit task_timer(bool running = true)    { start(running); }
+
+    //  observers
+    bool              is_running() const        { return m_state == state_running; }
+    bool              is_suspended() const      { return m_state == state_suspended; }
+    bool              is_stopped() const        { return m_state == state_stopped; }
+
+    //  If running, must be called on the thread it runs on.
+    task_times        elapsed() const;
+    std::string       format(int places = default_places,
+                             const std::string& format = default_format()) const
+                                 { return timer::format(elapsed().active, places, format); }
+    //  actions
+    void              start(bool running = true);  // discards the times so far
+
+    //  Ends a run on the thread it ran on, and counts a suspension. No effect unless
+    //  running.
+    void              on_suspend();
+
+    //  Begins a run on the calling thread, ending a suspension or a stop(). If
+    //  suspended is false, as when await_suspend() returned false, the suspension
+    //  since on_suspend() is withdrawn: it is neither counted nor timed as suspended.
+    //  No effect if running.
+    void              on_resume(bool suspended = true);
+
+    //  Ends a run without counting a suspension, as when the coroutine completes.
+    void              stop();
+
+  private:
+    enum state_type { state_running, state_suspended, state_stopped };
+
+    thread_cpu_timer  m_run;           // the run in progress
+    task_times        m_times;         // of the runs and suspensions ended
+    nanosecond_type   m_suspended_at;  // wall clock at on_suspend()
+    state_type        m_state;
+
+    void              end_run();
+  };
+
+  inline task_times task_timer::elapsed() const
+  {
+    task_times times(m_times);
+    if (m_state == state_running)
+    {
+      const cpu_times run(m_run.elapsed());
+      times.active.wall += run.wall;
+      times.active.user += run.user;
+      times.active.system += run.system;
+    }
+    else if (m_state == state_suspended)
+      times.suspended += current_wall_time() - m_suspended_at;
+    return times;
+  }
+
+  inline void task_timer::start(bool running)
+  {
+    m_times.active.clear();
+    m_times.suspended = 0;
+    m_times.suspensions = 0;
+    m_suspended_at = 0;
+    m_state = state_stopped;
+    if (running)
+      on_resume();
+  }
+
+  inline void task_timer::end_run()
+  {
+    const cpu_times& run = m_run.stop();
+    m_times.active.wall += run.wall;
+    m_times.active.user += run.user;
+    m_times.active.system += run.system;
+  }
+
+  inline void task_timer::on_suspend()
+  {
+    if (m_state != state_running)
+      return;
+    end_run();
+    m_suspended_at = current_wall_time();
+    ++m_times.suspensions;
+    m_state = state_suspended;
+  }
+
+  inline void task_timer::on_resume(bool suspended)
+  {
+    if (m_state == state_running)
+      return;
+    if (m_state == state_suspended)
+    {
+      const nanosecond_type interval = current_wall_time() - m_suspended_at;
+      if (suspended)
+        m_times.suspended += interval;
+      else
+      {
+        m_times.active.wall += interval;
+        --m_times.suspensions;
+      }
+    }
+    m_state = state_running;
+    m_run.start();
+  }
+
+  inline void task_timer::stop()
+  {
+    if (m_state != state_running)
+      return;
+    end_run();
+    m_state = state_stopped;
+  }
+
+//  awaiter hooks  ---------------------------------------------------------------------//
+
+  namespace detail
+  {
+    //  The awaiter co_await would use for a, without a promise's await_transform().
+    template <class Awaitable>
+    decltype(auto) get_awaiter(Awaitable&& a)
+    {
+      if constexpr (requires { std::forward<Awaitable>(a).operator co_await(); })
+        return std::forward<Awaitable>(a).operator co_await();
+      else if constexpr (requires { operator co_await(std::forward<Awaitable>(a)); })
+        return operator co_await(std::forward<Awaitable>(a));
+      else
+        return std::forward<Awaitable>(a);
+    }
+  }
+
+  //  Forwards to Awaiter, suspending the timer before the coroutine may be resumed
+  //  elsewhere, and resuming it on the thread the coroutine is resumed on. Awaiter is
+  //  a reference type for an awaiter that outlives the co_await expression.
+  template <class Awaiter>
+  class timed_awaiter
+  {
+  public:
+    timed_awaiter(task_timer& timer, Awaiter&& awaiter)
+      : m_timer(timer), m_awaiter(std::forward<Awaiter>(awaiter)) {}
+
+    bool await_ready()                          { return m_awaiter.await_ready(); }
+
+    template <class Promise>
+    auto await_suspend(std::coroutine_handle<Promise> h)
+    {
+      m_timer.on_suspend();
+      if constexpr (std::is_same_v<decltype(m_awaiter.await_suspend(h)), bool>)
+      {
+        const bool suspending = m_awaiter.await_suspend(h);
+        if (!suspending)
+          m_timer.on_resume(false);
+        return suspending;  // else *this may already be destroyed
+      }
+      else
+        return m_awaiter.await_suspend(h);
+    }
+
+    decltype(auto) await_resume()
+    {
+      m_timer.on_resume();
+      return m_awaiter.await_resume();
+    }
+
+  private:
+    task_timer&  m_timer;
+    Awaiter      m_awaiter;
+  };
+
+  template <class Awaitable>
+  auto timed(task_timer& timer, Awaitable&& awaitable)
+  {
+    typedef decltype(detail::get_awaiter(std::forward<Awaitable>(awaitable))) awaiter;
+    return timed_awaiter<awaiter>(timer,
+      detail::get_awaiter(std::forward<Awaitable>(awaitable)));
+  }
+
+//  task_timer_promise  ----------------------------------------------------------------//
+
+  //  A base for promise types that times every co_await in the coroutine body. The
+  //  timer runs from the promise's construction, when the coroutine begins on the
+  //  calling thread. initial_suspend() and final_suspend() are not transformed: a
+  //  promise whose initial_suspend() suspends should return timed(timer(), ...), and
+  //  final_suspend() should stop() the timer.
+  class task_timer_promise
+  {
+  public:
+    task_timer&        timer()                  { return m_timer; }
+    const task_timer&  timer() const            { return m_timer; }
+
+    template <class Awaitable>
+    auto await_transform(Awaitable&& awaitable)
+    {
+      return timed(m_timer, std::forward<Awaitable>(awaitable));
+    }
+
+  private:
+    task_timer  m_timer;
+  };
+
+} // namespace timer
+} // namespace boost
+
+#endif  // BOOST_TIMER_TASK_TIMER_HPP
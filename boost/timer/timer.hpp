@@ -14,6 +14,8 @@
 #include <boost/chrono/chrono.hpp>
 #include <boost/cstdint.hpp>
 #include <string>
+#include <vector>
+#include <cstddef>
 #include <cstring>
 #include <ostream>
 
@@ -36,8 +38,15 @@ namespace boost
 {
 namespace timer
 {
-  class cpu_timer;
+  template <class Policy> class basic_cpu_timer;
   class auto_cpu_timer;
+  class auto_thread_cpu_timer;
+  class async_sink;
+  struct resource_usage;
+  struct sched_times;
+  struct io_counters;
+  struct perf_counters;
+  struct concurrency_stats;
 
   typedef boost::int_least64_t nanosecond_type;
 
@@ -60,18 +69,258 @@ namespace timer
                      short places = default_places,
                      const std::string& fmt = default_format()); 
 
-//  cpu_timer  ---------------------------------------------------------------------//
+  //  A format string, parsed once so that it can be applied repeatedly without
+  //  scanning. Each segment is a run of literal text followed by an optional field.
 
-  class BOOST_TIMER_DECL cpu_timer
+  struct format_segment
+  {
+    std::size_t   literal_begin;  // offset into the format string
+    std::size_t   literal_size;
+    char          field;          // one of "wustp", an extended field, or '\0'
+  };
+
+  //  A parsed format that refers to, but does not own, its text and segments. Views of
+  //  compile-time formats (see <boost/timer/static_format.hpp>) refer to static data.
+
+  struct format_view
+  {
+    const char*            text;
+    const format_segment*  first;
+    const format_segment*  last;
+  };
+
+  class BOOST_TIMER_DECL parsed_format
   {
   public:
+    explicit parsed_format(const std::string& fmt = default_format());
+
+    const std::string&     str() const             { return m_format; }
+    format_view            view() const
+                             { format_view v = { m_format.c_str(), begin(), end() };
+                               return v; }
+    const format_segment*  begin() const
+                             { return m_segments.empty() ? 0 : &m_segments[0]; }
+    const format_segment*  end() const             { return begin() + m_segments.size(); }
+
+  private:
+    std::string                  m_format;
+    std::vector<format_segment>  m_segments;
+  };
+
+  //  Like format(), but into buf, without allocating. As for snprintf, at most n-1
+  //  characters are written followed by a null, and the return is the length of the
+  //  complete result; if it is n or more, the output was truncated.
+
+  BOOST_TIMER_DECL
+  std::size_t format_to(char* buf, std::size_t n, const cpu_times& times,
+                        short places = default_places,
+                        const std::string& fmt = default_format());
+  BOOST_TIMER_DECL
+  std::size_t format_to(char* buf, std::size_t n, const cpu_times& times,
+                        short places, const parsed_format& fmt);
+  BOOST_TIMER_DECL
+  std::size_t format_to(char* buf, std::size_t n, const cpu_times& times,
+                        short places, const format_view& fmt);
+
+  BOOST_TIMER_DECL
+  std::string format(const cpu_times& times, short places, const format_view& fmt);
+
+  //  Values other than cpu_times that a format may refer to, by its extended fields.
+  //  Fields whose value is null are replaced by "n/a". The overloads above know only
+  //  "wustp", and copy the extended fields as literal text, as they always have.
+  //  All members are null on construction; set those the format needs by name.
+
+  struct format_extras
+  {
+    const resource_usage*     usage;        // %f %F %c %C %i %o %m; see
+                                            //   resource_timer.hpp
+    const sched_times*        sched;        // %e %q %b; see sched_timer.hpp
+    const io_counters*        io;           // %R %W %d %D %y %Y %a %A; see
+                                            //   io_timer.hpp
+    const perf_counters*      perf;         // %K %I %P %M %H %B %T %G %S; see
+                                            //   perf_counter_timer.hpp
+    const concurrency_stats*  concurrency;  // %n %N %L %E; see
+                                            //   concurrent_cpu_timer.hpp
+
+    format_extras() : usage(0), sched(0), io(0), perf(0), concurrency(0) {}
+  };
+
+  BOOST_TIMER_DECL
+  std::size_t format_to(char* buf, std::size_t n, const cpu_times& times,
+                        const format_extras& extras, short places,
+                        const std::string& fmt);
+  BOOST_TIMER_DECL
+  std::size_t format_to(char* buf, std::size_t n, const cpu_times& times,
+                        const format_extras& extras, short places,
+                        const format_view& fmt);
+
+  BOOST_TIMER_DECL
+  std::string format(const cpu_times& times, const format_extras& extras,
+                     short places, const std::string& fmt);
+  BOOST_TIMER_DECL
+  std::string format(const cpu_times& times, const format_extras& extras,
+                     short places, const format_view& fmt);
+
+//  wall-clock sources  ----------------------------------------------------------------//
+
+  //  The clock used to obtain cpu_times::wall. tsc_wall_clock reads the x86 time stamp
+  //  counter, converted to nanoseconds by a one-time calibration against the steady
+  //  clock. It is only available if the processor reports an invariant TSC;
+  //  otherwise set_wall_clock(tsc_wall_clock) returns false and the current clock
+  //  remains in use. Defining BOOST_TIMER_USE_TSC when building the library makes
+  //  tsc_wall_clock the default wherever it is available.
+
+  enum wall_clock_type
+  {
+    high_resolution_wall_clock,  // boost::chrono::high_resolution_clock; the default
+    tsc_wall_clock               // invariant time stamp counter
+  };
+
+  BOOST_TIMER_DECL wall_clock_type  wall_clock();
+  BOOST_TIMER_DECL bool             set_wall_clock(wall_clock_type type);
+  BOOST_TIMER_DECL const char*      wall_clock_name(wall_clock_type type);
+  BOOST_TIMER_DECL bool             tsc_is_invariant();  // calibrates on first call
+  BOOST_TIMER_DECL double           tsc_frequency();     // ticks per second; 0 if
+                                                         //   not invariant
+
+//  CPU time sources  ------------------------------------------------------------------//
+
+  //  The operating system API used to obtain cpu_times::user and cpu_times::system.
+  //  Which sources are available depends on the platform; set_cpu_clock() returns
+  //  false and leaves the current source unchanged if the requested one is not.
+
+  enum cpu_clock_type
+  {
+    times_clock,          // POSIX times(): clock tick resolution, includes the times
+                          //   of terminated children that have been waited for
+    rusage_clock,         // POSIX getrusage(RUSAGE_SELF): microsecond resolution;
+                          //   the POSIX default. Unlike times_clock, excludes
+                          //   children; earlier releases used times()
+    cputime_clock,        // POSIX clock_gettime(CLOCK_PROCESS_CPUTIME_ID): nanosecond
+                          //   total, split into user and system by getrusage()
+    process_times_clock   // Windows GetProcessTimes(): the Windows default
+  };
+
+  BOOST_TIMER_DECL cpu_clock_type   cpu_clock();
+  BOOST_TIMER_DECL bool             set_cpu_clock(cpu_clock_type type);
+  BOOST_TIMER_DECL const char*      cpu_clock_name(cpu_clock_type type);
+  BOOST_TIMER_DECL nanosecond_type  cpu_clock_resolution(cpu_clock_type type);
+                                     // nominal resolution; -1 if unavailable
+
+//  current time values  ---------------------------------------------------------------//
+
+  //  Obtain the current time values from the sources selected above.
+  //  current_process_cpu() and current_thread_cpu() set only the user and system
+  //  members of their argument.
+
+  BOOST_TIMER_DECL nanosecond_type  current_wall_time();
+  BOOST_TIMER_DECL void             current_process_cpu(cpu_times& current);
+  BOOST_TIMER_DECL void             current_thread_cpu(cpu_times& current);
+
+//  capture policies  ------------------------------------------------------------------//
+
+  //  A capture policy determines which current time values a basic_cpu_timer obtains.
+  //  Its static get() member sets every member of a cpu_times, so fields that are not
+  //  captured are reported as 0. Timers that capture only the wall field never call
+  //  the operating system for CPU times.
+
+  enum cpu_times_field
+  {
+    wall_field    = 1,
+    user_field    = 2,
+    system_field  = 4,
+    thread_field  = 8   // user and system are charged to the calling thread
+  };
+
+  template <unsigned Fields>
+  struct capture_policy
+  {
+    static void get(cpu_times& current)
+    {
+      current.wall = (Fields & wall_field) ? current_wall_time() : 0;
+      if (Fields & (user_field | system_field))
+      {
+        if (Fields & thread_field)
+          current_thread_cpu(current);
+        else
+          current_process_cpu(current);
+        if (!(Fields & user_field))
+          current.user = 0;
+        if (!(Fields & system_field))
+          current.system = 0;
+      }
+      else
+        current.user = current.system = 0;
+    }
+  };
+
+  typedef capture_policy<wall_field | user_field | system_field>  process_times_policy;
+  typedef capture_policy<wall_field | user_field | system_field | thread_field>
+                                                                   thread_times_policy;
+  typedef capture_policy<wall_field>                               wall_time_policy;
+
+//  timer overhead  --------------------------------------------------------------------//
+
+  //  The cost of timing an empty region, i.e. of capturing the times for start() and
+  //  again for stop(), as seen by the timer itself. Each field is estimated separately,
+  //  by the interquartile mean over the trials, with the median absolute deviation as
+  //  its spread.
+
+  struct overhead_calibration
+  {
+    cpu_times   overhead;
+    cpu_times   deviation;
+    unsigned    trials;
+  };
+
+  BOOST_TIMER_DECL
+  overhead_calibration calibrate_overhead(void (*get)(cpu_times&), unsigned trials = 1001);
+
+  namespace detail
+  {
+    //  Subtracts overhead from each member of times, limited to reaching zero
+    inline void remove_overhead(cpu_times& times, const cpu_times& overhead)
+    {
+      times.wall = times.wall > overhead.wall ? times.wall - overhead.wall : 0;
+      times.user = times.user > overhead.user ? times.user - overhead.user : 0;
+      times.system = times.system > overhead.system ? times.system - overhead.system : 0;
+    }
+
+    template <class Policy>
+    overhead_calibration& overhead_data()
+    {
+      static overhead_calibration calibration = calibrate_overhead(&Policy::get);
+      return calibration;
+    }
+  }
+
+  //  Calibrated on first use for each Policy. Recalibrating, after changing the cpu or
+  //  wall clock for example, must not be concurrent with other use of the calibration.
+
+  template <class Policy>
+  const overhead_calibration& timer_overhead()   { return detail::overhead_data<Policy>(); }
+
+  template <class Policy>
+  const overhead_calibration& recalibrate_timer_overhead()
+  {
+    return detail::overhead_data<Policy>() = calibrate_overhead(&Policy::get);
+  }
+
+//  basic_cpu_timer  -------------------------------------------------------------------//
+
+  template <class Policy>
+  class basic_cpu_timer
+  {
+  public:
+    typedef Policy    policy_type;
 
     //  constructors, destructor
-    cpu_timer()                                    { start(); }
-   ~cpu_timer()                                    {}
+    basic_cpu_timer() : m_subtract_overhead(false) { start(); }
+   ~basic_cpu_timer()                              {}
 
     //  observers
     bool              is_stopped() const           { return m_is_stopped; }
+    bool              subtracts_overhead() const   { return m_subtract_overhead; }
     cpu_times         elapsed() const;  // does not stop()
     std::string       format(int places = default_places,
                              const std::string& format = default_format()) const
@@ -81,11 +330,87 @@ namespace timer
     const cpu_times&  stop();
     void              resume(); 
 
+    //  If subtract is true, each interval from start() or resume() to stop() or
+    //  elapsed() has timer_overhead<Policy>() subtracted, limited to reaching zero.
+    //  The calibration is made here if need be, so never in the interval timed.
+    void              subtract_overhead(bool subtract = true)
+                        { if (subtract) timer_overhead<Policy>();
+                          m_subtract_overhead = subtract; }
+
   private:
     cpu_times         m_times;
     bool              m_is_stopped;
+    bool              m_subtract_overhead;
+
+    void              correct(cpu_times& times) const;
   };
 
+  //  thread_cpu_timer is like cpu_timer, except that user and system times are those
+  //  charged to the calling thread rather than to the whole process. A thread_cpu_timer
+  //  must be started, stopped, and resumed on the same thread.
+
+  typedef basic_cpu_timer<process_times_policy>  cpu_timer;
+  typedef basic_cpu_timer<thread_times_policy>   thread_cpu_timer;
+  typedef basic_cpu_timer<wall_time_policy>      wall_timer;
+
+  template <class Policy>
+  void basic_cpu_timer<Policy>::start()
+  {
+    m_is_stopped = false;
+    Policy::get(m_times);
+  }
+
+  template <class Policy>
+  const cpu_times& basic_cpu_timer<Policy>::stop()
+  {
+    if (is_stopped())
+      return m_times;
+    m_is_stopped = true;
+      
+    cpu_times current;
+    Policy::get(current);
+    m_times.wall = (current.wall - m_times.wall);
+    m_times.user = (current.user - m_times.user);
+    m_times.system = (current.system - m_times.system);
+    if (m_subtract_overhead)
+      correct(m_times);
+    return m_times;
+  }
+
+  template <class Policy>
+  cpu_times basic_cpu_timer<Policy>::elapsed() const
+  {
+    if (is_stopped())
+      return m_times;
+    cpu_times current;
+    Policy::get(current);
+    current.wall -= m_times.wall;
+    current.user -= m_times.user;
+    current.system -= m_times.system;
+    if (m_subtract_overhead)
+      correct(current);
+    return current;
+  }
+
+  template <class Policy>
+  void basic_cpu_timer<Policy>::correct(cpu_times& times) const
+  {
+    detail::remove_overhead(times, timer_overhead<Policy>().overhead);
+  }
+
+  template <class Policy>
+  void basic_cpu_timer<Policy>::resume()
+  {
+    if (is_stopped())
+    {
+      cpu_times current (m_times);
+      start();
+      m_times.wall   -= current.wall;
+      m_times.user   -= current.user;
+      m_times.system -= current.system;
+    }
+  }
+
 //  auto_cpu_timer  --------------------------------------------------------------------//
 
   class BOOST_TIMER_DECL auto_cpu_timer : public cpu_timer
@@ -102,12 +427,23 @@ namespace timer
     explicit auto_cpu_timer(std::ostream& os,
                             short places = default_places,
                             const std::string& format = default_format())
-                                   : m_places(places), m_os(os), m_format(format)
+                                   : m_places(places), m_os(os), m_format(format), m_view(), m_sink(0)
                                    { start(); }
     auto_cpu_timer(std::ostream& os, const std::string& format)
-                                   : m_places(default_places), m_os(os), m_format(format)
+                                   : m_places(default_places), m_os(os), m_format(format), m_view(), m_sink(0)
                                    { start(); }
 
+    //  Reports using a format parsed in advance, such as a compile-time format. The
+    //  text and segments referred to by format must outlive the timer.
+    auto_cpu_timer(std::ostream& os, short places, const format_view& format)
+                                   : m_places(places), m_os(os), m_view(format), m_sink(0)
+                                   { start(); }
+
+    //  Reports are pushed to sink, which formats and writes them on its background
+    //  thread; see <boost/timer/async_sink.hpp>.
+    explicit auto_cpu_timer(async_sink& sink, short places = default_places);
+    auto_cpu_timer(async_sink& sink, short places, const format_view& format);
+
    ~auto_cpu_timer();
 
     void   report(); 
@@ -116,6 +452,51 @@ namespace timer
     int             m_places;
     std::ostream&   m_os;
     std::string     m_format;  
+    format_view     m_view;    // used instead of m_format if m_view.text
+    async_sink*     m_sink;    // if non-null, reports are pushed rather than written
+  };
+
+//  auto_thread_cpu_timer  -------------------------------------------------------------//
+
+  class BOOST_TIMER_DECL auto_thread_cpu_timer : public thread_cpu_timer
+  {
+  public:
+
+    //  See auto_cpu_timer for why there are no explicit defaults to std::cout.
+
+    explicit auto_thread_cpu_timer(short places = default_places,
+                                   const std::string& format = default_format());
+    explicit auto_thread_cpu_timer(const std::string& format);
+    explicit auto_thread_cpu_timer(std::ostream& os,
+                                   short places = default_places,
+                                   const std::string& format = default_format())
+                                   : m_places(places), m_os(os), m_format(format), m_view(), m_sink(0)
+                                   { start(); }
+    auto_thread_cpu_timer(std::ostream& os, const std::string& format)
+                                   : m_places(default_places), m_os(os), m_format(format), m_view(), m_sink(0)
+                                   { start(); }
+
+    //  Reports using a format parsed in advance, such as a compile-time format. The
+    //  text and segments referred to by format must outlive the timer.
+    auto_thread_cpu_timer(std::ostream& os, short places, const format_view& format)
+                                   : m_places(places), m_os(os), m_view(format), m_sink(0)
+                                   { start(); }
+
+    //  Reports are pushed to sink, which formats and writes them on its background
+    //  thread; see <boost/timer/async_sink.hpp>.
+    explicit auto_thread_cpu_timer(async_sink& sink, short places = default_places);
+    auto_thread_cpu_timer(async_sink& sink, short places, const format_view& format);
+
+   ~auto_thread_cpu_timer();
+
+    void   report(); 
+
+  private:
+    int             m_places;
+    std::ostream&   m_os;
+    std::string     m_format;  
+    format_view     m_view;    // used instead of m_format if m_view.text
+    async_sink*     m_sink;    // if non-null, reports are pushed rather than written
   };
    
 } // namespace timer
@@ -0,0 +1,131 @@
+//  boost/timer/trace.hpp  -------------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#ifndef BOOST_TIMER_TRACE_HPP                  
+#define BOOST_TIMER_TRACE_HPP
+
+#include <boost/timer/timer.hpp>
+
+#if defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+# error <boost/timer/trace.hpp> requires C++11 atomics, threads, and thread_local
+#endif
+
+#include <boost/cstdint.hpp>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+#include <boost/config/abi_prefix.hpp> // must be the last #include
+
+//--------------------------------------------------------------------------------------//
+
+//  Trace recording. While a trace is active, scoped traces record begin and end events
+//  as 16 byte records in a buffer per thread. Full buffers are appended to the trace
+//  file, which is memory-mapped where the platform allows, and has a fixed maximum
+//  size; records that do not fit are dropped and counted. write_chrome_trace() turns
+//  a trace file into Chrome trace_event JSON, as read by chrome://tracing and Perfetto.
+//
+//  File layout, in the byte order of the recording machine:
+//    header: "BTTRACE1", uint32 record size (16), uint32 0x01020304, uint64 start time
+//            in ns from current_wall_time(), uint64 reserved
+//    records: trace_record, in the order their buffers were appended; each thread's
+//            records are in the order they were recorded
+
+//--------------------------------------------------------------------------------------//
+
+namespace boost
+{
+namespace timer
+{
+  enum trace_record_kind
+  {
+    begin_record = 1,
+    end_record = 2,
+    instant_record = 3,
+    name_record = 4     // size bytes of a name's text, in place of time
+  };
+
+  struct trace_record
+  {
+    boost::uint8_t    kind;
+    boost::uint8_t    size;    // name_record only
+    boost::uint16_t   thread;  // numbered from 1 in order of first record
+    boost::uint32_t   name;    // name id
+    boost::uint64_t   time;    // ns since the trace started
+  };
+
+//  trace_name  ------------------------------------------------------------------------//
+
+  //  Names are registered once, and written to every trace file started afterwards or
+  //  active at the time.
+  class BOOST_TIMER_DECL trace_name
+  {
+  public:
+    explicit trace_name(const std::string& name);
+    boost::uint32_t  id() const                    { return m_id; }
+
+  private:
+    boost::uint32_t  m_id;
+  };
+
+//  recording  -------------------------------------------------------------------------//
+
+  //  Starts recording to path, truncating it. At most max_bytes are written. Returns
+  //  false, with errno set, if a trace is already active (EBUSY), max_bytes cannot hold
+  //  the header and a record (EINVAL), or the file cannot be created.
+  BOOST_TIMER_DECL bool  start_trace(const std::string& path,
+                                     std::size_t max_bytes = 64 * 1024 * 1024);
+
+  //  Appends the calling thread's buffer, and closes the file. Other threads' records
+  //  are kept only if they were appended: by a full buffer, flush_thread_trace(), or
+  //  thread exit. No thread may be recording concurrently.
+  BOOST_TIMER_DECL void  stop_trace();
+
+  BOOST_TIMER_DECL bool             trace_active();
+  BOOST_TIMER_DECL void             flush_thread_trace();
+  BOOST_TIMER_DECL boost::uint64_t  trace_dropped();  // records, since start_trace()
+
+  //  Do nothing unless a trace is active
+  BOOST_TIMER_DECL void  trace_begin(const trace_name& name);
+  BOOST_TIMER_DECL void  trace_end(const trace_name& name);
+  BOOST_TIMER_DECL void  trace_instant(const trace_name& name);
+
+  class scoped_trace
+  {
+  public:
+    explicit scoped_trace(const trace_name& name) : m_name(name) { trace_begin(name); }
+   ~scoped_trace()                                 { trace_end(m_name); }
+
+  private:
+    const trace_name&  m_name;
+
+    scoped_trace(const scoped_trace&);
+    scoped_trace& operator=(const scoped_trace&);
+  };
+
+//  conversion  ------------------------------------------------------------------------//
+
+  //  Reads a trace file from in, which must be opened in binary mode, and writes it to
+  //  out as Chrome trace_event JSON. Returns false, writing nothing, if in does not
+  //  begin with a trace file header or holds a malformed name record.
+  BOOST_TIMER_DECL bool  write_chrome_trace(std::istream& in, std::ostream& out);
+
+} // namespace timer
+} // namespace boost
+
+//  Traces the rest of the enclosing scope under a name given by a string literal
+
+#define BOOST_TIMER_TRACE_SCOPE(name)                                                 \
+  static const ::boost::timer::trace_name BOOST_JOIN(boost_timer_trace_, __LINE__)(name); \
+  ::boost::timer::scoped_trace                                                         \
+    BOOST_JOIN(boost_timer_trace_scope_, __LINE__)(BOOST_JOIN(boost_timer_trace_, __LINE__))
+
+#include <boost/config/abi_suffix.hpp> // pops abi_prefix.hpp pragmas
+
+#endif  // BOOST_TIMER_TRACE_HPP
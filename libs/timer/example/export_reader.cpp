@@ -0,0 +1,109 @@
+//  export_reader: print the regions exported by a running process  ----------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/region_export.hpp>
+#include <boost/timer/sampled_timer.hpp>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+
+namespace
+{
+  void print( const boost::timer::export_snapshot & snap )
+  {
+    const boost::timer::nanosecond_type age
+      = boost::timer::current_wall_time() - snap.updated;
+    std::cout << "pid " << snap.pid << ", " << snap.publications
+      << " publications, last " << std::fixed << std::setprecision( 3 )
+      << age / 1e9 << "s ago\n";
+    if ( snap.region_count > snap.regions.size() )
+      std::cout << snap.region_count - snap.regions.size()
+        << " regions not exported; the export's capacity is too small\n";
+
+    std::cout << std::left << std::setw( 32 ) << "region" << std::right
+      << std::setw( 12 ) << "count" << std::setw( 12 ) << "wall s"
+      << std::setw( 12 ) << "user s" << std::setw( 12 ) << "system s"
+      << std::setw( 8 ) << "CPU %" << std::setw( 14 ) << "mean wall s" << '\n';
+    for ( std::size_t i = 0; i < snap.regions.size(); ++i )
+    {
+      //  a sampled region's totals are extrapolated to all its executions
+      const boost::timer::region_stats & s = snap.regions[i];
+      const boost::timer::sampled_estimate e = boost::timer::estimate_totals( s );
+      const boost::uint64_t count = static_cast<boost::uint64_t>( e.executions + 0.5 );
+      boost::timer::cpu_times mean = e.total;
+      if ( count )
+        mean.wall /= static_cast<boost::timer::nanosecond_type>( count );
+      if ( s.name.size() >= 32 )  // on a line of its own
+        std::cout << s.name << '\n' << std::setw( 32 ) << "";
+      else
+        std::cout << std::left << std::setw( 32 ) << s.name;
+      std::cout << std::right << std::setw( 12 ) << count
+        << std::setw( 12 ) << boost::timer::format( e.total, 3, "%w" )
+        << std::setw( 12 ) << boost::timer::format( e.total, 3, "%u" )
+        << std::setw( 12 ) << boost::timer::format( e.total, 3, "%s" )
+        << std::setw( 8 ) << boost::timer::format( e.total, 1, "%p" )
+        << std::setw( 14 ) << boost::timer::format( mean, 6, "%w" );
+      if ( s.sampling_period > 1 )
+        std::cout << "  estimated from 1 in " << s.sampling_period;
+      std::cout << '\n';
+    }
+  }
+}
+
+int main( int argc, char * argv[] )
+{
+  unsigned interval_ms = 1000;
+  long repetitions = 1;
+  int arg = 1;
+  for ( ; arg < argc - 1 && argv[arg][0] == '-'; arg += 2 )
+  {
+    if ( std::strcmp( argv[arg], "-i" ) == 0 )
+      interval_ms = static_cast<unsigned>( std::atol( argv[arg+1] ) );
+    else if ( std::strcmp( argv[arg], "-n" ) == 0 )
+      repetitions = std::atol( argv[arg+1] );
+    else
+      break;
+  }
+
+  if ( arg != argc - 1 )
+  {
+    std::cout << "invoke: export_reader [-i interval-ms] [-n repetitions] name\n"
+      "  prints the regions exported by boost::timer::start_export, under the\n"
+      "  shared memory object name, such as /boost_timer.1234; with -n, prints\n"
+      "  them repetitions times, every interval-ms milliseconds (default 1000),\n"
+      "  or until the export is removed if repetitions is 0\n";
+    return 1;
+  }
+
+  boost::timer::export_snapshot snap;
+  for ( long n = 0; repetitions == 0 || n < repetitions; ++n )
+  {
+    if ( n > 0 )
+    {
+      std::this_thread::sleep_for( std::chrono::milliseconds( interval_ms ) );
+      std::cout << '\n';
+    }
+    if ( !boost::timer::read_export( argv[arg], snap ) )
+    {
+      if ( n > 0 && errno == ENOENT )
+        return 0;  // the process stopped exporting
+      std::cerr << "export_reader: " << argv[arg] << ": "
+        << ( errno == EPROTO ? "not a region export of a known version"
+                             : std::strerror( errno ) ) << '\n';
+      return 1;
+    }
+    print( snap );
+  }
+  return 0;
+}
@@ -0,0 +1,131 @@
+//  timer_compare: compare benchmark results with a baseline  ----------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/baseline.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+  bool read( const char * path, boost::timer::baseline & b )
+  {
+    std::ifstream in( path );
+    if ( !in )
+    {
+      std::cerr << "timer_compare: cannot open " << path << '\n';
+      return false;
+    }
+    if ( !boost::timer::read_baseline( in, b ) )
+    {
+      std::cerr << "timer_compare: " << path << " is not a baseline file\n";
+      return false;
+    }
+    return true;
+  }
+
+  void warn_if_different( const char * what, const std::string & base,
+    const std::string & candidate )
+  {
+    if ( base != candidate )
+      std::cout << "warning: " << what << " differs: " << base << " vs. " << candidate
+        << '\n';
+  }
+
+  const char * verdict_name( boost::timer::compare_verdict v )
+  {
+    return v == boost::timer::regressed ? "REGRESSED"
+      : v == boost::timer::improved ? "improved" : "";
+  }
+}
+
+int main( int argc, char * argv[] )
+{
+  boost::timer::compare_options options;
+  int arg = 1;
+  for ( ; arg < argc && argv[arg][0] == '-'; ++arg )
+  {
+    if ( std::strcmp( argv[arg], "--cpu" ) == 0 )
+      options.cpu = true;
+    else if ( std::strcmp( argv[arg], "-a" ) == 0 && arg + 1 < argc )
+      options.alpha = std::atof( argv[++arg] );
+    else if ( std::strcmp( argv[arg], "-t" ) == 0 && arg + 1 < argc )
+      options.threshold = std::atof( argv[++arg] ) / 100.0;
+    else
+      break;
+  }
+
+  if ( argc - arg != 2 )
+  {
+    std::cout << "invoke: timer_compare [-a alpha] [-t threshold-percent] [--cpu]"
+      " baseline-file candidate-file\n"
+      "  compares each case of candidate-file with the case of the same name in\n"
+      "  baseline-file, as written by boost::timer::write_baseline, by a Mann-Whitney\n"
+      "  U test of the wall-clock times per iteration, or the CPU times with --cpu.\n"
+      "  A case has regressed if its p-value is below alpha (default 0.05) and its\n"
+      "  median is more than threshold-percent (default 1) above the baseline's.\n"
+      "  Exits with 1 if any case regressed, 2 on error, else 0.\n";
+    return 2;
+  }
+
+  boost::timer::baseline base, candidate;
+  if ( !read( argv[arg], base ) || !read( argv[arg+1], candidate ) )
+    return 2;
+
+  const boost::timer::baseline_metadata & bm = base.metadata;
+  const boost::timer::baseline_metadata & cm = candidate.metadata;
+  warn_if_different( "host", bm.host, cm.host );
+  warn_if_different( "wall clock", bm.wall_clock, cm.wall_clock );
+  warn_if_different( "CPU clock", bm.cpu_clock, cm.cpu_clock );
+  if ( bm.tsc_frequency > 0.0 && cm.tsc_frequency > 0.0
+    && std::abs( bm.tsc_frequency / cm.tsc_frequency - 1.0 ) > 0.01 )
+    std::cout << "warning: TSC frequency differs by more than 1%\n";
+  if ( !bm.label.empty() || !cm.label.empty() )
+    std::cout << "baseline: " << bm.label << ", candidate: " << cm.label << '\n';
+
+  const std::vector<boost::timer::case_comparison> results
+    = boost::timer::compare( base, candidate, options );
+
+  std::cout << std::left << std::setw( 32 ) << "case" << std::right
+    << std::setw( 14 ) << "baseline ns" << std::setw( 14 ) << "candidate ns"
+    << std::setw( 9 ) << "change" << std::setw( 20 ) << "95% interval"
+    << std::setw( 10 ) << "p" << "\n";
+  int regressions = 0;
+  for ( std::size_t i = 0; i < results.size(); ++i )
+  {
+    const boost::timer::case_comparison & r = results[i];
+    if ( r.name.size() >= 32 )  // on a line of its own
+      std::cout << r.name << '\n' << std::setw( 32 ) << "";
+    else
+      std::cout << std::left << std::setw( 32 ) << r.name;
+    std::ostringstream interval;
+    interval << std::fixed << std::setprecision( 1 ) << '['
+      << ( r.ratio_low - 1.0 ) * 100 << "%, " << ( r.ratio_high - 1.0 ) * 100 << "%]";
+    std::cout << std::right << std::fixed << std::setprecision( 1 )
+      << std::setw( 14 ) << r.baseline_median << std::setw( 14 ) << r.candidate_median
+      << std::setw( 8 ) << std::showpos << ( r.ratio - 1.0 ) * 100 << std::noshowpos
+      << '%' << std::setw( 20 ) << interval.str()
+      << std::setw( 10 ) << std::setprecision( 4 ) << r.p_value
+      << "  " << verdict_name( r.verdict ) << '\n';
+    if ( r.verdict == boost::timer::regressed )
+      ++regressions;
+  }
+
+  std::size_t skipped = candidate.cases.size() - results.size();
+  if ( skipped )
+    std::cout << skipped << " candidate cases not in the baseline, or without samples\n";
+  std::cout << regressions << " of " << results.size() << " cases regressed\n";
+  return regressions ? 1 : 0;
+}
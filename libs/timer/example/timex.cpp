@@ -8,40 +8,311 @@
 //  See http://www.boost.org/libs/timer for documentation.
 
 #include <boost/timer/timer.hpp>
+#include <boost/timer/benchmark.hpp>
+#include <boost/system/api_config.hpp>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <string>
 #include <iostream>
+#include <vector>
 
-int main( int argc, char * argv[] )
+#if defined(BOOST_POSIX_API)
+# include <cerrno>
+# include <cstdio>
+# include <sys/resource.h>
+# include <sys/time.h>
+# include <sys/types.h>
+# include <sys/wait.h>
+# include <unistd.h>
+#endif
+
+namespace
 {
-  if ( argc == 1 )
+  //  what is measured for each run; the resource usage is -1 where unavailable
+  enum metric
+  {
+    wall_ns, user_ns, system_ns, max_rss_kb, major_faults, minor_faults,
+    voluntary_switches, involuntary_switches, metric_count
+  };
+
+  const char* const metric_names[metric_count] =
+  {
+    "wall_ns", "user_ns", "system_ns", "max_rss_kb", "major_faults", "minor_faults",
+    "voluntary_switches", "involuntary_switches"
+  };
+
+  struct run_result
+  {
+    double  value[metric_count];
+    int     status;  // as a shell would report it
+  };
+
+#if defined(BOOST_POSIX_API)
+
+  //  Runs the command directly, without a shell, and collects its resource usage
+  bool run( char * argv[], const std::string &, run_result & r )
   {
-    std::cout << "invoke: timex [-v] command [args...]\n"
+    std::cout.flush();  // else the child's output may precede ours
+    boost::timer::wall_timer t;
+    pid_t pid = ::fork();
+    if ( pid < 0 )
+    {
+      std::perror( "timex: fork" );
+      return false;
+    }
+    if ( pid == 0 )
+    {
+      ::execvp( argv[0], argv );
+      std::fprintf( stderr, "timex: %s: %s\n", argv[0], std::strerror( errno ) );
+      ::_exit( 127 );
+    }
+
+    int status;
+    struct rusage ru;
+    while ( ::wait4( pid, &status, 0, &ru ) < 0 )
+    {
+      if ( errno != EINTR )
+      {
+        std::perror( "timex: wait4" );
+        return false;
+      }
+    }
+    r.value[wall_ns] = static_cast<double>( t.elapsed().wall );
+
+    r.value[user_ns] = ru.ru_utime.tv_sec * 1e9 + ru.ru_utime.tv_usec * 1e3;
+    r.value[system_ns] = ru.ru_stime.tv_sec * 1e9 + ru.ru_stime.tv_usec * 1e3;
+# if defined(__APPLE__)
+    r.value[max_rss_kb] = static_cast<double>( ru.ru_maxrss / 1024 );  // bytes
+# else
+    r.value[max_rss_kb] = static_cast<double>( ru.ru_maxrss );
+# endif
+    r.value[major_faults] = static_cast<double>( ru.ru_majflt );
+    r.value[minor_faults] = static_cast<double>( ru.ru_minflt );
+    r.value[voluntary_switches] = static_cast<double>( ru.ru_nvcsw );
+    r.value[involuntary_switches] = static_cast<double>( ru.ru_nivcsw );
+    r.status = WIFEXITED( status ) ? WEXITSTATUS( status ) : 128 + WTERMSIG( status );
+    return true;
+  }
+
+#else
+
+  //  Runs the command through the shell; resource usage is not available
+  bool run( char * [], const std::string & command, run_result & r )
+  {
+    boost::timer::cpu_timer t;
+    r.status = std::system( command.c_str() );
+    boost::timer::cpu_times times = t.elapsed();
+    r.value[wall_ns] = static_cast<double>( times.wall );
+    r.value[user_ns] = static_cast<double>( times.user );
+    r.value[system_ns] = static_cast<double>( times.system );
+    for ( int m = max_rss_kb; m < metric_count; ++m )
+      r.value[m] = -1.0;
+    return true;
+  }
+
+#endif
+
+  boost::timer::cpu_times times_of( const double value[] )
+  {
+    boost::timer::cpu_times times;
+    times.wall = static_cast<boost::timer::nanosecond_type>( value[wall_ns] );
+    times.user = static_cast<boost::timer::nanosecond_type>( value[user_ns] );
+    times.system = static_cast<boost::timer::nanosecond_type>( value[system_ns] );
+    return times;
+  }
+
+  void report_run( std::ostream & os, const run_result & r )
+  {
+    os << boost::timer::format( times_of( r.value ), 3,
+      " %ws elapsed wall-clock time, %us user + %ss system = %ts CPU (%p%)\n" );
+    if ( r.value[max_rss_kb] >= 0.0 )
+      os << ' ' << r.value[max_rss_kb] << " KB max RSS, "
+         << r.value[major_faults] << " major + " << r.value[minor_faults]
+         << " minor page faults, " << r.value[voluntary_switches] << " voluntary + "
+         << r.value[involuntary_switches] << " involuntary context switches\n";
+  }
+
+  void report_statistics( std::ostream & os, const boost::timer::sample_statistics
+    stats[], std::size_t runs, std::size_t warmup )
+  {
+    static const char* const labels[metric_count] =
+    {
+      "wall (s)", "user (s)", "system (s)", "max RSS (KB)", "major faults",
+      "minor faults", "voluntary switches", "involuntary switches"
+    };
+
+    os << ' ' << runs << " runs after " << warmup << " warmup:\n"
+       << std::setw( 22 ) << "" << std::setw( 12 ) << "mean" << std::setw( 12 )
+       << "median" << std::setw( 12 ) << "stddev" << std::setw( 12 ) << "min"
+       << std::setw( 12 ) << "max" << '\n';
+    for ( int m = 0; m < metric_count; ++m )
+    {
+      if ( stats[m].min < 0.0 )  // unavailable
+        continue;
+      const double scale = m <= system_ns ? 1e-9 : 1.0;
+      os << ' ' << std::left << std::setw( 21 ) << labels[m] << std::right
+         << std::fixed << std::setprecision( m <= system_ns ? 3 : 1 )
+         << std::setw( 12 ) << stats[m].mean * scale
+         << std::setw( 12 ) << stats[m].median * scale
+         << std::setw( 12 ) << stats[m].stddev * scale
+         << std::setw( 12 ) << stats[m].min * scale
+         << std::setw( 12 ) << stats[m].max * scale << '\n';
+    }
+  }
+
+  //  one row per run, then the statistics when there are several runs
+  void write_csv( std::ostream & os, const std::vector<run_result> & results,
+    const boost::timer::sample_statistics stats[] )
+  {
+    os << "run,status";
+    for ( int m = 0; m < metric_count; ++m )
+      os << ',' << metric_names[m];
+    os << '\n' << std::fixed << std::setprecision( 0 );
+    for ( std::size_t i = 0; i < results.size(); ++i )
+    {
+      os << i + 1 << ',' << results[i].status;
+      for ( int m = 0; m < metric_count; ++m )
+      {
+        os << ',';
+        if ( results[i].value[m] >= 0.0 )
+          os << results[i].value[m];
+      }
+      os << '\n';
+    }
+    if ( results.size() < 2 )
+      return;
+
+    static const char* const rows[] = { "mean", "median", "stddev", "min", "max" };
+    os << std::setprecision( 3 );
+    for ( int row = 0; row < 5; ++row )
+    {
+      os << rows[row] << ',';
+      for ( int m = 0; m < metric_count; ++m )
+      {
+        os << ',';
+        const boost::timer::sample_statistics & s = stats[m];
+        if ( s.min >= 0.0 )
+          os << ( row == 0 ? s.mean : row == 1 ? s.median : row == 2 ? s.stddev
+            : row == 3 ? s.min : s.max );
+      }
+      os << '\n';
+    }
+  }
+
+  int usage()
+  {
+    std::cout << "invoke: timex [options] command [args...]\n"
       "  command will be executed and timings displayed\n"
-      "  -v option causes command and args to be displayed\n";
+      "  -v option causes command and args to be displayed\n"
+      "  -n N runs the command N times, and displays statistics\n"
+      "  -w W runs the command W times first, untimed; default 1 if N > 1\n"
+      "  -m displays machine-readable CSV, one row per run\n"
+      "  -o file writes the timings to file instead of standard output\n"
+      "  command is run directly, not through a shell, where the platform allows;\n"
+      "  runs stop at the first that fails, and its exit status is returned\n";
     return 1;
   }
+}
 
-  std::string s;
-
+int main( int argc, char * argv[] )
+{
   bool verbose = false;
-  if ( argc > 1 && *argv[1] == '-' && *(argv[1]+1) == 'v' )
+  bool csv = false;
+  long runs = 1;
+  long warmup = -1;
+  const char * output = 0;
+
+  for ( ++argv, --argc; argc > 0 && **argv == '-'; ++argv, --argc )
   {
-    verbose = true;
-    ++argv;
-    --argc;
+    const std::string option( *argv );
+    if ( option == "--" )
+    {
+      ++argv;
+      --argc;
+      break;
+    }
+    else if ( option == "-v" )
+      verbose = true;
+    else if ( option == "-m" )
+      csv = true;
+    else if ( ( option == "-n" || option == "-w" || option == "-o" ) && argc > 1 )
+    {
+      ++argv;
+      --argc;
+      if ( option == "-o" )
+        output = *argv;
+      else if ( option == "-n" && ( runs = std::atol( *argv ) ) < 1 )
+        return usage();
+      else if ( option == "-w" && ( warmup = std::atol( *argv ) ) < 0 )
+        return usage();
+    }
+    else
+      return usage();
   }
+  if ( argc == 0 )
+    return usage();
+  if ( warmup < 0 )
+    warmup = runs > 1 ? 1 : 0;
+
+  std::string s;
 
-  for ( int i = 1; i < argc; ++i )
+  for ( int i = 0; i < argc; ++i )
   {
-    if ( i > 1 ) s += ' ';
+    if ( i > 0 ) s += ' ';
     s += argv[i];
   }
 
+  std::ofstream file;
+  if ( output )
+  {
+    file.open( output );
+    if ( !file )
+    {
+      std::cerr << "timex: cannot create " << output << '\n';
+      return 1;
+    }
+  }
+  std::ostream & os = output ? static_cast<std::ostream &>( file ) : std::cout;
+
   if ( verbose )
     { std::cout << "command: \"" << s.c_str() << "\"\n"; }
 
-  boost::timer::auto_cpu_timer t(" %ws elapsed wall-clock time\n");
+  run_result r;
+  for ( long i = 0; i < warmup; ++i )
+  {
+    if ( !run( argv, s, r ) )
+      return 1;
+    if ( r.status != 0 )
+      return r.status;
+  }
+
+  std::vector<run_result> results;
+  for ( long i = 0; i < runs; ++i )
+  {
+    if ( !run( argv, s, r ) )
+      return 1;
+    results.push_back( r );
+    if ( r.status != 0 )
+      break;
+  }
+
+  boost::timer::sample_statistics stats[metric_count];
+  for ( int m = 0; m < metric_count; ++m )
+  {
+    std::vector<double> values;
+    for ( std::size_t i = 0; i < results.size(); ++i )
+      values.push_back( results[i].value[m] );
+    stats[m] = boost::timer::summarize( values );
+  }
+
+  if ( csv )
+    write_csv( os, results, stats );
+  else if ( results.size() == 1 )
+    report_run( os, results[0] );
+  else
+    report_statistics( os, stats, results.size(), static_cast<std::size_t>( warmup ) );
 
-  return std::system( s.c_str() );
+  return results.back().status;
 }
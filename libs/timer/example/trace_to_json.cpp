@@ -0,0 +1,49 @@
+//  trace_to_json: convert a trace file to Chrome trace JSON  ----------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/trace.hpp>
+#include <fstream>
+#include <iostream>
+
+int main( int argc, char * argv[] )
+{
+  if ( argc < 2 || argc > 3 )
+  {
+    std::cout << "invoke: trace_to_json trace-file [json-file]\n"
+      "  trace-file, as written by boost::timer::start_trace, is converted to\n"
+      "  Chrome trace JSON, viewable with chrome://tracing or ui.perfetto.dev;\n"
+      "  the JSON is written to json-file if given, otherwise to standard output\n";
+    return 1;
+  }
+
+  std::ifstream in( argv[1], std::ios_base::binary );
+  if ( !in )
+  {
+    std::cerr << "trace_to_json: cannot open " << argv[1] << '\n';
+    return 1;
+  }
+
+  std::ofstream file;
+  if ( argc == 3 )
+  {
+    file.open( argv[2] );
+    if ( !file )
+    {
+      std::cerr << "trace_to_json: cannot create " << argv[2] << '\n';
+      return 1;
+    }
+  }
+
+  if ( !boost::timer::write_chrome_trace( in, argc == 3 ? file : std::cout ) )
+  {
+    std::cerr << "trace_to_json: " << argv[1] << " is not a trace file\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,309 @@
+//  boost async_sink.cpp  --------------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/config.hpp>
+
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+
+#include <boost/timer/async_sink.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+using boost::timer::cpu_times;
+using boost::timer::format_view;
+
+namespace
+{
+  struct record
+  {
+    cpu_times     times;
+    format_view   fmt;
+    short         places;
+  };
+
+  //  The ring is Dmitry Vyukov's bounded queue: each cell's sequence says whether it is
+  //  ready for the producer claiming position pos (sequence == pos) or for the consumer
+  //  reading it (sequence == pos + 1). A push is one CAS on the enqueue position.
+  struct cell
+  {
+    std::atomic<std::size_t>  sequence;
+    record                    data;
+  };
+
+  std::size_t round_up_to_power_of_2(std::size_t n)
+  {
+    std::size_t p = 2;
+    while (p < n)
+      p <<= 1;
+    return p;
+  }
+}  // unnamed namespace
+
+namespace boost
+{
+  namespace timer
+  {
+    struct async_sink::impl
+    {
+      impl(std::ostream& os_, std::size_t capacity, overflow_policy policy_)
+        : os(os_), policy(policy_), mask(round_up_to_power_of_2(capacity) - 1),
+          cells(new cell[mask + 1]), enqueue_pos(0), dequeue_pos(0), written(0),
+          dropped(0), sleeping(false), flushed(0), flush_requests(0), stopping(false)
+      {
+        for (std::size_t i = 0; i <= mask; ++i)
+          cells[i].sequence.store(i, std::memory_order_relaxed);
+        thread = std::thread(&impl::run, this);
+      }
+
+      ~impl() { delete [] cells; }
+
+      bool try_push(const record& r)
+      {
+        std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        cell* c;
+        for (;;)
+        {
+          c = &cells[pos & mask];
+          std::size_t seq = c->sequence.load(std::memory_order_acquire);
+          std::ptrdiff_t dif
+            = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+          if (dif == 0)
+          {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                  std::memory_order_relaxed))
+              break;
+          }
+          else if (dif < 0)
+            return false;  // full
+          else
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+        c->data = r;
+        c->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+
+      //  consumer only
+      bool empty() const
+      {
+        return cells[dequeue_pos & mask].sequence.load(std::memory_order_acquire)
+          != dequeue_pos + 1;
+      }
+
+      bool try_pop(record& r)
+      {
+        if (empty())
+          return false;
+        cell& c = cells[dequeue_pos & mask];
+        r = c.data;
+        c.sequence.store(dequeue_pos + mask + 1, std::memory_order_release);
+        ++dequeue_pos;
+        return true;
+      }
+
+      void wake()
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          sleeping.store(false, std::memory_order_relaxed);
+        }
+        wakeup.notify_one();
+      }
+
+      void write(const char* s, std::size_t n, bool flush)
+      {
+        try
+        {
+          os.write(s, static_cast<std::streamsize>(n));
+          if (flush)
+            os.flush();
+        }
+        catch (...) // an exception cannot be reported from the background thread
+        {
+        }
+      }
+
+      void run();
+
+      std::ostream&             os;
+      const overflow_policy     policy;
+      const std::size_t         mask;
+      cell*                     cells;
+      parsed_format             default_parsed;
+
+      std::atomic<std::size_t>  enqueue_pos;
+      char                      pad[64];   // keep producers off the consumer's line
+      std::size_t               dequeue_pos;
+      std::atomic<boost::uint64_t>  written;
+      std::atomic<boost::uint64_t>  dropped;
+
+      //  A producer that finds sleeping set after its push wakes the background thread.
+      //  Both sides fence between their store and load, so one always sees the other.
+      std::atomic<bool>         sleeping;
+      std::mutex                mutex;
+      std::condition_variable   wakeup;          // background thread waits
+      std::condition_variable   done;            // flush() waits
+      std::size_t               flushed;         // guarded by mutex
+      unsigned                  flush_requests;  // guarded by mutex
+      bool                      stopping;        // guarded by mutex
+
+      std::string               batch;           // background thread only
+      std::thread               thread;
+    };
+
+    void async_sink::impl::run()
+    {
+      record r;
+      char buf[256];
+      for (;;)
+      {
+        //  format at most one ring's worth at a time, so flushes are not starved
+        batch.clear();
+        std::size_t n = 0;
+        for (; n <= mask && try_pop(r); ++n)
+        {
+          std::size_t length = format_to(buf, sizeof(buf), r.times, r.places, r.fmt);
+          if (length < sizeof(buf))
+            batch.append(buf, length);
+          else
+            batch += format(r.times, r.places, r.fmt);
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        bool flush = (flush_requests != 0 || empty()) && flushed != dequeue_pos;
+        if (n || flush)
+        {
+          lock.unlock();  // producers waking this thread must not wait for the I/O
+          write(batch.data(), batch.size(), flush);
+          written.store(dequeue_pos, std::memory_order_relaxed);
+          lock.lock();
+        }
+        if (flush)
+        {
+          flushed = dequeue_pos;
+          done.notify_all();
+        }
+        if (n)
+          continue;
+
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!empty())
+        {
+          sleeping.store(false, std::memory_order_relaxed);
+          continue;
+        }
+        if (stopping)
+          return;
+        while (sleeping.load(std::memory_order_relaxed) && !stopping)
+          wakeup.wait(lock);
+      }
+    }
+
+    //  async_sink  --------------------------------------------------------------------//
+
+    async_sink::async_sink(std::ostream& os, std::size_t capacity,
+                           overflow_policy policy)
+      : m_impl(new impl(os, capacity, policy)) {}
+
+    async_sink::~async_sink()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->stopping = true;
+      }
+      m_impl->wakeup.notify_one();
+      m_impl->thread.join();
+      delete m_impl;
+    }
+
+    bool async_sink::push(const cpu_times& times, short places, const format_view& fmt)
+    {
+      record r;
+      r.times = times;
+      r.fmt = fmt;
+      r.places = places;
+      while (!m_impl->try_push(r))
+      {
+        if (m_impl->policy == drop_on_overflow)
+        {
+          m_impl->dropped.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+        m_impl->wake();
+        std::this_thread::yield();
+      }
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (m_impl->sleeping.load(std::memory_order_relaxed))
+        m_impl->wake();
+      return true;
+    }
+
+    void async_sink::flush()
+    {
+      //  includes pushes still in progress; the background thread waits for them
+      const std::size_t target = m_impl->enqueue_pos.load();
+      std::unique_lock<std::mutex> lock(m_impl->mutex);
+      ++m_impl->flush_requests;
+      m_impl->sleeping.store(false, std::memory_order_relaxed);
+      m_impl->wakeup.notify_one();
+      while (static_cast<std::ptrdiff_t>(m_impl->flushed - target) < 0)
+        m_impl->done.wait(lock);
+      --m_impl->flush_requests;
+    }
+
+    std::ostream& async_sink::stream() const       { return m_impl->os; }
+    std::size_t async_sink::capacity() const       { return m_impl->mask + 1; }
+    async_sink::overflow_policy async_sink::policy() const { return m_impl->policy; }
+    format_view async_sink::default_view() const   { return m_impl->default_parsed.view(); }
+
+    boost::uint64_t async_sink::written() const
+    {
+      return m_impl->written.load(std::memory_order_relaxed);
+    }
+
+    boost::uint64_t async_sink::dropped() const
+    {
+      return m_impl->dropped.load(std::memory_order_relaxed);
+    }
+
+    //  auto timers  -------------------------------------------------------------------//
+
+    auto_cpu_timer::auto_cpu_timer(async_sink& sink, short places)
+      : m_places(places), m_os(sink.stream()), m_view(sink.default_view()),
+        m_sink(&sink) { start(); }
+
+    auto_cpu_timer::auto_cpu_timer(async_sink& sink, short places,
+                                   const format_view& format)
+      : m_places(places), m_os(sink.stream()), m_view(format), m_sink(&sink)
+      { start(); }
+
+    auto_thread_cpu_timer::auto_thread_cpu_timer(async_sink& sink, short places)
+      : m_places(places), m_os(sink.stream()), m_view(sink.default_view()),
+        m_sink(&sink) { start(); }
+
+    auto_thread_cpu_timer::auto_thread_cpu_timer(async_sink& sink, short places,
+                                                 const format_view& format)
+      : m_places(places), m_os(sink.stream()), m_view(format), m_sink(&sink)
+      { start(); }
+
+  } // namespace timer
+} // namespace boost
+
+#endif  // !BOOST_TIMER_NO_CXX11_CONCURRENCY
@@ -12,13 +12,20 @@
 #define BOOST_TIMER_SOURCE 
 
 #include <boost/timer/timer.hpp>
-#include <boost/io/ios_state.hpp>
+#include <boost/timer/resource_timer.hpp>
+#include <boost/timer/sched_timer.hpp>
+#include <boost/timer/io_timer.hpp>
+#include <boost/timer/perf_counter_timer.hpp>
+#include <boost/timer/concurrent_cpu_timer.hpp>
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+# include <boost/timer/async_sink.hpp>
+#endif
 #include <string>
-#include <sstream>
 #include <cstring>
 
 using boost::timer::nanosecond_type;
 using boost::timer::cpu_times;
+using boost::timer::format_extras;
 using boost::system::error_code;
 
 # if defined(BOOST_WINDOWS_API)
@@ -33,59 +40,407 @@ namespace
 {
   //  cpu_timer helpers  ---------------------------------------------------------------//
 
-  void show_time(const cpu_times& times,
-    std::ostream& os, const std::string& fmt, short places)
-  //  NOTE WELL: Will truncate least-significant digits to LDBL_DIG, which may
-  //  be as low as 10, although will be 15 for many common platforms.
+  //  Formatting is done with integer arithmetic into a caller supplied buffer, so it
+  //  needs no allocation and is unaffected by locale or stream state. Seconds are
+  //  rounded to nearest, ties to even, which for values exactly representable in
+  //  binary is what the floating point stream insertion this replaces produced.
+
+  //  snprintf-like: writes at most size-1 characters and a terminating null, while
+  //  counting every character that would have been written.
+  struct writer
+  {
+    char*         buf;
+    std::size_t   size;
+    std::size_t   length;
+
+    writer(char* b, std::size_t n) : buf(b), size(n), length(0) {}
+
+    void put(char c)
+    {
+      if (length + 1 < size)
+        buf[length] = c;
+      ++length;
+    }
+
+    void put(const char* p, std::size_t n)
+    {
+      if (length + 1 < size)
+      {
+        std::size_t room = size - 1 - length;
+        std::memcpy(buf + length, p, n < room ? n : room);
+      }
+      length += n;
+    }
+
+    std::size_t finish()
+    {
+      if (size)
+        buf[length < size ? length : size - 1] = '\0';
+      return length;
+    }
+  };
+
+  const boost::uint64_t powers_of_10[] = { 1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL,
+    100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL };
+
+  void put_digits(writer& w, boost::uint64_t v, unsigned min_digits)
+  {
+    char digits[20];
+    unsigned n = 0;
+    do
+    {
+      digits[n++] = static_cast<char>('0' + v % 10);
+      v /= 10;
+    } while (v);
+    while (n < min_digits)
+      digits[n++] = '0';
+    while (n)
+      w.put(digits[--n]);
+  }
+
+  //  ns as seconds, to places decimal places
+  void put_seconds(writer& w, nanosecond_type ns, short places)
+  {
+    boost::uint64_t magnitude;
+    if (ns < 0)
+    {
+      w.put('-');
+      magnitude = 0 - static_cast<boost::uint64_t>(ns);
+    }
+    else
+      magnitude = static_cast<boost::uint64_t>(ns);
+
+    const boost::uint64_t divisor = powers_of_10[9 - places];
+    boost::uint64_t q = magnitude / divisor;
+    const boost::uint64_t r = magnitude % divisor;
+    if (r * 2 > divisor || (r * 2 == divisor && (q & 1)))
+      ++q;
+
+    put_digits(w, q / powers_of_10[places], 1);
+    if (places)
+    {
+      w.put('.');
+      put_digits(w, q % powers_of_10[places], places);
+    }
+  }
+
+  //  10^exponent * num / den, to places decimal places
+  void put_ratio(writer& w, boost::uint64_t num, boost::uint64_t den, int exponent,
+    int places = 1)
+  {
+    while (den >= (1ULL << 59))  // so that remainders times 10 cannot overflow
+    {
+      num >>= 1;
+      den >>= 1;
+    }
+
+    boost::uint64_t q = num / den;
+    boost::uint64_t r = num % den;
+    for (int i = 0; i < exponent + places; ++i)
+    {
+      r *= 10;
+      q = q * 10 + r / den;
+      r %= den;
+    }
+    if (r * 2 > den || (r * 2 == den && (q & 1)))
+      ++q;
+
+    put_digits(w, q / powers_of_10[places], 1);
+    w.put('.');
+    put_digits(w, q % powers_of_10[places], places);
+  }
+
+  //  100 * total / wall, to one decimal place
+  void put_percentage(writer& w, nanosecond_type total, nanosecond_type wall)
+  {
+    if (wall <= 1000000 || total <= 1000000)  // 1 millisecond
+      w.put("n/a", 3);
+    else
+      put_ratio(w, static_cast<boost::uint64_t>(total),
+        static_cast<boost::uint64_t>(wall), 2);
+  }
+
+  //  num / den, scaled, or n/a if either was not captured or den is 0
+  void put_ratio(writer& w, const boost::int_least64_t* num,
+    const boost::int_least64_t* den, int exponent, int places)
+  {
+    if (!num || !den || *num < 0 || *den <= 0)
+      w.put("n/a", 3);
+    else
+      put_ratio(w, static_cast<boost::uint64_t>(*num),
+        static_cast<boost::uint64_t>(*den), exponent, places);
+  }
+
+  //  perf's value for event, or null if not counted
+  const boost::int_least64_t* perf_value(const boost::timer::perf_counters* perf,
+    boost::timer::perf_event_type event)
+  {
+    return perf && perf->has(event) ? &perf->value[event] : 0;
+  }
+
+  //  bytes per wall time as MB (10^6 bytes) per second, to one decimal place; n/a if
+  //  not captured
+  void put_rate(writer& w, const boost::int_least64_t* bytes, nanosecond_type wall)
+  {
+    if (!bytes || *bytes < 0 || wall <= 0)
+      w.put("n/a", 3);
+    else
+      put_ratio(w, static_cast<boost::uint64_t>(*bytes),
+        static_cast<boost::uint64_t>(wall), 3);
+  }
+
+  //  a count, or n/a if it was not captured
+  void put_count(writer& w, const boost::int_least64_t* count)
+  {
+    if (!count)
+      w.put("n/a", 3);
+    else if (*count < 0)
+    {
+      w.put('-');
+      put_digits(w, 0 - static_cast<boost::uint64_t>(*count), 1);
+    }
+    else
+      put_digits(w, static_cast<boost::uint64_t>(*count), 1);
+  }
+
+  //  100 * total / (wall * threads), to one decimal place; n/a if not captured
+  void put_efficiency(writer& w, const cpu_times& times,
+    const boost::timer::concurrency_stats* concurrency)
+  {
+    if (!concurrency || concurrency->threads <= 0)
+      w.put("n/a", 3);
+    else
+      put_percentage(w, times.system + times.user, times.wall * concurrency->threads);
+  }
+
+  const format_extras no_extras;
+
+  //  seconds, or n/a if they were not captured
+  void put_seconds(writer& w, const nanosecond_type* ns, short places)
+  {
+    if (ns)
+      put_seconds(w, *ns, places);
+    else
+      w.put("n/a", 3);
+  }
+
+  //  "wustp", then the extended fields
+  inline bool is_field(char c)
+  {
+    return c != '\0' && std::strchr("wustpfFcCiomeqbRWdDyYaAKIPMBHTGSnNLE", c) != 0;
+  }
+
+  //  The fields of the overloads without extras. Other % sequences are copied as
+  //  literal text, as they were before the extended fields existed.
+  inline bool is_basic_field(char c)
+  {
+    return c != '\0' && std::strchr("wustp", c) != 0;
+  }
+
+  void put_field(writer& w, char field, const cpu_times& times,
+    const format_extras& extras, short places)
+  {
+    const boost::timer::resource_usage* usage = extras.usage;
+    const boost::timer::sched_times* sched = extras.sched;
+    const boost::timer::io_counters* io = extras.io;
+    const boost::timer::perf_counters* perf = extras.perf;
+    const boost::timer::concurrency_stats* concurrency = extras.concurrency;
+    switch (field)
+    {
+    case 'w':
+      put_seconds(w, times.wall, places);
+      break;
+    case 'u':
+      put_seconds(w, times.user, places);
+      break;
+    case 's':
+      put_seconds(w, times.system, places);
+      break;
+    case 't':
+      put_seconds(w, times.system + times.user, places);
+      break;
+    case 'p':
+      put_percentage(w, times.system + times.user, times.wall);
+      break;
+    case 'f':
+      put_count(w, usage ? &usage->minor_faults : 0);
+      break;
+    case 'F':
+      put_count(w, usage ? &usage->major_faults : 0);
+      break;
+    case 'c':
+      put_count(w, usage ? &usage->voluntary_switches : 0);
+      break;
+    case 'C':
+      put_count(w, usage ? &usage->involuntary_switches : 0);
+      break;
+    case 'i':
+      put_count(w, usage ? &usage->block_inputs : 0);
+      break;
+    case 'o':
+      put_count(w, usage ? &usage->block_outputs : 0);
+      break;
+    case 'm':
+      put_count(w, usage ? &usage->max_rss : 0);
+      break;
+    case 'e':
+      put_seconds(w, sched ? &sched->running : 0, places);
+      break;
+    case 'q':
+      put_seconds(w, sched ? &sched->runnable : 0, places);
+      break;
+    case 'b':
+      put_seconds(w, sched ? &sched->blocked : 0, places);
+      break;
+    case 'R':
+      put_count(w, io ? &io->read_chars : 0);
+      break;
+    case 'W':
+      put_count(w, io ? &io->write_chars : 0);
+      break;
+    case 'd':
+      put_count(w, io ? &io->read_bytes : 0);
+      break;
+    case 'D':
+      put_count(w, io ? &io->write_bytes : 0);
+      break;
+    case 'y':
+      put_count(w, io ? &io->read_calls : 0);
+      break;
+    case 'Y':
+      put_count(w, io ? &io->write_calls : 0);
+      break;
+    case 'a':
+      put_rate(w, io ? &io->read_chars : 0, times.wall);
+      break;
+    case 'A':
+      put_rate(w, io ? &io->write_chars : 0, times.wall);
+      break;
+    case 'K':
+      put_count(w, perf_value(perf, boost::timer::cycles_event));
+      break;
+    case 'I':
+      put_count(w, perf_value(perf, boost::timer::instructions_event));
+      break;
+    case 'P':
+      put_ratio(w, perf_value(perf, boost::timer::instructions_event),
+        perf_value(perf, boost::timer::cycles_event), 0, 2);
+      break;
+    case 'M':
+      put_count(w, perf_value(perf, boost::timer::cache_misses_event));
+      break;
+    case 'H':
+      put_ratio(w, perf_value(perf, boost::timer::cache_misses_event),
+        perf_value(perf, boost::timer::instructions_event), 3, 2);
+      break;
+    case 'B':
+      put_count(w, perf_value(perf, boost::timer::branch_misses_event));
+      break;
+    case 'T':
+      put_seconds(w, perf_value(perf, boost::timer::task_clock_event), places);
+      break;
+    case 'G':
+      put_count(w, perf_value(perf, boost::timer::page_faults_event));
+      break;
+    case 'S':
+      put_count(w, perf_value(perf, boost::timer::context_switches_event));
+      break;
+    case 'n':
+      put_count(w, concurrency ? &concurrency->segments : 0);
+      break;
+    case 'N':
+      put_count(w, concurrency ? &concurrency->threads : 0);
+      break;
+    case 'L':
+      put_seconds(w, concurrency ? &concurrency->busy : 0, places);
+      break;
+    case 'E':
+      put_efficiency(w, times, concurrency);
+      break;
+    }
+  }
+
+  //  extras is null for the overloads without extras
+  std::size_t format_fields(char* buf, std::size_t n, const cpu_times& times,
+    const format_extras* extras, short places, const std::string& fmt);
+  std::size_t format_fields(char* buf, std::size_t n, const cpu_times& times,
+    const format_extras* extras, short places, const boost::timer::format_view& fmt);
+
+  short clamp_places(short places)
   {
     if (places > 9)
-      places = 9;
+      return 9;
     else if (places < 0)
-      places = boost::timer::default_places;
- 
-    boost::io::ios_flags_saver ifs(os);
-    boost::io::ios_precision_saver ips(os);
-    os.setf(std::ios_base::fixed, std::ios_base::floatfield);
-    os.precision(places);
+      return boost::timer::default_places;
+    return places;
+  }
+
+  //  Format is std::string or format_view
+  template <class Format>
+  void show_time(const cpu_times& times,
+    std::ostream& os, const Format& fmt, short places)
+  {
+    char buf[256];
+    std::size_t length = boost::timer::format_to(buf, sizeof(buf), times, places, fmt);
+    if (length < sizeof(buf))
+      os.write(buf, length);
+    else
+      os << boost::timer::format(times, places, fmt);
+  }
 
-    const long double sec = 1000000000.0L;
-    nanosecond_type total = times.system + times.user;
-    long double wall_sec = times.wall / sec;
-    long double total_sec = total / sec;
+  //  Format is std::string or format_view
+  template <class Format>
+  std::string format_string(const cpu_times& times, const format_extras* extras,
+    short places, const Format& fmt)
+  {
+    char buf[128];
+    std::size_t length = format_fields(buf, sizeof(buf), times, extras, places, fmt);
+    if (length < sizeof(buf))
+      return std::string(buf, length);
+    std::string s(length + 1, '\0');
+    format_fields(&s[0], s.size(), times, extras, places, fmt);
+    s.resize(length);
+    return s;
+  }
 
+  std::size_t format_fields(char* buf, std::size_t n, const cpu_times& times,
+    const format_extras* extras, short places, const std::string& fmt)
+  {
+    places = clamp_places(places);
+    writer w(buf, n);
     for (const char* format = fmt.c_str(); *format; ++format)
     {
-      if (*format != '%' || !*(format+1) || !std::strchr("wustp", *(format+1)))
-        os << *format;  // anything except % followed by a valid format character
-                        // gets sent to the output stream
+      if (*format != '%'
+        || !(extras ? is_field(*(format+1)) : is_basic_field(*(format+1))))
+        w.put(*format);  // anything except % followed by a valid format character
+                         // gets sent to the output
+      else
+        put_field(w, *++format, times, extras ? *extras : no_extras, places);
+    }
+    return w.finish();
+  }
+
+  std::size_t format_fields(char* buf, std::size_t n, const cpu_times& times,
+    const format_extras* extras, short places, const boost::timer::format_view& fmt)
+  {
+    places = clamp_places(places);
+    writer w(buf, n);
+    for (const boost::timer::format_segment* it = fmt.first; it != fmt.last; ++it)
+    {
+      w.put(fmt.text + it->literal_begin, it->literal_size);
+      if (!it->field)
+        continue;
+      if (extras)
+        put_field(w, it->field, times, *extras, places);
+      else if (is_basic_field(it->field))
+        put_field(w, it->field, times, no_extras, places);
       else
       {
-        ++format;
-        switch (*format)
-        {
-        case 'w':
-          os << times.wall / sec;
-          break;
-        case 'u':
-          os << times.user / sec;
-          break;
-        case 's':
-          os << times.system / sec;
-          break;
-        case 't':
-          os << total / sec;
-          break;
-        case 'p':
-          os.precision(1);
-          if (wall_sec > 0.001L && total_sec > 0.001L)
-            os << (total_sec/wall_sec) * 100.0;
-          else
-            os << "n/a";
-          os.precision(places);
-          break;
-        }
+        w.put('%');
+        w.put(it->field);
       }
     }
+    return w.finish();
   }
 
 }  // unnamed namespace
@@ -96,19 +451,105 @@ namespace boost
   {
     //  format  ------------------------------------------------------------------------//
 
+    BOOST_TIMER_DECL
+    std::size_t format_to(char* buf, std::size_t n, const cpu_times& times,
+                          short places, const std::string& fmt)
+    {
+      return format_fields(buf, n, times, 0, places, fmt);
+    }
+
+    BOOST_TIMER_DECL
+    std::size_t format_to(char* buf, std::size_t n, const cpu_times& times,
+                          short places, const parsed_format& fmt)
+    {
+      return format_fields(buf, n, times, 0, places, fmt.view());
+    }
+
+    BOOST_TIMER_DECL
+    std::size_t format_to(char* buf, std::size_t n, const cpu_times& times,
+                          short places, const format_view& fmt)
+    {
+      return format_fields(buf, n, times, 0, places, fmt);
+    }
+
+    BOOST_TIMER_DECL
+    std::size_t format_to(char* buf, std::size_t n, const cpu_times& times,
+                          const format_extras& extras, short places,
+                          const std::string& fmt)
+    {
+      return format_fields(buf, n, times, &extras, places, fmt);
+    }
+
+    BOOST_TIMER_DECL
+    std::size_t format_to(char* buf, std::size_t n, const cpu_times& times,
+                          const format_extras& extras, short places,
+                          const format_view& fmt)
+    {
+      return format_fields(buf, n, times, &extras, places, fmt);
+    }
+
     BOOST_TIMER_DECL
     std::string format(const cpu_times& times, short places, const std::string& fmt)
     {
-      std::stringstream ss;
-      show_time(times, ss, fmt, places);
-      return ss.str();
+      return format_string(times, 0, places, fmt);
+    }
+
+    BOOST_TIMER_DECL
+    std::string format(const cpu_times& times, short places, const format_view& fmt)
+    {
+      return format_string(times, 0, places, fmt);
+    }
+
+    BOOST_TIMER_DECL
+    std::string format(const cpu_times& times, const format_extras& extras,
+                       short places, const std::string& fmt)
+    {
+      return format_string(times, &extras, places, fmt);
+    }
+
+    BOOST_TIMER_DECL
+    std::string format(const cpu_times& times, const format_extras& extras,
+                       short places, const format_view& fmt)
+    {
+      return format_string(times, &extras, places, fmt);
+    }
+
+    //  parsed_format  -----------------------------------------------------------------//
+
+    parsed_format::parsed_format(const std::string& fmt)
+      : m_format(fmt)
+    {
+      format_segment segment = { 0, 0, '\0' };
+      for (std::size_t i = 0; i < m_format.size(); ++i)
+      {
+        if (m_format[i] == '%' && i + 1 < m_format.size() && is_field(m_format[i+1]))
+        {
+          segment.field = m_format[++i];
+          m_segments.push_back(segment);
+          segment.literal_begin = i + 1;
+          segment.literal_size = 0;
+          segment.field = '\0';
+        }
+        else
+          ++segment.literal_size;
+      }
+      if (segment.literal_size)
+        m_segments.push_back(segment);
     }
  
     //  auto_cpu_timer  ----------------------------------------------------------------//
 
     void auto_cpu_timer::report()
     {
-        show_time(stop(), m_os, m_format, m_places);
+#     if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+        if (m_sink)
+          m_sink->push(stop(), m_places, m_view);
+        else
+#     endif
+        if (m_view.text)
+          show_time(stop(), m_os, m_view, m_places);
+        else
+          show_time(stop(), m_os, m_format, m_places);
         resume();
     }
 
@@ -125,6 +566,36 @@ namespace boost
         }
       }
     }
+ 
+    //  auto_thread_cpu_timer  ---------------------------------------------------------//
+
+    void auto_thread_cpu_timer::report()
+    {
+#     if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+        if (m_sink)
+          m_sink->push(stop(), m_places, m_view);
+        else
+#     endif
+        if (m_view.text)
+          show_time(stop(), m_os, m_view, m_places);
+        else
+          show_time(stop(), m_os, m_format, m_places);
+        resume();
+    }
+
+    auto_thread_cpu_timer::~auto_thread_cpu_timer()
+    { 
+      if (!is_stopped())
+      {
+        try
+        {
+          report();
+        }
+        catch (...) // eat any exceptions
+        {
+        }
+      }
+    }
 
   } // namespace timer
 } // namespace boost
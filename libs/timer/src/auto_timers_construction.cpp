@@ -28,10 +28,16 @@ namespace boost
   namespace timer
   {
     auto_cpu_timer::auto_cpu_timer(short places, const std::string& format)
-      : m_places(places), m_os(std::cout), m_format(format) { start(); }
+      : m_places(places), m_os(std::cout), m_format(format), m_view(), m_sink(0) { start(); }
 
     auto_cpu_timer::auto_cpu_timer(const std::string& format)
-      : m_places(default_places), m_os(std::cout), m_format(format) { start(); }
+      : m_places(default_places), m_os(std::cout), m_format(format), m_view(), m_sink(0) { start(); }
+
+    auto_thread_cpu_timer::auto_thread_cpu_timer(short places, const std::string& format)
+      : m_places(places), m_os(std::cout), m_format(format), m_view(), m_sink(0) { start(); }
+
+    auto_thread_cpu_timer::auto_thread_cpu_timer(const std::string& format)
+      : m_places(default_places), m_os(std::cout), m_format(format), m_view(), m_sink(0) { start(); }
 
   } // namespace timer
 } // namespace boost
@@ -0,0 +1,429 @@
+//  boost baseline.cpp  ----------------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/baseline.hpp>
+#include <boost/chrono/chrono.hpp>
+#include <boost/system/api_config.hpp>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <istream>
+#include <limits>
+#include <locale>
+#include <ostream>
+#include <sstream>
+
+# if defined(BOOST_WINDOWS_API)
+#   include <windows.h>
+# elif defined(BOOST_POSIX_API)
+#   include <unistd.h>
+# endif
+
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::baseline;
+using boost::timer::baseline_case;
+using boost::timer::baseline_metadata;
+using boost::timer::compare_options;
+
+namespace
+{
+  const char* const magic = "boost_timer_baseline";
+  const int version = 1;
+
+  //  Above this many values in either sample, or with ties, the U test uses the
+  //  normal approximation; the exact distribution takes O(n1 * n2 * n1 * n2) time.
+  const std::size_t max_exact = 50;
+
+  std::string host_name()
+  {
+# if defined(BOOST_WINDOWS_API)
+    char buf[MAX_COMPUTERNAME_LENGTH + 1];
+    DWORD size = sizeof(buf);
+    return ::GetComputerNameA(buf, &size) ? std::string(buf, size) : std::string();
+# elif defined(BOOST_POSIX_API)
+    char buf[256];
+    if (::gethostname(buf, sizeof(buf)) != 0)
+      return std::string();
+    buf[sizeof(buf) - 1] = '\0';
+    return buf;
+# else
+    return std::string();
+# endif
+  }
+
+  //  Values are written to the end of the line, so line breaks become spaces.
+  std::string one_line(const std::string& s)
+  {
+    std::string line(s);
+    std::replace(line.begin(), line.end(), '\n', ' ');
+    std::replace(line.begin(), line.end(), '\r', ' ');
+    return line;
+  }
+
+  //  The rest of the line after a space, or empty.
+  std::string rest_of(std::istringstream& is)
+  {
+    std::string rest;
+    if (is.get() == ' ')
+      std::getline(is, rest);
+    return rest;
+  }
+
+  //  The complementary error function, with a fractional error below 1.2e-7, from
+  //  Press et al., Numerical Recipes, 2nd ed., 6.2.
+  double complementary_erf(double x)
+  {
+    const double z = std::fabs(x);
+    const double t = 1.0 / (1.0 + 0.5 * z);
+    const double r = t * std::exp(-z * z - 1.26551223 + t * (1.00002368
+      + t * (0.37409196 + t * (0.09678418 + t * (-0.18628806 + t * (0.27886807
+      + t * (-1.13520398 + t * (1.48851587 + t * (-0.82215223 + t * 0.17087277)))))))));
+    return x >= 0.0 ? r : 2.0 - r;
+  }
+
+  //  The two-sided p-value of u, from the exact distribution of U for samples of n1
+  //  and n2 values without ties: counts[i][u] is the number of orderings of i values
+  //  of the first and j of the second with U = u, built up for j = 0, 1, ..., n2.
+  double exact_p(std::size_t n1, std::size_t n2, double u)
+  {
+    const std::size_t max_u = n1 * n2;
+    std::vector<std::vector<double> > counts(n1 + 1, std::vector<double>(max_u + 1));
+    for (std::size_t i = 0; i <= n1; ++i)
+      counts[i][0] = 1.0;  // j = 0
+    for (std::size_t j = 1; j <= n2; ++j)
+      for (std::size_t i = 1; i <= n1; ++i)  // the largest value is the first's,
+        for (std::size_t v = max_u; v >= j; --v)  // greater than all j of the second
+          counts[i][v] += counts[i - 1][v - j];
+
+    const std::vector<double>& dist = counts[n1];
+    double total = 0.0, below = 0.0, above = 0.0;
+    for (std::size_t v = 0; v <= max_u; ++v)
+    {
+      total += dist[v];
+      if (v <= u)
+        below += dist[v];
+      if (v >= u)
+        above += dist[v];
+    }
+    return std::min(1.0, 2.0 * std::min(below, above) / total);
+  }
+
+  //  Per-iteration times of a case's samples.
+  std::vector<double> per_iteration(const baseline_case& c, bool cpu)
+  {
+    std::vector<double> values(c.samples.size());
+    const double iterations = c.iterations ? static_cast<double>(c.iterations) : 1.0;
+    for (std::size_t i = 0; i < c.samples.size(); ++i)
+    {
+      const cpu_times& t = c.samples[i];
+      values[i] = cpu ? static_cast<double>(t.user + t.system) / iterations
+        : std::max(0.0, static_cast<double>(t.wall) - c.overhead) / iterations;
+    }
+    return values;
+  }
+
+  double median_of(std::vector<double>& values)
+  {
+    const std::size_t n = values.size();
+    std::sort(values.begin(), values.end());
+    return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2.0;
+  }
+
+  double ratio_of(double candidate, double base)
+  {
+    if (base > 0.0)
+      return candidate / base;
+    return candidate > 0.0 ? std::numeric_limits<double>::infinity() : 1.0;
+  }
+
+  //  xorshift64*, seeded from a string by FNV-1a, for repeatable resampling
+  class generator
+  {
+  public:
+    explicit generator(const std::string& seed) : m_state(14695981039346656037ULL)
+    {
+      for (std::string::const_iterator it = seed.begin(); it != seed.end(); ++it)
+        m_state = (m_state ^ static_cast<unsigned char>(*it)) * 1099511628211ULL;
+      if (m_state == 0)
+        m_state = 1;
+    }
+
+    std::size_t below(std::size_t n)
+    {
+      m_state ^= m_state >> 12;
+      m_state ^= m_state << 25;
+      m_state ^= m_state >> 27;
+      return static_cast<std::size_t>((m_state * 2685821657736338717ULL >> 11) % n);
+    }
+
+  private:
+    boost::uint64_t m_state;
+  };
+
+  void resample(const std::vector<double>& from, std::vector<double>& to,
+    generator& g)
+  {
+    to.resize(from.size());
+    for (std::size_t i = 0; i < from.size(); ++i)
+      to[i] = from[g.below(from.size())];
+  }
+}  // unnamed namespace
+
+namespace boost
+{
+  namespace timer
+  {
+    //  baseline  ----------------------------------------------------------------------//
+
+    BOOST_TIMER_DECL baseline_metadata current_metadata(const std::string& label)
+    {
+      baseline_metadata m;
+      m.host = host_name();
+      m.label = label;
+      m.created = static_cast<boost::int_least64_t>(std::time(0));
+      m.wall_clock = wall_clock_name(wall_clock());
+      m.wall_clock_steady = wall_clock() == tsc_wall_clock
+        || boost::chrono::high_resolution_clock::is_steady;
+      m.tsc_invariant = tsc_is_invariant();
+      m.tsc_frequency = m.tsc_invariant ? tsc_frequency() : 0.0;
+      m.cpu_clock = cpu_clock_name(cpu_clock());
+      m.cpu_clock_resolution = cpu_clock_resolution(cpu_clock());
+      m.timer_overhead = timer_overhead<process_times_policy>().overhead;
+      return m;
+    }
+
+    BOOST_TIMER_DECL baseline make_baseline(const std::vector<benchmark_result>& results,
+      const std::string& label)
+    {
+      baseline b;
+      b.metadata = current_metadata(label);
+      b.cases.resize(results.size());
+      for (std::size_t i = 0; i < results.size(); ++i)
+      {
+        b.cases[i].name = results[i].name;
+        b.cases[i].iterations = results[i].iterations;
+        b.cases[i].overhead = results[i].overhead;
+        b.cases[i].samples = results[i].samples;
+      }
+      return b;
+    }
+
+    BOOST_TIMER_DECL void write_baseline(std::ostream& os, const baseline& b)
+    {
+      std::ostringstream ss;
+      ss.imbue(std::locale::classic());
+      ss.precision(17);
+      const baseline_metadata& m = b.metadata;
+      ss << magic << ' ' << version << '\n'
+         << "meta host " << one_line(m.host) << '\n'
+         << "meta label " << one_line(m.label) << '\n'
+         << "meta created " << m.created << '\n'
+         << "meta wall_clock " << one_line(m.wall_clock) << '\n'
+         << "meta wall_clock_steady " << m.wall_clock_steady << '\n'
+         << "meta tsc_invariant " << m.tsc_invariant << '\n'
+         << "meta tsc_frequency " << m.tsc_frequency << '\n'
+         << "meta cpu_clock " << one_line(m.cpu_clock) << '\n'
+         << "meta cpu_clock_resolution " << m.cpu_clock_resolution << '\n'
+         << "meta timer_overhead " << m.timer_overhead.wall << ' '
+         << m.timer_overhead.user << ' ' << m.timer_overhead.system << '\n';
+      for (std::size_t i = 0; i < b.cases.size(); ++i)
+      {
+        const baseline_case& c = b.cases[i];
+        ss << "case " << c.iterations << ' ' << c.overhead << ' ' << one_line(c.name)
+           << '\n';
+        for (std::size_t j = 0; j < c.samples.size(); ++j)
+          ss << "sample " << c.samples[j].wall << ' ' << c.samples[j].user << ' '
+             << c.samples[j].system << '\n';
+      }
+      os << ss.str();
+    }
+
+    BOOST_TIMER_DECL bool read_baseline(std::istream& in, baseline& b)
+    {
+      b = baseline();
+      b.metadata.created = 0;
+      b.metadata.wall_clock_steady = false;
+      b.metadata.tsc_invariant = false;
+      b.metadata.tsc_frequency = 0.0;
+      b.metadata.cpu_clock_resolution = -1;
+      b.metadata.timer_overhead.clear();
+
+      std::string line;
+      if (!std::getline(in, line))
+        return false;
+      std::istringstream header(line);
+      header.imbue(std::locale::classic());
+      std::string word;
+      int file_version = 0;
+      if (!(header >> word >> file_version) || word != magic || file_version != version)
+        return false;
+
+      baseline_metadata& m = b.metadata;
+      while (std::getline(in, line))
+      {
+        std::istringstream is(line);
+        is.imbue(std::locale::classic());
+        std::string type;
+        if (!(is >> type))
+          continue;  // blank
+        if (type == "meta")
+        {
+          std::string key;
+          if (!(is >> key))
+            return false;
+          bool ok = true;
+          if (key == "host")
+            m.host = rest_of(is);
+          else if (key == "label")
+            m.label = rest_of(is);
+          else if (key == "wall_clock")
+            m.wall_clock = rest_of(is);
+          else if (key == "cpu_clock")
+            m.cpu_clock = rest_of(is);
+          else if (key == "created")
+            ok = !!(is >> m.created);
+          else if (key == "wall_clock_steady")
+            ok = !!(is >> m.wall_clock_steady);
+          else if (key == "tsc_invariant")
+            ok = !!(is >> m.tsc_invariant);
+          else if (key == "tsc_frequency")
+            ok = !!(is >> m.tsc_frequency);
+          else if (key == "cpu_clock_resolution")
+            ok = !!(is >> m.cpu_clock_resolution);
+          else if (key == "timer_overhead")
+            ok = !!(is >> m.timer_overhead.wall >> m.timer_overhead.user
+              >> m.timer_overhead.system);
+          if (!ok)
+            return false;
+        }
+        else if (type == "case")
+        {
+          baseline_case c;
+          if (!(is >> c.iterations >> c.overhead))
+            return false;
+          c.name = rest_of(is);
+          b.cases.push_back(c);
+        }
+        else if (type == "sample")
+        {
+          cpu_times t;
+          if (b.cases.empty() || !(is >> t.wall >> t.user >> t.system))
+            return false;
+          b.cases.back().samples.push_back(t);
+        }
+      }
+      return !in.bad();
+    }
+
+    //  comparison  --------------------------------------------------------------------//
+
+    BOOST_TIMER_DECL double mann_whitney_p(const std::vector<double>& a,
+      const std::vector<double>& b)
+    {
+      const std::size_t n1 = a.size(), n2 = b.size(), n = n1 + n2;
+      if (n1 == 0 || n2 == 0)
+        return 1.0;
+
+      //  rank the values together, giving tied values their mean rank
+      std::vector<std::pair<double, bool> > all(n);  // value, is of a
+      for (std::size_t i = 0; i < n1; ++i)
+        all[i] = std::make_pair(a[i], true);
+      for (std::size_t i = 0; i < n2; ++i)
+        all[n1 + i] = std::make_pair(b[i], false);
+      std::sort(all.begin(), all.end());
+      double rank_sum = 0.0;  // of a
+      double ties = 0.0;      // sum of t^3 - t over groups of t tied values
+      for (std::size_t i = 0; i < n;)
+      {
+        std::size_t j = i + 1;
+        while (j < n && all[j].first == all[i].first)
+          ++j;
+        const double t = static_cast<double>(j - i);
+        const double rank = (i + 1 + j) / 2.0;
+        for (std::size_t k = i; k < j; ++k)
+          if (all[k].second)
+            rank_sum += rank;
+        ties += t * t * t - t;
+        i = j;
+      }
+      const double u = rank_sum - n1 * (n1 + 1) / 2.0;
+
+      if (ties == 0.0 && n1 <= max_exact && n2 <= max_exact)
+        return exact_p(n1, n2, u);
+
+      const double mean = n1 * n2 / 2.0;
+      const double variance = n1 * n2 / 12.0 * ((n + 1) - ties / (n * (n - 1.0)));
+      if (variance <= 0.0)
+        return 1.0;  // all values tied
+      const double z = std::max(0.0, std::fabs(u - mean) - 0.5) / std::sqrt(variance);
+      return std::min(1.0, complementary_erf(z / std::sqrt(2.0)));
+    }
+
+    BOOST_TIMER_DECL std::vector<case_comparison> compare(const baseline& base,
+      const baseline& candidate, const compare_options& options)
+    {
+      std::vector<case_comparison> results;
+      for (std::size_t i = 0; i < candidate.cases.size(); ++i)
+      {
+        const baseline_case& c = candidate.cases[i];
+        const baseline_case* b = 0;
+        for (std::size_t j = 0; j < base.cases.size() && !b; ++j)
+          if (base.cases[j].name == c.name)
+            b = &base.cases[j];
+        if (!b || b->samples.empty() || c.samples.empty())
+          continue;
+
+        const std::vector<double> x = per_iteration(*b, options.cpu);
+        const std::vector<double> y = per_iteration(c, options.cpu);
+        case_comparison r;
+        r.name = c.name;
+        std::vector<double> sorted(x);
+        r.baseline_median = median_of(sorted);
+        sorted = y;
+        r.candidate_median = median_of(sorted);
+        r.ratio = ratio_of(r.candidate_median, r.baseline_median);
+        r.p_value = mann_whitney_p(x, y);
+
+        generator g(c.name);
+        std::vector<double> ratios(options.resamples ? options.resamples : 1);
+        std::vector<double> xs, ys;
+        for (std::size_t k = 0; k < ratios.size(); ++k)
+        {
+          resample(x, xs, g);
+          resample(y, ys, g);
+          const double mx = median_of(xs);
+          ratios[k] = ratio_of(median_of(ys), mx);
+        }
+        std::sort(ratios.begin(), ratios.end());
+        const double tail = (1.0 - options.confidence) / 2.0 * (ratios.size() - 1);
+        r.ratio_low = ratios[static_cast<std::size_t>(tail)];
+        r.ratio_high = ratios[ratios.size() - 1 - static_cast<std::size_t>(tail)];
+
+        r.verdict = unchanged;
+        if (r.p_value < options.alpha)
+        {
+          if (r.ratio > 1.0 + options.threshold)
+            r.verdict = regressed;
+          else if (r.ratio < 1.0 - options.threshold)
+            r.verdict = improved;
+        }
+        results.push_back(r);
+      }
+      return results;
+    }
+
+  } // namespace timer
+} // namespace boost
@@ -0,0 +1,263 @@
+//  boost benchmark.cpp  ---------------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/benchmark.hpp>
+#include <boost/timer/detail/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <locale>
+#include <ostream>
+#include <sstream>
+
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::cpu_timer;
+using boost::timer::sample_statistics;
+using boost::timer::benchmark_result;
+
+namespace
+{
+  //  values must be sorted
+  double median(const std::vector<double>& values, std::size_t first, std::size_t last)
+  {
+    std::size_t n = last - first;
+    if (n == 0)
+      return 0.0;
+    return n % 2 ? values[first + n / 2]
+                 : (values[first + n / 2 - 1] + values[first + n / 2]) / 2.0;
+  }
+
+  //  Numbers are written in the classic locale, with a fixed number of decimals,
+  //  regardless of the destination stream's settings.
+  void init_stream(std::ostringstream& ss)
+  {
+    ss.imbue(std::locale::classic());
+    ss.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    ss.precision(3);
+  }
+
+  void put_csv_string(std::ostream& os, const std::string& s)
+  {
+    if (s.find_first_of(",\"\r\n") == std::string::npos)
+    {
+      os << s;
+      return;
+    }
+    os << '"';
+    for (std::string::const_iterator it = s.begin(); it != s.end(); ++it)
+    {
+      if (*it == '"')
+        os << '"';
+      os << *it;
+    }
+    os << '"';
+  }
+
+  void put_json_statistics(std::ostream& os, const sample_statistics& s)
+  {
+    os << "{\"mean\": " << s.mean << ", \"median\": " << s.median
+       << ", \"stddev\": " << s.stddev << ", \"min\": " << s.min
+       << ", \"max\": " << s.max << "}";
+  }
+}  // unnamed namespace
+
+namespace boost
+{
+  namespace timer
+  {
+    //  summarize  ---------------------------------------------------------------------//
+
+    BOOST_TIMER_DECL
+    sample_statistics summarize(std::vector<double>& values, double outlier_threshold)
+    {
+      sample_statistics s = { 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+      std::sort(values.begin(), values.end());
+
+      std::size_t first = 0;
+      std::size_t last = values.size();
+      if (outlier_threshold > 0.0 && values.size() >= 3)
+      {
+        const double m = median(values, 0, values.size());
+        std::vector<double> deviations(values.size());
+        for (std::size_t i = 0; i < values.size(); ++i)
+          deviations[i] = std::fabs(values[i] - m);
+        std::sort(deviations.begin(), deviations.end());
+        const double limit
+          = outlier_threshold * 1.4826 * median(deviations, 0, deviations.size());
+        if (limit > 0.0)  // a MAD of 0 says nothing about the spread
+        {
+          while (m - values[first] > limit)
+            ++first;
+          while (values[last - 1] - m > limit)
+            --last;
+        }
+      }
+      s.rejected = values.size() - (last - first);
+      values.erase(values.begin() + last, values.end());
+      values.erase(values.begin(), values.begin() + first);
+
+      s.count = values.size();
+      if (values.empty())
+        return s;
+      double sum = 0.0;
+      for (std::size_t i = 0; i < values.size(); ++i)
+        sum += values[i];
+      s.mean = sum / values.size();
+      double squares = 0.0;
+      for (std::size_t i = 0; i < values.size(); ++i)
+        squares += (values[i] - s.mean) * (values[i] - s.mean);
+      s.stddev = values.size() > 1 ? std::sqrt(squares / (values.size() - 1)) : 0.0;
+      s.median = median(values, 0, values.size());
+      s.min = values.front();
+      s.max = values.back();
+      return s;
+    }
+
+    //  benchmark  ---------------------------------------------------------------------//
+
+    benchmark_options::benchmark_options()
+      : warmup_time(50000000LL), sample_time(10000000LL), samples(10),
+        outlier_threshold(3.5), subtract_overhead(true) {}
+
+    benchmark_result benchmark::measure(const std::string& name,
+      const boost::function<void()>& f, const benchmark_options& options)
+    {
+      benchmark_result result;
+      result.name = name;
+      result.overhead = options.subtract_overhead
+        ? static_cast<double>(timer_overhead<cpu_timer::policy_type>().overhead.wall)
+        : 0.0;
+
+      //  warmup, in doubling batches so that reading the timer costs little
+      cpu_timer warmup;
+      for (boost::uint64_t batch = 1; warmup.elapsed().wall < options.warmup_time;
+        batch = std::min<boost::uint64_t>(batch * 2, 1u << 20))
+      {
+        for (boost::uint64_t i = 0; i < batch; ++i)
+          f();
+      }
+
+      //  scale the iterations until a sample takes sample_time
+      boost::uint64_t iterations = 1;
+      for (;;)
+      {
+        cpu_timer t;
+        for (boost::uint64_t i = 0; i < iterations; ++i)
+          f();
+        nanosecond_type wall = t.elapsed().wall;
+        if (wall >= options.sample_time || iterations >= (boost::uint64_t(1) << 40))
+          break;
+        double multiplier = wall > 0
+          ? 1.2 * static_cast<double>(options.sample_time) / static_cast<double>(wall)
+          : 10.0;
+        multiplier = std::max(2.0, std::min(10.0, multiplier));
+        iterations = static_cast<boost::uint64_t>(iterations * multiplier);
+      }
+      result.iterations = iterations;
+
+      std::vector<double> wall(options.samples);
+      std::vector<double> cpu(options.samples);
+      result.total.clear();
+      result.samples.resize(options.samples);
+      for (unsigned s = 0; s < options.samples; ++s)
+      {
+        cpu_timer t;
+        for (boost::uint64_t i = 0; i < iterations; ++i)
+          f();
+        cpu_times times = t.elapsed();
+        result.samples[s] = times;
+        result.total.wall += times.wall;
+        result.total.user += times.user;
+        result.total.system += times.system;
+        wall[s] = std::max(0.0, static_cast<double>(times.wall) - result.overhead)
+          / static_cast<double>(iterations);
+        cpu[s] = static_cast<double>(times.user + times.system)
+          / static_cast<double>(iterations);
+      }
+      result.wall = summarize(wall, options.outlier_threshold);
+      result.cpu = summarize(cpu);  // too coarse for outliers to mean much
+      return result;
+    }
+
+    void benchmark::run()
+    {
+      for (std::size_t i = m_results.size(); i < m_cases.size(); ++i)
+        m_results.push_back(measure(m_cases[i].first, m_cases[i].second, m_options));
+    }
+
+    void benchmark::report(std::ostream& os, short places, const std::string& fmt) const
+    {
+      for (std::size_t i = 0; i < m_results.size(); ++i)
+      {
+        const benchmark_result& r = m_results[i];
+        std::ostringstream ss;
+        init_stream(ss);
+        ss << r.name << ": " << r.wall.median << "ns median, " << r.wall.mean
+           << "ns mean, " << r.wall.stddev << "ns stddev, " << r.wall.min
+           << "ns min per iteration (" << r.iterations << " iterations x "
+           << r.wall.count << " samples, " << r.wall.rejected << " rejected)"
+           << format(r.total, places, fmt) << '\n';
+        os << ss.str();
+      }
+    }
+
+    void benchmark::write_json(std::ostream& os) const
+    {
+      std::ostringstream ss;
+      init_stream(ss);
+      ss << "{\n  \"benchmarks\": [";
+      for (std::size_t i = 0; i < m_results.size(); ++i)
+      {
+        const benchmark_result& r = m_results[i];
+        ss << (i ? ",\n" : "\n") << "    {\"name\": ";
+        detail::put_json_string(ss, r.name);
+        ss << ", \"iterations\": " << r.iterations
+           << ", \"samples\": " << r.wall.count
+           << ", \"rejected\": " << r.wall.rejected
+           << ", \"overhead_ns\": " << r.overhead
+           << ",\n     \"wall_ns\": ";
+        put_json_statistics(ss, r.wall);
+        ss << ",\n     \"cpu_ns\": ";
+        put_json_statistics(ss, r.cpu);
+        ss << ",\n     \"total_ns\": {\"wall\": " << r.total.wall
+           << ", \"user\": " << r.total.user << ", \"system\": " << r.total.system
+           << "}}";
+      }
+      ss << "\n  ]\n}\n";
+      os << ss.str();
+    }
+
+    void benchmark::write_csv(std::ostream& os) const
+    {
+      std::ostringstream ss;
+      init_stream(ss);
+      ss << "name,iterations,samples,rejected,overhead_ns,"
+            "wall_mean_ns,wall_median_ns,wall_stddev_ns,wall_min_ns,wall_max_ns,"
+            "cpu_mean_ns,cpu_median_ns,total_wall_ns,total_user_ns,total_system_ns\n";
+      for (std::size_t i = 0; i < m_results.size(); ++i)
+      {
+        const benchmark_result& r = m_results[i];
+        put_csv_string(ss, r.name);
+        ss << ',' << r.iterations << ',' << r.wall.count << ',' << r.wall.rejected
+           << ',' << r.overhead << ',' << r.wall.mean << ',' << r.wall.median
+           << ',' << r.wall.stddev << ',' << r.wall.min << ',' << r.wall.max
+           << ',' << r.cpu.mean << ',' << r.cpu.median << ',' << r.total.wall
+           << ',' << r.total.user << ',' << r.total.system << '\n';
+      }
+      os << ss.str();
+    }
+
+  } // namespace timer
+} // namespace boost
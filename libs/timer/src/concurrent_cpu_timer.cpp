@@ -0,0 +1,263 @@
+//  boost concurrent_cpu_timer.cpp  ----------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/config.hpp>
+#include <boost/timer/concurrent_cpu_timer.hpp>
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+
+namespace
+{
+  const std::size_t unassigned = static_cast<std::size_t>(-1);
+
+  //  Threads are numbered from 1 in turn, and start looking for a shard to claim at
+  //  their number's, so that the threads of one operation, usually started together,
+  //  find free shards at once.
+  std::atomic<boost::uint_least64_t> next_thread_id(1);
+  thread_local boost::uint_least64_t this_thread_id = 0;
+
+  boost::uint_least64_t thread_id()
+  {
+    if (this_thread_id == 0)
+      this_thread_id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+    return this_thread_id;
+  }
+
+  std::atomic<boost::uint_least64_t> next_generation(1);
+
+  //  The shard the thread used for the timer generation it last added to
+  struct shard_cache
+  {
+    boost::uint_least64_t  generation;
+    std::size_t            index;
+  };
+
+  thread_local shard_cache this_thread_shard = { 0, unassigned };
+
+  void set_if_less(std::atomic<nanosecond_type>& a, nanosecond_type v)
+  {
+    nanosecond_type current = a.load(std::memory_order_relaxed);
+    while (v < current
+      && !a.compare_exchange_weak(current, v, std::memory_order_relaxed)) {}
+  }
+
+  void set_if_greater(std::atomic<nanosecond_type>& a, nanosecond_type v)
+  {
+    nanosecond_type current = a.load(std::memory_order_relaxed);
+    while (v > current
+      && !a.compare_exchange_weak(current, v, std::memory_order_relaxed)) {}
+  }
+
+} // unnamed namespace
+
+#endif  // !BOOST_TIMER_NO_CXX11_CONCURRENCY
+
+namespace boost
+{
+  namespace timer
+  {
+    BOOST_TIMER_DECL
+    const std::string& default_concurrent_format()
+    {
+      static std::string fmt(" %ws critical path, %ts thread CPU (%p%),"
+        " %n segments on %N threads, %E% efficiency\n");
+      return fmt;
+    }
+
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+
+    //  segment  -----------------------------------------------------------------------//
+
+    concurrent_cpu_timer::segment::segment(concurrent_cpu_timer& timer)
+      : m_timer(&timer)
+    {
+      thread_times_policy::get(m_start);
+    }
+
+    void concurrent_cpu_timer::segment::close()
+    {
+      if (!m_timer)
+        return;
+      cpu_times finish;
+      thread_times_policy::get(finish);
+      if (!m_timer->is_stopped())
+        m_timer->add(m_start, finish);
+      m_timer = 0;
+    }
+
+    //  concurrent_cpu_timer  ----------------------------------------------------------//
+
+    void concurrent_cpu_timer::start()
+    {
+      for (std::size_t i = 0; i < shard_count; ++i)
+      {
+        detail::concurrent_shard& s = m_shards[i];
+        s.owner.store(0, std::memory_order_relaxed);
+        s.segments.store(0, std::memory_order_relaxed);
+        s.busy.store(0, std::memory_order_relaxed);
+        s.user.store(0, std::memory_order_relaxed);
+        s.system.store(0, std::memory_order_relaxed);
+        s.first_open.store(std::numeric_limits<nanosecond_type>::max(),
+          std::memory_order_relaxed);
+        s.last_close.store(std::numeric_limits<nanosecond_type>::min(),
+          std::memory_order_relaxed);
+      }
+      {
+        std::lock_guard<std::mutex> lock(m_overflow_mutex);
+        m_overflow_threads.clear();
+      }
+      m_generation = next_generation.fetch_add(1, std::memory_order_relaxed);
+      m_times.clear();
+      m_stats.clear();
+      m_is_stopped.store(false, std::memory_order_release);
+    }
+
+    void concurrent_cpu_timer::stop()
+    {
+      if (is_stopped())
+        return;
+      m_is_stopped.store(true, std::memory_order_relaxed);
+      collect(m_times, m_stats);
+    }
+
+    //  The shard the thread owns, claiming one if need be. Once all are owned by
+    //  others, the thread shares the one at its number, and is counted apart.
+    std::size_t concurrent_cpu_timer::shard_index()
+    {
+      if (this_thread_shard.generation == m_generation)
+        return this_thread_shard.index;
+
+      const boost::uint_least64_t id = thread_id();
+      const std::size_t first = static_cast<std::size_t>(id % shard_count);
+      std::size_t index = unassigned;
+      for (std::size_t i = 0; i < shard_count && index == unassigned; ++i)
+      {
+        //  owners never change until start(), so a thread's own shard comes before
+        //  any free one
+        const std::size_t j = (first + i) % shard_count;
+        boost::uint_least64_t owner = m_shards[j].owner.load(std::memory_order_relaxed);
+        if (owner == id || (owner == 0 && m_shards[j].owner.compare_exchange_strong(
+              owner, id, std::memory_order_relaxed)))
+          index = j;
+      }
+      if (index == unassigned)
+      {
+        index = first;
+        std::lock_guard<std::mutex> lock(m_overflow_mutex);
+        if (std::find(m_overflow_threads.begin(), m_overflow_threads.end(), id)
+          == m_overflow_threads.end())
+          m_overflow_threads.push_back(id);
+      }
+      this_thread_shard.generation = m_generation;
+      this_thread_shard.index = index;
+      return index;
+    }
+
+    void concurrent_cpu_timer::add(const cpu_times& start, const cpu_times& finish)
+    {
+      detail::concurrent_shard& s = m_shards[shard_index()];
+      s.busy.fetch_add(finish.wall - start.wall, std::memory_order_relaxed);
+      s.user.fetch_add(finish.user - start.user, std::memory_order_relaxed);
+      s.system.fetch_add(finish.system - start.system, std::memory_order_relaxed);
+      set_if_less(s.first_open, start.wall);
+      set_if_greater(s.last_close, finish.wall);
+      s.segments.fetch_add(1, std::memory_order_release);  // publishes the above
+    }
+
+    void concurrent_cpu_timer::collect(cpu_times& times, concurrency_stats& stats) const
+    {
+      times.clear();
+      stats.clear();
+      nanosecond_type first = std::numeric_limits<nanosecond_type>::max();
+      nanosecond_type last = std::numeric_limits<nanosecond_type>::min();
+      {
+        std::lock_guard<std::mutex> lock(m_overflow_mutex);
+        stats.threads = static_cast<boost::int_least64_t>(m_overflow_threads.size());
+      }
+      for (std::size_t i = 0; i < shard_count; ++i)
+      {
+        const detail::concurrent_shard& s = m_shards[i];
+        const boost::int_least64_t segments = s.segments.load(std::memory_order_acquire);
+        if (segments == 0)
+          continue;
+        ++stats.threads;  // its owner; sharers are counted apart
+        stats.segments += segments;
+        stats.busy += s.busy.load(std::memory_order_relaxed);
+        times.user += s.user.load(std::memory_order_relaxed);
+        times.system += s.system.load(std::memory_order_relaxed);
+        const nanosecond_type open = s.first_open.load(std::memory_order_relaxed);
+        const nanosecond_type close = s.last_close.load(std::memory_order_relaxed);
+        if (open < first)
+          first = open;
+        if (close > last)
+          last = close;
+      }
+      if (stats.segments != 0 && last > first)
+        times.wall = last - first;
+    }
+
+    cpu_times concurrent_cpu_timer::elapsed() const
+    {
+      if (is_stopped())
+        return m_times;
+      cpu_times times;
+      concurrency_stats stats;
+      collect(times, stats);
+      return times;
+    }
+
+    concurrency_stats concurrent_cpu_timer::elapsed_stats() const
+    {
+      if (is_stopped())
+        return m_stats;
+      cpu_times times;
+      concurrency_stats stats;
+      collect(times, stats);
+      return stats;
+    }
+
+    double concurrent_cpu_timer::parallel_efficiency() const
+    {
+      cpu_times times(m_times);
+      concurrency_stats stats(m_stats);
+      if (!is_stopped())
+        collect(times, stats);
+      if (times.wall <= 0 || stats.threads == 0)
+        return 0.0;
+      return static_cast<double>(times.user + times.system)
+        / (static_cast<double>(times.wall) * stats.threads);
+    }
+
+    std::string concurrent_cpu_timer::format(short places, const std::string& fmt) const
+    {
+      cpu_times times(m_times);
+      concurrency_stats stats(m_stats);
+      if (!is_stopped())
+        collect(times, stats);
+      format_extras extras;
+      extras.concurrency = &stats;
+      return timer::format(times, extras, places, fmt);
+    }
+
+#endif  // !BOOST_TIMER_NO_CXX11_CONCURRENCY
+
+  } // namespace timer
+} // namespace boost
@@ -0,0 +1,467 @@
+//  boost cpu_sampler.cpp  -------------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/config.hpp>
+
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+
+#include <boost/timer/cpu_sampler.hpp>
+#include <boost/throw_exception.hpp>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+
+# if defined(__linux__)
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/syscall.h>
+# endif
+
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::cpu_sample;
+using boost::timer::sampled_thread;
+
+namespace
+{
+  typedef std::atomic<nanosecond_type> cell;
+
+  //  Each row of the ring is a sample: its start, wall, user, and system, then the
+  //  user and system of each thread slot.
+  const std::size_t process_cells = 4;
+
+# if defined(__linux__)
+  //  the layout getdents64() fills its buffer with
+  struct linux_dirent64
+  {
+    boost::uint64_t  d_ino;
+    boost::int64_t   d_off;
+    unsigned short   d_reclen;
+    unsigned char    d_type;
+    char             d_name[1];
+  };
+
+  //  Reads "<tid>/stat" below the task directory: sets name to the command, and user
+  //  and system to the thread's CPU time in clock ticks.
+  bool read_thread_stat(int task_fd, const char* tid, char (&name)[16],
+    long long& user, long long& system)
+  {
+    char path[32];
+    std::size_t length = std::strlen(tid);
+    if (length + 6 > sizeof(path))
+      return false;
+    std::memcpy(path, tid, length);
+    std::memcpy(path + length, "/stat", 6);
+    int fd = ::openat(task_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      return false;  // exited since the directory was read
+    char buf[512];
+    ssize_t n = ::read(fd, buf, sizeof(buf) - 1);
+    ::close(fd);
+    if (n <= 0)
+      return false;
+    buf[n] = '\0';
+
+    //  "<tid> (<comm>) <state> <ppid> ...", where comm may itself contain parentheses
+    char* open = std::strchr(buf, '(');
+    char* close = std::strrchr(buf, ')');
+    if (!open || !close || close < open)
+      return false;
+    std::size_t name_length = close - open - 1;
+    if (name_length > sizeof(name) - 1)
+      name_length = sizeof(name) - 1;
+    std::memcpy(name, open + 1, name_length);
+    name[name_length] = '\0';
+
+    //  utime and stime are the 12th and 13th fields after comm
+    char* p = close + 1;
+    for (int field = 0; field < 11; ++field)
+    {
+      while (*p == ' ')
+        ++p;
+      while (*p && *p != ' ')
+        ++p;
+    }
+    char* end;
+    user = std::strtoll(p, &end, 10);
+    if (end == p)
+      return false;
+    system = std::strtoll(end, &p, 10);
+    return p != end;
+  }
+# endif
+
+  void put_percent(std::ostream& os, nanosecond_type cpu, nanosecond_type wall)
+  {
+    if (wall > 0)
+      os << 100.0 * cpu / wall;
+  }
+
+} // unnamed namespace
+
+namespace boost
+{
+  namespace timer
+  {
+    struct cpu_sampler::impl
+    {
+      impl(unsigned interval_ms_, std::size_t capacity_, std::size_t max_threads_)
+        : interval_ms(interval_ms_), capacity(capacity_), max_threads(max_threads_),
+          row_size(process_cells + 2 * max_threads_),
+          rows(new cell[capacity_ * (process_cells + 2 * max_threads_)]()),
+          threads(new sampled_thread[max_threads_ ? max_threads_ : 1]),
+          previous(new long long[2 * max_threads_ + 1]),
+          retired(new bool[max_threads_ + 1]()),
+          dirbuf(new char[dirbuf_size]), task_fd(-1), tick_ns(0),
+          begun(0), taken(0), thread_count(0), untracked(0),
+          stopping(false), stopped(false)
+      {
+# if defined(__linux__)
+        if (max_threads)
+        {
+          task_fd = ::open("/proc/self/task", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+          long ticks = ::sysconf(_SC_CLK_TCK);
+          if (ticks > 0)
+            tick_ns = 1000000000LL / ticks;
+          else if (task_fd >= 0)
+          {
+            ::close(task_fd);
+            task_fd = -1;
+          }
+        }
+# endif
+        sample_threads(0);  // the baseline for threads already running
+        thread = std::thread(&impl::run, this);
+      }
+
+      ~impl()
+      {
+# if defined(__linux__)
+        if (task_fd >= 0)
+          ::close(task_fd);
+# endif
+        delete [] dirbuf;
+        delete [] retired;
+        delete [] previous;
+        delete [] threads;
+        delete [] rows;
+      }
+
+      static const std::size_t  dirbuf_size = 8192;
+
+      const unsigned            interval_ms;
+      const std::size_t         capacity;
+      const std::size_t         max_threads;
+      const std::size_t         row_size;
+      cell*                     rows;
+      sampled_thread*           threads;        // published by thread_count
+      long long*                previous;       // sampling thread only: ticks by slot
+      bool*                     retired;        // sampling thread only: by slot, the
+                                                //   thread exited and its id was reused
+      char*                     dirbuf;         // sampling thread only
+      int                       task_fd;        // -1 if threads are not sampled
+      nanosecond_type           tick_ns;
+
+      //  Readers copy rows between loads of taken and begun, like a sequence lock:
+      //  a row copied is intact unless its sample was begun over by then.
+      std::atomic<boost::uint64_t>  begun;
+      std::atomic<boost::uint64_t>  taken;
+      std::atomic<std::size_t>      thread_count;
+      std::atomic<boost::uint64_t>  untracked;
+
+      std::mutex                mutex;          // the sampling thread and stop() only
+      std::condition_variable   wakeup;
+      bool                      stopping;
+      std::atomic<bool>         stopped;
+      std::thread               thread;
+
+      void run();
+      void sample_threads(cell* row);
+      void copy(std::vector<cpu_sample>& samples, std::vector<cpu_times>* thread_times,
+        std::size_t thread_columns) const;
+    };
+
+    void cpu_sampler::impl::run()
+    {
+      typedef std::chrono::steady_clock clock;
+      const clock::duration interval = std::chrono::milliseconds(interval_ms);
+      cpu_times last;
+      process_times_policy::get(last);
+      clock::time_point next = clock::now() + interval;
+
+      std::unique_lock<std::mutex> lock(mutex);
+      for (;;)
+      {
+        if (wakeup.wait_until(lock, next, [this] { return stopping; }))
+          return;
+
+        cpu_times now;
+        process_times_policy::get(now);
+        const boost::uint64_t sequence = taken.load(std::memory_order_relaxed);
+        begun.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        cell* row = rows + (sequence % capacity) * row_size;
+        row[0].store(last.wall, std::memory_order_relaxed);
+        row[1].store(now.wall - last.wall, std::memory_order_relaxed);
+        row[2].store(now.user - last.user, std::memory_order_relaxed);
+        row[3].store(now.system - last.system, std::memory_order_relaxed);
+        sample_threads(row);
+        taken.store(sequence + 1, std::memory_order_release);
+
+        last = now;
+        next += interval;
+        const clock::time_point current = clock::now();
+        if (next < current)  // overran; skip the intervals missed
+          next = current + interval;
+      }
+    }
+
+    //  Records each thread's CPU time since the last sample in row, or only notes the
+    //  times if row is null. Threads are given slots in the order they are first seen.
+    //  A slot is never rewritten once published, since snapshots copy it concurrently,
+    //  so a thread whose id is reused by a new one is retired, and the new thread is
+    //  given a slot of its own.
+    void cpu_sampler::impl::sample_threads(cell* row)
+    {
+      if (row)
+        for (std::size_t j = 0; j < 2 * max_threads; ++j)
+          row[process_cells + j].store(0, std::memory_order_relaxed);
+# if defined(__linux__)
+      if (task_fd < 0)
+        return;
+      ::lseek(task_fd, 0, SEEK_SET);
+      std::size_t count = thread_count.load(std::memory_order_relaxed);
+      boost::uint64_t beyond = 0;
+      long n;
+      while ((n = ::syscall(SYS_getdents64, task_fd, dirbuf, dirbuf_size)) > 0)
+      {
+        for (long offset = 0; offset < n; )
+        {
+          const linux_dirent64* d
+            = reinterpret_cast<const linux_dirent64*>(dirbuf + offset);
+          offset += d->d_reclen;
+          if (d->d_name[0] < '0' || d->d_name[0] > '9')
+            continue;  // . and ..
+
+          const long id = std::atol(d->d_name);
+          std::size_t slot = 0;
+          while (slot < count && (retired[slot] || threads[slot].id != id))
+            ++slot;
+          if (slot == max_threads)
+          {
+            ++beyond;
+            continue;
+          }
+
+          char name[16];
+          long long user, system;
+          if (!read_thread_stat(task_fd, d->d_name, name, user, system))
+            continue;
+          if (slot < count
+            && (user < previous[2 * slot] || system < previous[2 * slot + 1]))
+          {
+            retired[slot] = true;  // its id was reused
+            slot = count;
+            if (slot == max_threads)
+            {
+              ++beyond;
+              continue;
+            }
+          }
+          if (slot == count)  // first seen, so all its time is in this interval
+          {
+            threads[slot].id = id;
+            std::memcpy(threads[slot].name, name, sizeof(name));
+            previous[2 * slot] = row ? 0 : user;
+            previous[2 * slot + 1] = row ? 0 : system;
+            thread_count.store(++count, std::memory_order_release);
+          }
+          if (row)
+          {
+            row[process_cells + 2 * slot].store(
+              (user - previous[2 * slot]) * tick_ns, std::memory_order_relaxed);
+            row[process_cells + 2 * slot + 1].store(
+              (system - previous[2 * slot + 1]) * tick_ns, std::memory_order_relaxed);
+          }
+          previous[2 * slot] = user;
+          previous[2 * slot + 1] = system;
+        }
+      }
+      untracked.store(beyond, std::memory_order_relaxed);
+# else
+      (void)row;
+# endif
+    }
+
+    void cpu_sampler::impl::copy(std::vector<cpu_sample>& samples,
+      std::vector<cpu_times>* thread_times, std::size_t thread_columns) const
+    {
+      const boost::uint64_t end = taken.load(std::memory_order_acquire);
+      const boost::uint64_t first = end > capacity ? end - capacity : 0;
+      samples.resize(static_cast<std::size_t>(end - first));
+      if (thread_times)
+        thread_times->resize(samples.size() * thread_columns);
+
+      for (boost::uint64_t s = first; s != end; ++s)
+      {
+        const cell* row = rows + (s % capacity) * row_size;
+        const std::size_t i = static_cast<std::size_t>(s - first);
+        cpu_sample& sample = samples[i];
+        sample.sequence = s;
+        sample.start = row[0].load(std::memory_order_relaxed);
+        sample.times.wall = row[1].load(std::memory_order_relaxed);
+        sample.times.user = row[2].load(std::memory_order_relaxed);
+        sample.times.system = row[3].load(std::memory_order_relaxed);
+        for (std::size_t j = 0; j < thread_columns; ++j)
+        {
+          cpu_times& t = (*thread_times)[i * thread_columns + j];
+          t.wall = sample.times.wall;
+          t.user = row[process_cells + 2 * j].load(std::memory_order_relaxed);
+          t.system = row[process_cells + 2 * j + 1].load(std::memory_order_relaxed);
+        }
+      }
+
+      //  drop the rows that the sampling thread began to overwrite while copying
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const boost::uint64_t overwritten = begun.load(std::memory_order_relaxed);
+      if (overwritten > first + capacity)
+      {
+        const std::size_t lost = static_cast<std::size_t>(
+          overwritten - capacity - first);
+        const std::size_t drop = lost < samples.size() ? lost : samples.size();
+        samples.erase(samples.begin(), samples.begin() + drop);
+        if (thread_times)
+          thread_times->erase(thread_times->begin(),
+            thread_times->begin() + drop * thread_columns);
+      }
+    }
+
+    //  cpu_sampler  -------------------------------------------------------------------//
+
+    cpu_sampler::cpu_sampler(unsigned interval_ms, std::size_t capacity,
+                             std::size_t max_threads)
+    {
+      if (interval_ms == 0 || capacity == 0)
+        BOOST_THROW_EXCEPTION(std::invalid_argument(
+          "boost::timer::cpu_sampler: interval and capacity must not be 0"));
+      m_impl = new impl(interval_ms, capacity, max_threads);
+    }
+
+    cpu_sampler::~cpu_sampler()
+    {
+      stop();
+      delete m_impl;
+    }
+
+    void cpu_sampler::stop()
+    {
+      if (m_impl->stopped.load(std::memory_order_relaxed))
+        return;
+      {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        m_impl->stopping = true;
+      }
+      m_impl->wakeup.notify_one();
+      m_impl->thread.join();
+      m_impl->stopped.store(true, std::memory_order_relaxed);
+    }
+
+    bool cpu_sampler::is_stopped() const
+    {
+      return m_impl->stopped.load(std::memory_order_relaxed);
+    }
+
+    unsigned cpu_sampler::interval_ms() const      { return m_impl->interval_ms; }
+    std::size_t cpu_sampler::capacity() const      { return m_impl->capacity; }
+    std::size_t cpu_sampler::max_threads() const   { return m_impl->max_threads; }
+    bool cpu_sampler::has_threads() const          { return m_impl->task_fd >= 0; }
+
+    boost::uint64_t cpu_sampler::samples_taken() const
+    {
+      return m_impl->taken.load(std::memory_order_relaxed);
+    }
+
+    boost::uint64_t cpu_sampler::untracked_threads() const
+    {
+      return m_impl->untracked.load(std::memory_order_relaxed);
+    }
+
+    void cpu_sampler::snapshot(std::vector<cpu_sample>& samples) const
+    {
+      m_impl->copy(samples, 0, 0);
+    }
+
+    void cpu_sampler::snapshot(std::vector<cpu_sample>& samples,
+                               std::vector<sampled_thread>& threads,
+                               std::vector<cpu_times>& thread_times) const
+    {
+      //  threads first, so that every thread seen by a sample copied has a column
+      const std::size_t count
+        = m_impl->thread_count.load(std::memory_order_acquire);
+      threads.assign(m_impl->threads, m_impl->threads + count);
+      m_impl->copy(samples, &thread_times, count);
+    }
+
+    void cpu_sampler::write_csv(std::ostream& os) const
+    {
+      std::vector<cpu_sample> samples;
+      std::vector<sampled_thread> threads;
+      std::vector<cpu_times> thread_times;
+      snapshot(samples, threads, thread_times);
+
+      os << "sequence,start_ns,wall_ns,user_ns,system_ns,cpu_percent";
+      for (std::size_t j = 0; j < threads.size(); ++j)
+      {
+        os << ",thread_" << threads[j].id << '_';
+        for (const char* p = threads[j].name; *p; ++p)
+          os << (std::isalnum(static_cast<unsigned char>(*p)) ? *p : '_');
+        os << "_percent";
+      }
+      os << '\n';
+
+      const std::ios_base::fmtflags flags = os.flags();
+      const std::streamsize precision = os.precision();
+      os << std::fixed << std::setprecision(1);
+      for (std::size_t i = 0; i < samples.size(); ++i)
+      {
+        const cpu_sample& s = samples[i];
+        os << s.sequence << ',' << s.start << ',' << s.times.wall << ','
+           << s.times.user << ',' << s.times.system << ',';
+        put_percent(os, s.times.user + s.times.system, s.times.wall);
+        for (std::size_t j = 0; j < threads.size(); ++j)
+        {
+          const cpu_times& t = thread_times[i * threads.size() + j];
+          os << ',';
+          put_percent(os, t.user + t.system, t.wall);
+        }
+        os << '\n';
+      }
+      os.flags(flags);
+      os.precision(precision);
+    }
+
+  } // namespace timer
+} // namespace boost
+
+#endif  // !BOOST_TIMER_NO_CXX11_CONCURRENCY
@@ -14,18 +14,28 @@
 #define BOOST_TIMER_SOURCE
 
 #include <boost/timer/timer.hpp>
+#include <boost/timer/detail/tsc.hpp>
 #include <boost/chrono/chrono.hpp>
 #include <boost/io/ios_state.hpp>
 #include <boost/throw_exception.hpp>
 #include <boost/cerrno.hpp>
 #include <cstring>
 #include <cassert>
+#include <algorithm>
+#include <vector>
+
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+# include <atomic>
+#endif
 
 # if defined(BOOST_WINDOWS_API)
 #   include <windows.h>
 # elif defined(BOOST_POSIX_API)
 #   include <unistd.h>
 #   include <sys/times.h>
+#   include <sys/time.h>
+#   include <sys/resource.h>
+#   include <time.h>
 # else
 # error unknown API
 # endif
@@ -56,12 +66,263 @@ namespace
   }
 # endif
 
-  void get_cpu_times(boost::timer::cpu_times& current)
+# if defined(BOOST_POSIX_API)
+  boost::timer::nanosecond_type timeval_to_ns(const timeval& tv)
+  {
+    return boost::timer::nanosecond_type(tv.tv_sec) * 1000000000LL
+      + boost::timer::nanosecond_type(tv.tv_usec) * 1000LL;
+  }
+
+  //  times() includes the times of terminated children that have been waited for,
+  //  but has only clock tick resolution.
+  void get_times_cpu_times(boost::timer::cpu_times& current)
+  {
+    tms tm;
+    clock_t c = ::times(&tm);
+    if (c == -1) // error
+    {
+      current.system = current.user = boost::timer::nanosecond_type(-1);
+    }
+    else
+    {
+      current.system = boost::timer::nanosecond_type(tm.tms_stime + tm.tms_cstime);
+      current.user = boost::timer::nanosecond_type(tm.tms_utime + tm.tms_cutime);
+      boost::int_least64_t factor;
+      if ((factor = tick_factor()) != -1)
+      {
+        current.user *= factor;
+        current.system *= factor;
+      }
+      else
+      {
+        current.user = current.system = boost::timer::nanosecond_type(-1);
+      }
+    }
+  }
+
+  void get_rusage_cpu_times(boost::timer::cpu_times& current)
+  {
+    rusage ru;
+    if (::getrusage(RUSAGE_SELF, &ru) == -1) // error
+    {
+      current.system = current.user = boost::timer::nanosecond_type(-1);
+    }
+    else
+    {
+      current.user = timeval_to_ns(ru.ru_utime);
+      current.system = timeval_to_ns(ru.ru_stime);
+    }
+  }
+
+#   if defined(CLOCK_PROCESS_CPUTIME_ID) || defined(CLOCK_THREAD_CPUTIME_ID)
+  //  Splitting a clock total by getrusage() gives user time the remainder, which
+  //  includes the time between the two calls and the rounding of getrusage() to
+  //  microseconds. That varies from reading to reading, so the remainder alone could
+  //  move user time backwards. The system time is that of getrusage(), which never
+  //  goes backwards, and the user time is held at the highest value reported before;
+  //  their sum may then exceed the total by a microsecond or two.
+#     if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+  std::atomic<boost::timer::nanosecond_type> process_user_high(0);
+  thread_local boost::timer::nanosecond_type thread_user_high = 0;
+
+  boost::timer::nanosecond_type hold_high(
+    std::atomic<boost::timer::nanosecond_type>& high, boost::timer::nanosecond_type v)
+  {
+    boost::timer::nanosecond_type current = high.load(std::memory_order_relaxed);
+    while (v > current
+      && !high.compare_exchange_weak(current, v, std::memory_order_relaxed)) {}
+    return v > current ? v : current;
+  }
+#     else
+  //  Without atomics the process-wide high is a plain variable, so concurrent
+  //  readings may still see user time go backwards by the jitter described above.
+  boost::timer::nanosecond_type process_user_high = 0;
+  boost::timer::nanosecond_type thread_user_high = 0;
+#     endif
+
+  boost::timer::nanosecond_type hold_high(boost::timer::nanosecond_type& high,
+    boost::timer::nanosecond_type v)
+  {
+    if (v > high)
+      high = v;
+    return high;
+  }
+
+  //  Sets the user and system members of current from total and getrusage()'s
+  //  system time, as described above.
+  template <class High>
+  void split_cputime(boost::timer::cpu_times& current,
+    boost::timer::nanosecond_type total, const timeval& stime, High& user_high)
+  {
+    current.system = timeval_to_ns(stime);
+    if (current.system > total)
+      current.system = total;
+    current.user = hold_high(user_high, total - current.system);
+  }
+#   endif
+
+#   if defined(CLOCK_PROCESS_CPUTIME_ID)
+  //  CLOCK_PROCESS_CPUTIME_ID yields only the total, so the split between user and
+  //  system time comes from getrusage(). The total is read last so that it is never
+  //  behind the system time, but the split is only as good as the microsecond
+  //  resolution of getrusage().
+  void get_cputime_cpu_times(boost::timer::cpu_times& current)
+  {
+    timespec ts;
+    rusage ru;
+    if (::getrusage(RUSAGE_SELF, &ru) == -1
+      || ::clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) == -1) // error
+    {
+      current.system = current.user = boost::timer::nanosecond_type(-1);
+    }
+    else
+    {
+      split_cputime(current,
+        boost::timer::nanosecond_type(ts.tv_sec) * 1000000000LL + ts.tv_nsec,
+        ru.ru_stime, process_user_high);
+    }
+  }
+#   endif
+# endif
+
+  bool cpu_clock_available(boost::timer::cpu_clock_type type)
+  {
+    switch (type)
+    {
+# if defined(BOOST_WINDOWS_API)
+    case boost::timer::process_times_clock:
+      return true;
+# else
+    case boost::timer::times_clock:
+      return tick_factor() != -1;
+    case boost::timer::rusage_clock:
+      return true;
+#   if defined(CLOCK_PROCESS_CPUTIME_ID)
+    case boost::timer::cputime_clock:
+      {
+        timespec res;
+        return ::clock_getres(CLOCK_PROCESS_CPUTIME_ID, &res) == 0;
+      }
+#   endif
+# endif
+    default:
+      return false;
+    }
+  }
+
+  //  The active source is a plain variable, read on every get_process_cpu() call; it is
+  //  only expected to change before timers are in use.
+# if defined(BOOST_WINDOWS_API)
+  boost::timer::cpu_clock_type active_cpu_clock = boost::timer::process_times_clock;
+# else
+  boost::timer::cpu_clock_type active_cpu_clock = boost::timer::rusage_clock;
+# endif
+
+  //  wall-clock sources  --------------------------------------------------------------//
+
+  boost::timer::nanosecond_type high_resolution_now()
   {
     boost::chrono::duration<boost::int64_t, boost::nano>
       x (boost::chrono::high_resolution_clock::now().time_since_epoch());
-    current.wall = x.count();
+    return x.count();
+  }
+
+# if defined(BOOST_TIMER_HAS_TSC)
+  //  The time stamp counter is converted to nanoseconds relative to a base point taken
+  //  during calibration, so tsc_wall_clock values are comparable with each other but
+  //  not with high_resolution_clock values.
+  struct tsc_calibration
+  {
+    bool              invariant;
+    boost::uint64_t   base_ticks;
+    boost::timer::nanosecond_type base_ns;
+    double            ticks_per_second;
+#   if defined(BOOST_HAS_INT128)
+    boost::uint64_t   ns_per_tick;  // fixed point, 32 fractional bits
+#   else
+    long double       ns_per_tick;
+#   endif
+  };
 
+  //  Calibration against the steady clock; busy waits for about 10ms.
+  tsc_calibration calibrate_tsc()
+  {
+    tsc_calibration c = { false, 0, 0, 0.0, 0 };
+    if (!boost::timer::detail::cpuid_invariant_tsc())
+      return c;
+
+    typedef boost::chrono::steady_clock clock;
+    const clock::time_point start_time = clock::now();
+    const boost::uint64_t start_ticks = boost::timer::detail::read_tsc();
+    clock::time_point end_time;
+    do { end_time = clock::now(); }
+      while (end_time - start_time < boost::chrono::milliseconds(10));
+    const boost::uint64_t end_ticks = boost::timer::detail::read_tsc();
+
+    const boost::int64_t ns = boost::chrono::duration_cast<
+      boost::chrono::nanoseconds>(end_time - start_time).count();
+    if (ns <= 0 || end_ticks <= start_ticks)
+      return c;
+
+    c.ticks_per_second = (end_ticks - start_ticks) * 1.0e9 / ns;
+#   if defined(BOOST_HAS_INT128)
+    c.ns_per_tick = static_cast<boost::uint64_t>(
+      (static_cast<boost::uint128_type>(ns) << 32) / (end_ticks - start_ticks));
+#   else
+    c.ns_per_tick = static_cast<long double>(ns) / (end_ticks - start_ticks);
+#   endif
+    c.base_ticks = end_ticks;
+    c.base_ns = boost::chrono::duration_cast<boost::chrono::nanoseconds>(
+      end_time.time_since_epoch()).count();
+    c.invariant = true;
+    return c;
+  }
+
+  //  Calibrates once, on first use. The initialization of a function-local static is
+  //  thread-safe, so concurrent first callers wait for the one calibration and all
+  //  see it complete.
+  const tsc_calibration& tsc()
+  {
+    static const tsc_calibration calibration = calibrate_tsc();
+    return calibration;
+  }
+
+  inline boost::timer::nanosecond_type tsc_now()
+  {
+    const tsc_calibration& c = tsc();
+    boost::uint64_t ticks = boost::timer::detail::read_tsc() - c.base_ticks;
+#   if defined(BOOST_HAS_INT128)
+    return c.base_ns + static_cast<boost::timer::nanosecond_type>(
+      (static_cast<boost::uint128_type>(ticks) * c.ns_per_tick) >> 32);
+#   else
+    return c.base_ns + static_cast<boost::timer::nanosecond_type>(ticks * c.ns_per_tick);
+#   endif
+  }
+# endif
+
+  //  Like active_cpu_clock below, only expected to change before timers are in use.
+  boost::timer::wall_clock_type active_wall_clock = boost::timer::high_resolution_wall_clock;
+
+# if defined(BOOST_TIMER_HAS_TSC) && defined(BOOST_TIMER_USE_TSC)
+  //  Calibrates during static initialization, falling back silently to the default
+  //  wall clock if the TSC is not invariant.
+  struct tsc_initializer
+  {
+    tsc_initializer() { boost::timer::set_wall_clock(boost::timer::tsc_wall_clock); }
+  } tsc_init;
+# endif
+
+  inline boost::timer::nanosecond_type get_wall_time()
+  {
+# if defined(BOOST_TIMER_HAS_TSC)
+    if (active_wall_clock == boost::timer::tsc_wall_clock)
+      return tsc_now();
+# endif
+    return high_resolution_now();
+  }
+
+  void get_process_cpu(boost::timer::cpu_times& current)
+  {
 # if defined(BOOST_WINDOWS_API)
 
     FILETIME creation, exit;
@@ -76,27 +337,74 @@ namespace
       current.system = current.user = boost::timer::nanosecond_type(-1);
     }
 # else
-    tms tm;
-    clock_t c = ::times(&tm);
-    if (c == -1) // error
+    switch (active_cpu_clock)
+    {
+#   if defined(CLOCK_PROCESS_CPUTIME_ID)
+    case boost::timer::cputime_clock:
+      get_cputime_cpu_times(current);
+      break;
+#   endif
+    case boost::timer::times_clock:
+      get_times_cpu_times(current);
+      break;
+    default:
+      get_rusage_cpu_times(current);
+      break;
+    }
+# endif
+  }
+
+  //  Per-thread user and system times. On POSIX, getrusage(RUSAGE_THREAD) provides the
+  //  split; CLOCK_THREAD_CPUTIME_ID is used for the total when cputime_clock is active,
+  //  or alone where RUSAGE_THREAD is missing, in which case all time is charged to user.
+  void get_thread_cpu(boost::timer::cpu_times& current)
+  {
+# if defined(BOOST_WINDOWS_API)
+
+    FILETIME creation, exit;
+    if (::GetThreadTimes(::GetCurrentThread(), &creation, &exit,
+            (LPFILETIME)&current.system, (LPFILETIME)&current.user))
+    {
+      current.user   *= 100;  // Windows uses 100 nanosecond ticks
+      current.system *= 100;
+    }
+    else
+    {
+      current.system = current.user = boost::timer::nanosecond_type(-1);
+    }
+# elif defined(RUSAGE_THREAD)
+    rusage ru;
+    if (::getrusage(RUSAGE_THREAD, &ru) == -1) // error
+    {
+      current.system = current.user = boost::timer::nanosecond_type(-1);
+      return;
+    }
+    current.user = timeval_to_ns(ru.ru_utime);
+    current.system = timeval_to_ns(ru.ru_stime);
+#   if defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    if (active_cpu_clock == boost::timer::cputime_clock
+      && ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+    {
+      split_cputime(current,
+        boost::timer::nanosecond_type(ts.tv_sec) * 1000000000LL + ts.tv_nsec,
+        ru.ru_stime, thread_user_high);
+    }
+#   endif
+# elif defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    if (::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == -1) // error
     {
       current.system = current.user = boost::timer::nanosecond_type(-1);
     }
     else
     {
-      current.system = boost::timer::nanosecond_type(tm.tms_stime + tm.tms_cstime);
-      current.user = boost::timer::nanosecond_type(tm.tms_utime + tm.tms_cutime);
-      boost::int_least64_t factor;
-      if ((factor = tick_factor()) != -1)
-      {
-        current.user *= factor;
-        current.system *= factor;
-      }
-      else
-      {
-        current.user = current.system = boost::timer::nanosecond_type(-1);
-      }
+      current.user
+        = boost::timer::nanosecond_type(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+      current.system = 0;
     }
+# else
+    current.system = current.user = boost::timer::nanosecond_type(-1);
 # endif
   }
 
@@ -114,50 +422,186 @@ namespace boost
       return fmt;
     }
 
-    //  cpu_timer  ---------------------------------------------------------------------//
+    //  wall-clock sources  ------------------------------------------------------------//
 
-    void cpu_timer::start()
+    BOOST_TIMER_DECL
+    wall_clock_type wall_clock()
     {
-      m_is_stopped = false;
-      get_cpu_times(m_times);
+      return active_wall_clock;
     }
 
-    const cpu_times& cpu_timer::stop()
+    BOOST_TIMER_DECL
+    bool set_wall_clock(wall_clock_type type)
     {
-      if (is_stopped())
-        return m_times;
-      m_is_stopped = true;
-      
-      cpu_times current;
-      get_cpu_times(current);
-      m_times.wall = (current.wall - m_times.wall);
-      m_times.user = (current.user - m_times.user);
-      m_times.system = (current.system - m_times.system);
-      return m_times;
+      if (type == high_resolution_wall_clock)
+      {
+        active_wall_clock = type;
+        return true;
+      }
+      if (type == tsc_wall_clock && tsc_is_invariant())
+      {
+        active_wall_clock = type;
+        return true;
+      }
+      return false;
     }
 
-    cpu_times cpu_timer::elapsed() const
+    BOOST_TIMER_DECL
+    const char* wall_clock_name(wall_clock_type type)
     {
-      if (is_stopped())
-        return m_times;
-      cpu_times current;
-      get_cpu_times(current);
-      current.wall -= m_times.wall;
-      current.user -= m_times.user;
-      current.system -= m_times.system;
-      return current;
+      switch (type)
+      {
+      case high_resolution_wall_clock: return "boost::chrono::high_resolution_clock";
+      case tsc_wall_clock:             return "invariant time stamp counter";
+      }
+      return "unknown";
     }
 
-    void cpu_timer::resume()
+    BOOST_TIMER_DECL
+    bool tsc_is_invariant()
     {
-      if (is_stopped())
+# if defined(BOOST_TIMER_HAS_TSC)
+      return tsc().invariant;
+# else
+      return false;
+# endif
+    }
+
+    BOOST_TIMER_DECL
+    double tsc_frequency()
+    {
+# if defined(BOOST_TIMER_HAS_TSC)
+      return tsc().ticks_per_second;
+# else
+      return 0.0;
+# endif
+    }
+
+    //  CPU time sources  --------------------------------------------------------------//
+
+    BOOST_TIMER_DECL
+    cpu_clock_type cpu_clock()
+    {
+      return active_cpu_clock;
+    }
+
+    BOOST_TIMER_DECL
+    bool set_cpu_clock(cpu_clock_type type)
+    {
+      if (!cpu_clock_available(type))
+        return false;
+      active_cpu_clock = type;
+      return true;
+    }
+
+    BOOST_TIMER_DECL
+    const char* cpu_clock_name(cpu_clock_type type)
+    {
+      switch (type)
+      {
+      case times_clock:         return "times()";
+      case rusage_clock:        return "getrusage(RUSAGE_SELF)";
+      case cputime_clock:       return "clock_gettime(CLOCK_PROCESS_CPUTIME_ID)";
+      case process_times_clock: return "GetProcessTimes()";
+      }
+      return "unknown";
+    }
+
+    BOOST_TIMER_DECL
+    nanosecond_type cpu_clock_resolution(cpu_clock_type type)
+    {
+      if (!cpu_clock_available(type))
+        return -1;
+# if defined(BOOST_WINDOWS_API)
+      return 100;  // nominal; the scheduler actually charges in clock ticks
+# else
+      switch (type)
+      {
+      case times_clock:
+        return tick_factor();
+#   if defined(CLOCK_PROCESS_CPUTIME_ID)
+      case cputime_clock:
+        {
+          timespec res;
+          ::clock_getres(CLOCK_PROCESS_CPUTIME_ID, &res);
+          return nanosecond_type(res.tv_sec) * 1000000000LL + res.tv_nsec;
+        }
+#   endif
+      default:
+        return 1000;  // rusage_clock reports microseconds
+      }
+# endif
+    }
+
+    //  current time values  -----------------------------------------------------------//
+
+    BOOST_TIMER_DECL
+    nanosecond_type current_wall_time()
+    {
+      return get_wall_time();
+    }
+
+    BOOST_TIMER_DECL
+    void current_process_cpu(cpu_times& current)
+    {
+      get_process_cpu(current);
+    }
+
+    BOOST_TIMER_DECL
+    void current_thread_cpu(cpu_times& current)
+    {
+      get_thread_cpu(current);
+    }
+
+    //  timer overhead  ----------------------------------------------------------------//
+
+    BOOST_TIMER_DECL
+    overhead_calibration calibrate_overhead(void (*get)(cpu_times&), unsigned trials)
+    {
+      overhead_calibration result;
+      result.trials = trials ? trials : 1;
+      std::vector<nanosecond_type> samples[3];
+      for (int f = 0; f < 3; ++f)
+        samples[f].resize(result.trials);
+
+      cpu_times start, stop;
+      for (int i = 0; i < 16; ++i)  // warm up caches and lazily bound symbols
+        get(start);
+      for (unsigned i = 0; i < result.trials; ++i)
+      {
+        get(start);
+        get(stop);
+        samples[0][i] = stop.wall - start.wall;
+        samples[1][i] = stop.user - start.user;
+        samples[2][i] = stop.system - start.system;
+      }
+
+      nanosecond_type* overhead[3]
+        = { &result.overhead.wall, &result.overhead.user, &result.overhead.system };
+      nanosecond_type* deviation[3]
+        = { &result.deviation.wall, &result.deviation.user, &result.deviation.system };
+      //  The interquartile mean ignores outliers as the median does, but unlike the
+      //  median is not biased by CPU times advancing a whole tick or not at all.
+      const std::size_t n = result.trials;
+      const std::size_t mid = n / 2;
+      for (int f = 0; f < 3; ++f)
       {
-        cpu_times current (m_times);
-        start();
-        m_times.wall   -= current.wall;
-        m_times.user   -= current.user;
-        m_times.system -= current.system;
+        std::vector<nanosecond_type>& v = samples[f];
+        std::sort(v.begin(), v.end());
+        const std::size_t first = n / 4;
+        const std::size_t last = n - n / 4;
+        nanosecond_type sum = 0;
+        for (std::size_t i = first; i < last; ++i)
+          sum += v[i];
+        *overhead[f] = (sum + (last - first) / 2) / static_cast<nanosecond_type>(last - first);
+        const nanosecond_type median = v[mid];
+        for (std::size_t i = 0; i < n; ++i)
+          v[i] = v[i] < median ? median - v[i] : v[i] - median;
+        std::nth_element(v.begin(), v.begin() + mid, v.end());
+        *deviation[f] = v[mid];
       }
+      return result;
     }
+
   } // namespace timer
 } // namespace boost
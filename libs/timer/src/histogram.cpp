@@ -0,0 +1,323 @@
+//  boost histogram.cpp  ---------------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/histogram.hpp>
+#include <cstring>
+
+# if defined(BOOST_MSVC)
+#   include <intrin.h>
+# endif
+
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::histogram;
+
+namespace
+{
+  const unsigned        sub_bits = histogram::sub_bucket_bits;
+  const std::size_t     sub_count = std::size_t(1) << sub_bits;
+  const std::size_t     half_count = sub_count / 2;
+
+  //  serialized form: magic, then varints
+  const char            magic[] = { 'B', 'T', 'H', '1' };
+
+  inline unsigned highest_bit(boost::uint64_t v)  // v != 0
+  {
+# if defined(__GNUC__)
+    return 63u - static_cast<unsigned>(__builtin_clzll(v));
+# elif defined(BOOST_MSVC) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return index;
+# else
+    unsigned bit = 0;
+    while (v >>= 1)
+      ++bit;
+    return bit;
+# endif
+  }
+
+  void put_varint(std::string& out, boost::uint64_t v)
+  {
+    while (v >= 0x80)
+    {
+      out += static_cast<char>((v & 0x7f) | 0x80);
+      v >>= 7;
+    }
+    out += static_cast<char>(v);
+  }
+
+  bool get_varint(const std::string& in, std::size_t& pos, boost::uint64_t& v)
+  {
+    v = 0;
+    for (unsigned shift = 0; shift < 64 && pos < in.size(); shift += 7)
+    {
+      unsigned char c = static_cast<unsigned char>(in[pos++]);
+      v |= boost::uint64_t(c & 0x7f) << shift;
+      if (!(c & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  cpu_times make_times(nanosecond_type wall, nanosecond_type user, nanosecond_type system)
+  {
+    cpu_times t;
+    t.wall = wall;
+    t.user = user;
+    t.system = system;
+    return t;
+  }
+
+} // unnamed namespace
+
+namespace boost
+{
+  namespace timer
+  {
+
+    //  histogram  ---------------------------------------------------------------------//
+
+    std::size_t histogram::bucket_index(nanosecond_type ns)
+    {
+      if (ns < nanosecond_type(sub_count))
+        return ns > 0 ? static_cast<std::size_t>(ns) : 0;
+      const unsigned msb = highest_bit(static_cast<boost::uint64_t>(ns));
+      if (msb >= magnitude_bits)
+        return bucket_count - 1;
+      const unsigned shift = msb - (sub_bits - 1);
+      return sub_count + (msb - sub_bits) * half_count
+        + static_cast<std::size_t>((ns >> shift) - half_count);
+    }
+
+    nanosecond_type histogram::bucket_lowest(std::size_t index)
+    {
+      if (index < sub_count)
+        return nanosecond_type(index);
+      const std::size_t magnitude = (index - sub_count) / half_count;
+      const std::size_t sub = (index - sub_count) % half_count + half_count;
+      return nanosecond_type(sub) << (magnitude + 1);
+    }
+
+    nanosecond_type histogram::bucket_highest(std::size_t index)
+    {
+      if (index < sub_count)
+        return nanosecond_type(index);
+      const std::size_t magnitude = (index - sub_count) / half_count;
+      return bucket_lowest(index) + (nanosecond_type(1) << (magnitude + 1)) - 1;
+    }
+
+    void histogram::clear()
+    {
+      std::memset(m_counts, 0, sizeof(m_counts));
+      m_count = m_sum = 0;
+      m_min = m_max = 0;
+    }
+
+    void histogram::record(nanosecond_type ns, boost::uint64_t n)
+    {
+      if (n == 0)
+        return;
+      if (ns < 0)  // an error indication from the clock; record as zero
+        ns = 0;
+      m_counts[bucket_index(ns)] += n;
+      if (m_count == 0 || ns < m_min)
+        m_min = ns;
+      if (ns > m_max)
+        m_max = ns;
+      m_count += n;
+      m_sum += static_cast<boost::uint64_t>(ns) * n;
+    }
+
+    void histogram::merge(const histogram& other)
+    {
+      if (other.m_count == 0)
+        return;
+      for (std::size_t i = 0; i < bucket_count; ++i)
+        m_counts[i] += other.m_counts[i];
+      if (m_count == 0 || other.m_min < m_min)
+        m_min = other.m_min;
+      if (other.m_max > m_max)
+        m_max = other.m_max;
+      m_count += other.m_count;
+      m_sum += other.m_sum;
+    }
+
+    double histogram::mean() const
+    {
+      return m_count ? static_cast<double>(m_sum) / m_count : 0.0;
+    }
+
+    //  Returns the highest value equivalent to the bucket holding the value at or above
+    //  which lie p percent of the recorded values, limited to the exact min and max.
+    nanosecond_type histogram::percentile(double p) const
+    {
+      if (m_count == 0)
+        return 0;
+      if (p < 0.0)
+        p = 0.0;
+      else if (p > 100.0)
+        p = 100.0;
+      boost::uint64_t target = static_cast<boost::uint64_t>(p / 100.0 * m_count + 0.5);
+      if (target == 0)
+        target = 1;
+      boost::uint64_t seen = 0;
+      for (std::size_t i = 0; i < bucket_count; ++i)
+      {
+        seen += m_counts[i];
+        if (seen >= target)
+        {
+          nanosecond_type value = bucket_highest(i);
+          if (value > m_max)
+            value = m_max;
+          if (value < m_min)
+            value = m_min;
+          return value;
+        }
+      }
+      return m_max;
+    }
+
+    //  magic, sub_bucket_bits, count, sum, min, max, then for each non-empty bucket
+    //  the distance from the previous non-empty bucket and the bucket's count.
+    void histogram::serialize(std::string& out) const
+    {
+      out.append(magic, sizeof(magic));
+      put_varint(out, sub_bits);
+      put_varint(out, m_count);
+      put_varint(out, m_sum);
+      put_varint(out, static_cast<boost::uint64_t>(m_min));
+      put_varint(out, static_cast<boost::uint64_t>(m_max));
+      std::size_t previous = 0;
+      for (std::size_t i = 0; i < bucket_count; ++i)
+      {
+        if (m_counts[i] == 0)
+          continue;
+        put_varint(out, i - previous);
+        put_varint(out, m_counts[i]);
+        previous = i;
+      }
+      put_varint(out, 0);  // a count of 0 ends the list
+      put_varint(out, 0);
+    }
+
+    bool histogram::deserialize(const std::string& in, std::size_t& pos)
+    {
+      std::size_t p = pos;
+      if (p > in.size() || in.size() - p < sizeof(magic)
+        || in.compare(p, sizeof(magic), magic, sizeof(magic)))
+        return false;
+      p += sizeof(magic);
+
+      boost::uint64_t bits, count, sum, min, max;
+      if (!get_varint(in, p, bits) || bits != sub_bits
+        || !get_varint(in, p, count) || !get_varint(in, p, sum)
+        || !get_varint(in, p, min) || !get_varint(in, p, max))
+        return false;
+
+      histogram h;
+      boost::uint64_t total = 0;
+      std::size_t index = 0;
+      for (bool first = true;; first = false)
+      {
+        boost::uint64_t distance, n;
+        if (!get_varint(in, p, distance) || !get_varint(in, p, n))
+          return false;
+        if (n == 0)
+          break;
+        if ((distance == 0 && !first) || distance >= bucket_count - index)
+          return false;
+        index += static_cast<std::size_t>(distance);
+        h.m_counts[index] = n;
+        total += n;
+      }
+      if (total != count)
+        return false;
+
+      h.m_count = count;
+      h.m_sum = sum;
+      h.m_min = static_cast<nanosecond_type>(min);
+      h.m_max = static_cast<nanosecond_type>(max);
+      *this = h;
+      pos = p;
+      return true;
+    }
+
+    //  cpu_times_histogram  -----------------------------------------------------------//
+
+    cpu_times cpu_times_histogram::percentile(double p) const
+    {
+      return make_times(wall.percentile(p), user.percentile(p), system.percentile(p));
+    }
+
+    cpu_times cpu_times_histogram::min() const
+    {
+      return make_times(wall.min(), user.min(), system.min());
+    }
+
+    cpu_times cpu_times_histogram::max() const
+    {
+      return make_times(wall.max(), user.max(), system.max());
+    }
+
+    cpu_times cpu_times_histogram::mean() const
+    {
+      return make_times(nanosecond_type(wall.mean() + 0.5),
+        nanosecond_type(user.mean() + 0.5), nanosecond_type(system.mean() + 0.5));
+    }
+
+    void cpu_times_histogram::serialize(std::string& out) const
+    {
+      wall.serialize(out);
+      user.serialize(out);
+      system.serialize(out);
+    }
+
+    bool cpu_times_histogram::deserialize(const std::string& in, std::size_t& pos)
+    {
+      std::size_t p = pos;
+      histogram w, u, s;
+      if (!w.deserialize(in, p) || !u.deserialize(in, p) || !s.deserialize(in, p))
+        return false;
+      wall = w;
+      user = u;
+      system = s;
+      pos = p;
+      return true;
+    }
+
+    void cpu_times_histogram::record(const cpu_times& times)
+    {
+      wall.record(times.wall);
+      user.record(times.user);
+      system.record(times.system);
+    }
+
+    void cpu_times_histogram::merge(const cpu_times_histogram& other)
+    {
+      wall.merge(other.wall);
+      user.merge(other.user);
+      system.merge(other.system);
+    }
+
+    void cpu_times_histogram::clear()
+    {
+      wall.clear();
+      user.clear();
+      system.clear();
+    }
+
+  } // namespace timer
+} // namespace boost
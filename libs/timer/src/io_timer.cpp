@@ -0,0 +1,170 @@
+//  boost io_timer.cpp  ----------------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/io_timer.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+# include <atomic>
+#endif
+
+# if defined(__linux__)
+#   include <fcntl.h>
+#   include <unistd.h>
+# endif
+
+using boost::timer::io_counters;
+
+namespace
+{
+# if defined(__linux__)
+  //  /proc/self is resolved when the file is opened, so the descriptor a child
+  //  inherits across fork() reads its parent's counters. The file is opened once per
+  //  process, on first use, and kept open; pread() needs no lock. The process's id and
+  //  descriptor are kept together, so that a thread sees either both or neither.
+
+  boost::uint64_t io_file_entry(pid_t pid, int fd)
+  {
+    return static_cast<boost::uint64_t>(static_cast<boost::uint32_t>(pid)) << 32
+      | static_cast<boost::uint32_t>(fd);
+  }
+
+  pid_t io_file_pid(boost::uint64_t entry)  { return static_cast<pid_t>(entry >> 32); }
+  int io_file_fd(boost::uint64_t entry)
+    { return static_cast<int>(static_cast<boost::uint32_t>(entry)); }
+
+# if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+  std::atomic<boost::uint64_t> io_file_cache(0);  // pid 0: none opened
+# else
+  boost::uint64_t io_file_cache = 0;
+# endif
+
+  int io_file()
+  {
+    const pid_t pid = ::getpid();
+# if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+    boost::uint64_t entry = io_file_cache.load(std::memory_order_acquire);
+    while (io_file_pid(entry) != pid)
+    {
+      const int fd = ::open("/proc/self/io", O_RDONLY | O_CLOEXEC);
+      if (io_file_cache.compare_exchange_strong(entry, io_file_entry(pid, fd),
+        std::memory_order_acq_rel, std::memory_order_acquire))
+      {
+        if (io_file_pid(entry) != 0 && io_file_fd(entry) >= 0)
+          ::close(io_file_fd(entry));  // the parent's copy
+        return fd;
+      }
+      if (fd >= 0)  // another thread opened it first; entry is now theirs
+        ::close(fd);
+    }
+    return io_file_fd(entry);
+# else
+    if (io_file_pid(io_file_cache) != pid)
+    {
+      if (io_file_pid(io_file_cache) != 0 && io_file_fd(io_file_cache) >= 0)
+        ::close(io_file_fd(io_file_cache));
+      io_file_cache = io_file_entry(pid, ::open("/proc/self/io", O_RDONLY | O_CLOEXEC));
+    }
+    return io_file_fd(io_file_cache);
+# endif
+  }
+
+  struct io_key
+  {
+    const char*                          name;  // including the ':'
+    std::size_t                          size;
+    boost::int_least64_t io_counters::*  member;
+  };
+
+  const io_key io_keys[] =
+  {
+    { "rchar:", 6, &io_counters::read_chars },
+    { "wchar:", 6, &io_counters::write_chars },
+    { "syscr:", 6, &io_counters::read_calls },
+    { "syscw:", 6, &io_counters::write_calls },
+    { "read_bytes:", 11, &io_counters::read_bytes },
+    { "write_bytes:", 12, &io_counters::write_bytes }
+  };
+# endif
+}  // unnamed namespace
+
+namespace boost
+{
+  namespace timer
+  {
+    BOOST_TIMER_DECL
+    bool current_io_counters(io_counters& current)
+    {
+      current.clear();
+# if defined(__linux__)
+      const int fd = io_file();
+      char buf[512];
+      ssize_t n;
+      if (fd < 0 || (n = ::pread(fd, buf, sizeof(buf) - 1, 0)) <= 0)
+        return false;
+      buf[n] = '\0';
+
+      //  "name: value\n" lines, in a fixed order, but look each up in case that changes
+      for (char* line = buf; *line; )
+      {
+        for (std::size_t i = 0; i < sizeof(io_keys) / sizeof(io_keys[0]); ++i)
+          if (std::strncmp(line, io_keys[i].name, io_keys[i].size) == 0)
+          {
+            current.*io_keys[i].member = std::strtoll(line + io_keys[i].size, 0, 10);
+            break;
+          }
+        char* next = std::strchr(line, '\n');
+        if (!next)
+          break;
+        line = next + 1;
+      }
+      return true;
+# else
+      return false;
+# endif
+    }
+
+    BOOST_TIMER_DECL
+    const std::string& default_io_format()
+    {
+      static std::string fmt(" %ws wall, %ts CPU (%p%),"
+        " %R bytes read (%a MB/s), %W written (%A MB/s)\n");
+      return fmt;
+    }
+
+    //  io_timer  ----------------------------------------------------------------------//
+
+    io_counters io_timer::elapsed_io() const
+    {
+      cpu_times times;
+      io_counters io;
+      elapsed(times, io);
+      return io;
+    }
+
+    std::string io_timer::format(short places, const std::string& fmt) const
+    {
+      cpu_times times;
+      io_counters io;
+      elapsed(times, io);
+      format_extras extras;
+      extras.io = has_io() ? &io : 0;
+      return timer::format(times, extras, places, fmt);
+    }
+
+  } // namespace timer
+} // namespace boost
@@ -0,0 +1,413 @@
+//  boost perf_counter_timer.cpp  ------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/perf_counter_timer.hpp>
+#include <boost/timer/detail/tsc.hpp>
+#include <cstring>
+#include <string>
+
+# if defined(__linux__)
+#   include <linux/perf_event.h>
+#   include <sys/mman.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#   if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#     define BOOST_TIMER_HAS_RDPMC
+#   endif
+# endif
+
+using boost::timer::perf_counters;
+using boost::timer::perf_event_count;
+
+namespace boost
+{
+  namespace timer
+  {
+    namespace detail
+    {
+      struct perf_group
+      {
+        int               leader;                   // -1 if nothing could be opened
+        int               fd[perf_event_count];     // by event; -1 if not a member
+        perf_event_type   order[perf_event_count];  // of the members' values in a read
+        unsigned          size;
+      };
+
+      struct perf_group_set
+      {
+        perf_group        hardware;
+        perf_group        software;
+        unsigned          available;
+        void*             page[perf_event_count];   // hardware events' mapped pages
+        bool              rdpmc;                    // all hardware events readable
+                                                    //   from user space
+      };
+    } // namespace detail
+  } // namespace timer
+} // namespace boost
+
+using boost::timer::detail::perf_group;
+using boost::timer::detail::perf_group_set;
+
+namespace
+{
+  const char* const event_names[perf_event_count] =
+  {
+    "cycles", "instructions", "cache-misses", "branch-misses", "task-clock",
+    "page-faults", "context-switches"
+  };
+
+  const int first_software_event = boost::timer::task_clock_event;
+
+# if defined(__linux__)
+  struct event_config
+  {
+    boost::uint32_t   type;
+    boost::uint64_t   config;
+    bool              user_only_meaningful;  // counting only user space still
+                                             //   measures the event
+  };
+
+  const event_config event_configs[perf_event_count] =
+  {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, true },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, true },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, true },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, true },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, true },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, true },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, false }  // kernel only
+  };
+
+  //  Hardware events count user space only, which is all that perf_event_paranoid 2,
+  //  the usual default, permits an unprivileged process on them. Software events are
+  //  counted in the kernel too, where context switches happen; where that is not
+  //  permitted, those that user space alone still measures are counted there, and
+  //  context switches are not available, rather than always 0.
+  int open_event(int event, int group_fd, bool exclude_kernel)
+  {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = event_configs[event].type;
+    attr.config = event_configs[event].config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+      | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = exclude_kernel;
+    attr.exclude_hv = 1;
+    return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group_fd,
+      PERF_FLAG_FD_CLOEXEC));
+  }
+
+  int open_event(int event, int group_fd)
+  {
+    const event_config& c = event_configs[event];
+    if (c.type == PERF_TYPE_HARDWARE)
+      return open_event(event, group_fd, true);
+    int fd = open_event(event, group_fd, false);
+    if (fd < 0 && c.user_only_meaningful)
+      fd = open_event(event, group_fd, true);
+    return fd;
+  }
+# endif
+
+  void open_group(perf_group& group, int first, int last, unsigned& available)
+  {
+    group.leader = -1;
+    group.size = 0;
+    for (int e = 0; e != perf_event_count; ++e)
+      group.fd[e] = -1;
+# if defined(__linux__)
+    for (int e = first; e != last; ++e)
+    {
+      int fd = open_event(e, group.leader);
+      if (fd < 0)  // e.g. no PMU, not permitted, or not supported by this one
+        continue;
+      if (group.leader < 0)
+        group.leader = fd;
+      group.fd[e] = fd;
+      group.order[group.size++] = static_cast<boost::timer::perf_event_type>(e);
+      available |= 1u << e;
+    }
+# else
+    (void)first;
+    (void)last;
+    (void)available;
+# endif
+  }
+
+  perf_group_set* open_groups()
+  {
+    perf_group_set* set = new perf_group_set;
+    set->available = 0;
+    open_group(set->hardware, 0, first_software_event, set->available);
+    open_group(set->software, first_software_event, perf_event_count, set->available);
+
+    set->rdpmc = false;
+    for (int e = 0; e != perf_event_count; ++e)
+      set->page[e] = 0;
+# if defined(BOOST_TIMER_HAS_RDPMC)
+    set->rdpmc = set->hardware.size != 0;
+    const long page_size = ::sysconf(_SC_PAGESIZE);
+    for (unsigned i = 0; i != set->hardware.size; ++i)
+    {
+      const int e = set->hardware.order[i];
+      void* page = ::mmap(0, page_size, PROT_READ, MAP_SHARED, set->hardware.fd[e], 0);
+      if (page == MAP_FAILED)
+        set->rdpmc = false;
+      else
+      {
+        set->page[e] = page;
+        if (!static_cast<perf_event_mmap_page*>(page)->cap_user_rdpmc)
+          set->rdpmc = false;
+      }
+    }
+# endif
+    return set;
+  }
+
+  void close_groups(perf_group_set* set)
+  {
+# if defined(__linux__)
+    for (int e = 0; e != perf_event_count; ++e)
+    {
+      if (set->page[e])
+        ::munmap(set->page[e], ::sysconf(_SC_PAGESIZE));
+      if (set->hardware.fd[e] >= 0)
+        ::close(set->hardware.fd[e]);
+      if (set->software.fd[e] >= 0)
+        ::close(set->software.fd[e]);
+    }
+# endif
+    delete set;
+  }
+
+# if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+  struct groups_owner
+  {
+    perf_group_set* groups;
+
+   ~groups_owner()
+    {
+      if (groups)
+        close_groups(groups);
+    }
+  };
+
+  thread_local groups_owner this_thread_groups = { 0 };
+# endif
+
+  //  The calling thread's groups. Without thread_local, each caller opens its own.
+  perf_group_set* acquire_groups(bool& owned)
+  {
+# if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+    owned = false;
+    if (!this_thread_groups.groups)
+      this_thread_groups.groups = open_groups();
+    return this_thread_groups.groups;
+# else
+    owned = true;
+    return open_groups();
+# endif
+  }
+
+  //  A group's counts, scaled up if the kernel multiplexed it with other groups
+# if defined(__linux__)
+  //  The count a counter multiplexed with others would have reached had it counted
+  //  all the time it was enabled
+  boost::uint64_t scaled(boost::uint64_t value, boost::uint64_t enabled,
+    boost::uint64_t running)
+  {
+    if (running && running < enabled)
+      value = static_cast<boost::uint64_t>(static_cast<double>(value) * enabled / running);
+    return value;
+  }
+# endif
+
+  void read_group(const perf_group& group, perf_counters& counters)
+  {
+# if defined(__linux__)
+    boost::uint64_t buf[3 + perf_event_count];  // nr, time enabled, time running, values
+    ssize_t n = ::read(group.leader, buf, sizeof(buf));
+    if (n < static_cast<ssize_t>((3 + group.size) * sizeof(buf[0])))
+      return;
+    const boost::uint64_t enabled = buf[1];
+    const boost::uint64_t running = buf[2];
+    for (unsigned i = 0; i != group.size; ++i)
+      counters.value[group.order[i]]
+        = static_cast<boost::int_least64_t>(scaled(buf[3 + i], enabled, running));
+# else
+    (void)group;
+    (void)counters;
+# endif
+  }
+
+# if defined(BOOST_TIMER_HAS_RDPMC)
+  inline boost::uint64_t rdpmc(boost::uint32_t counter)
+  {
+    boost::uint32_t low, high;
+    __asm__ __volatile__("rdpmc" : "=a" (low), "=d" (high) : "c" (counter));
+    return low | (static_cast<boost::uint64_t>(high) << 32);
+  }
+
+  //  The kernel's user space read protocol for a mapped counter, scaled as read() scales
+  //  it, so that a region read one way at start() and the other at stop() is
+  //  consistent. The page's enabled and running times are as of when the thread was
+  //  last scheduled in; while they differ, both are brought up to now through the
+  //  page's conversion from the TSC. Returns false if a counter is not currently on
+  //  the PMU, or is multiplexed without that conversion, so read() must be used.
+  bool read_rdpmc(const perf_group_set& set, perf_counters& counters)
+  {
+    for (unsigned i = 0; i != set.hardware.size; ++i)
+    {
+      const int e = set.hardware.order[i];
+      const volatile perf_event_mmap_page* page
+        = static_cast<const volatile perf_event_mmap_page*>(set.page[e]);
+      boost::uint32_t sequence;
+      boost::int64_t count;
+      boost::uint64_t enabled, running;
+      do
+      {
+        sequence = page->lock;
+        __asm__ __volatile__("" ::: "memory");
+        const boost::uint32_t index = page->index;
+        if (!index)
+          return false;
+        enabled = page->time_enabled;
+        running = page->time_running;
+        if (enabled != running)
+        {
+          if (!page->cap_user_time)
+            return false;
+          const boost::uint64_t cycles = boost::timer::detail::read_tsc();
+          const unsigned shift = page->time_shift;
+          const boost::uint64_t mult = page->time_mult;
+          const boost::uint64_t quotient = cycles >> shift;
+          const boost::uint64_t remainder
+            = cycles & ((static_cast<boost::uint64_t>(1) << shift) - 1);
+          const boost::uint64_t delta = page->time_offset + quotient * mult
+            + ((remainder * mult) >> shift);
+          enabled += delta;
+          running += delta;
+        }
+        const unsigned width = page->pmc_width;
+        boost::int64_t pmc = static_cast<boost::int64_t>(rdpmc(index - 1) << (64 - width));
+        count = page->offset + (pmc >> (64 - width));  // sign extended
+        __asm__ __volatile__("" ::: "memory");
+      } while (page->lock != sequence);
+      counters.value[e] = static_cast<boost::int_least64_t>(
+        scaled(static_cast<boost::uint64_t>(count), enabled, running));
+    }
+    return true;
+  }
+# endif
+
+  void read_groups(const perf_group_set& set, perf_counters& counters)
+  {
+    counters.clear();
+    counters.available = set.available;
+    if (set.hardware.size)
+    {
+# if defined(BOOST_TIMER_HAS_RDPMC)
+      if (!set.rdpmc || !read_rdpmc(set, counters))
+# endif
+        read_group(set.hardware, counters);
+    }
+    if (set.software.size)
+      read_group(set.software, counters);
+  }
+}  // unnamed namespace
+
+namespace boost
+{
+  namespace timer
+  {
+    BOOST_TIMER_DECL const char* perf_event_name(perf_event_type event)
+    {
+      return event >= 0 && event < perf_event_count ? event_names[event] : "unknown";
+    }
+
+    BOOST_TIMER_DECL unsigned perf_events_available()
+    {
+      bool owned;
+      perf_group_set* set = acquire_groups(owned);
+      unsigned available = set->available;
+      if (owned)
+        close_groups(set);
+      return available;
+    }
+
+    BOOST_TIMER_DECL bool perf_rdpmc_available()
+    {
+      bool owned;
+      perf_group_set* set = acquire_groups(owned);
+      bool rdpmc = set->rdpmc;
+      if (owned)
+        close_groups(set);
+      return rdpmc;
+    }
+
+    BOOST_TIMER_DECL
+    const std::string& default_perf_format()
+    {
+      static std::string fmt(" %ws wall, %ts CPU, %K cycles, %I instructions (%P IPC),"
+        " %M cache misses (%H per 1000 instructions), %B branch misses\n");
+      return fmt;
+    }
+
+    //  perf_counter_timer  ------------------------------------------------------------//
+
+    namespace detail
+    {
+      perf_source::perf_source() : m_groups(acquire_groups(m_owns_groups)) {}
+
+      perf_source::~perf_source()
+      {
+        if (m_owns_groups)
+          close_groups(m_groups);
+      }
+
+      unsigned perf_source::available() const
+      {
+        return m_groups->available;
+      }
+
+      bool perf_source::read(perf_counters& current) const
+      {
+        read_groups(*m_groups, current);
+        return current.available != 0;
+      }
+    }
+
+    perf_counters perf_counter_timer::elapsed_counters() const
+    {
+      cpu_times times;
+      perf_counters counters;
+      elapsed(times, counters);
+      return counters;
+    }
+
+    std::string perf_counter_timer::format(short places, const std::string& fmt) const
+    {
+      cpu_times times;
+      perf_counters counters;
+      elapsed(times, counters);
+      format_extras extras;
+      extras.perf = &counters;
+      return timer::format(times, extras, places, fmt);
+    }
+
+  } // namespace timer
+} // namespace boost
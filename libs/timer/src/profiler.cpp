@@ -0,0 +1,300 @@
+//  boost profiler.cpp  ----------------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/config.hpp>
+
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+
+#include <boost/timer/profiler.hpp>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::profile_node;
+
+namespace
+{
+  const std::size_t none = static_cast<std::size_t>(-1);
+
+  struct node
+  {
+    const char*       name;
+    std::size_t       first_child;
+    std::size_t       next_sibling;
+    boost::uint64_t   count;
+    cpu_times         inclusive;
+  };
+
+  struct frame
+  {
+    std::size_t       node;
+    cpu_times         start;
+  };
+
+  //  nodes[0] is the root. Nodes are referred to by index, so that growing the vector
+  //  does not invalidate the stack.
+  struct thread_tree
+  {
+    std::vector<node>   nodes;
+    std::vector<frame>  stack;
+
+    thread_tree()
+    {
+      node root = { "", none, none, 0, cpu_times() };
+      root.inclusive.clear();
+      nodes.reserve(64);
+      nodes.push_back(root);
+      stack.reserve(16);
+    }
+
+    std::size_t child(std::size_t parent, const char* name)
+    {
+      std::size_t* link = &nodes[parent].first_child;
+      while (*link != none)
+      {
+        if (nodes[*link].name == name)
+          return *link;
+        link = &nodes[*link].next_sibling;
+      }
+      node n = { name, none, none, 0, cpu_times() };
+      n.inclusive.clear();
+      *link = nodes.size();  // before push_back, which may invalidate link
+      nodes.push_back(n);
+      return nodes.size() - 1;
+    }
+  };
+
+  struct global_profile
+  {
+    std::mutex        mutex;
+    profile_node      root;
+  };
+
+  //  Intentionally never destroyed, so that threads exiting during or after static
+  //  destruction can still merge their trees.
+  global_profile& the_profile()
+  {
+    static global_profile* p = new global_profile();
+    return *p;
+  }
+
+  void add(cpu_times& to, const cpu_times& t)
+  {
+    to.wall += t.wall;
+    to.user += t.user;
+    to.system += t.system;
+  }
+
+  //  Merges, and zeroes, the subtree of tree at index i into to. Caller holds the lock.
+  void merge(thread_tree& tree, std::size_t i, profile_node& to)
+  {
+    node& n = tree.nodes[i];
+    to.count += n.count;
+    add(to.inclusive, n.inclusive);
+    n.count = 0;
+    n.inclusive.clear();
+    for (std::size_t c = n.first_child; c != none; c = tree.nodes[c].next_sibling)
+    {
+      const char* name = tree.nodes[c].name;
+      std::size_t k = 0;
+      while (k < to.children.size() && to.children[k].name != name)
+        ++k;
+      if (k == to.children.size())
+      {
+        to.children.push_back(profile_node());
+        profile_node& p = to.children.back();
+        p.name = name;
+        p.count = 0;
+        p.inclusive.clear();
+        p.exclusive.clear();
+      }
+      merge(tree, c, to.children[k]);
+    }
+  }
+
+  void flush(thread_tree& tree)
+  {
+    global_profile& g = the_profile();
+    std::lock_guard<std::mutex> lock(g.mutex);
+    merge(tree, 0, g.root);
+  }
+
+  struct tree_owner
+  {
+    thread_tree* tree;
+   ~tree_owner()
+    {
+      if (tree)
+      {
+        flush(*tree);
+        delete tree;
+      }
+    }
+  };
+
+  thread_local tree_owner this_thread_tree = { 0 };
+
+  thread_tree& tree()
+  {
+    if (!this_thread_tree.tree)
+      this_thread_tree.tree = new thread_tree();
+    return *this_thread_tree.tree;
+  }
+
+  void compute_exclusive(profile_node& n)
+  {
+    n.exclusive = n.inclusive;
+    for (std::size_t i = 0; i < n.children.size(); ++i)
+    {
+      compute_exclusive(n.children[i]);
+      n.exclusive.wall -= n.children[i].inclusive.wall;
+      n.exclusive.user -= n.children[i].inclusive.user;
+      n.exclusive.system -= n.children[i].inclusive.system;
+    }
+    //  only while zones are active can the children have more time than the parent;
+    //  the root is never timed
+    if (n.exclusive.wall < 0) n.exclusive.wall = 0;
+    if (n.exclusive.user < 0) n.exclusive.user = 0;
+    if (n.exclusive.system < 0) n.exclusive.system = 0;
+  }
+
+  void append_name(std::string& s, const std::string& name, const char* replaced)
+  {
+    for (std::string::const_iterator it = name.begin(); it != name.end(); ++it)
+      s += std::strchr(replaced, *it) ? '_' : *it;
+  }
+
+  void write_report(std::ostream& os, const profile_node& n, std::size_t depth,
+    short places, const std::string& fmt)
+  {
+    std::string line(2 * depth, ' ');
+    append_name(line, n.name, "\r\n");
+    os << line << ": " << n.count
+       << (n.count == 1 ? " call, " : " calls, ")
+       << boost::timer::format(n.inclusive, places, fmt) << " inclusive, "
+       << boost::timer::format(n.exclusive, places, fmt) << " exclusive\n";
+    for (std::size_t i = 0; i < n.children.size(); ++i)
+      write_report(os, n.children[i], depth + 1, places, fmt);
+  }
+
+  void write_folded(std::ostream& os, const profile_node& n, std::string& stack,
+    unsigned fields)
+  {
+    const std::size_t length = stack.size();
+    if (!stack.empty())
+      stack += ';';
+    append_name(stack, n.name, ";\r\n");
+
+    nanosecond_type value = 0;
+    if (fields & boost::timer::wall_field)
+      value += n.exclusive.wall;
+    if (fields & boost::timer::user_field)
+      value += n.exclusive.user;
+    if (fields & boost::timer::system_field)
+      value += n.exclusive.system;
+    if (value > 0)
+      os << stack << ' ' << value << '\n';
+
+    for (std::size_t i = 0; i < n.children.size(); ++i)
+      write_folded(os, n.children[i], stack, fields);
+    stack.resize(length);
+  }
+}  // unnamed namespace
+
+namespace boost
+{
+  namespace timer
+  {
+    //  profile_zone  ------------------------------------------------------------------//
+
+    profile_zone::profile_zone(const char* name)
+    {
+      thread_tree& t = tree();
+      frame f;
+      f.node = t.child(t.stack.empty() ? 0 : t.stack.back().node, name);
+      t.stack.push_back(f);
+      thread_times_policy::get(t.stack.back().start);  // last, so as not to be timed
+    }
+
+    profile_zone::~profile_zone()
+    {
+      cpu_times now;
+      thread_times_policy::get(now);  // first, so as not to be timed
+      thread_tree& t = *this_thread_tree.tree;
+      const frame& f = t.stack.back();
+      node& n = t.nodes[f.node];
+      ++n.count;
+      n.inclusive.wall += now.wall - f.start.wall;
+      n.inclusive.user += now.user - f.start.user;
+      n.inclusive.system += now.system - f.start.system;
+      t.stack.pop_back();
+    }
+
+    //  the global profile  ------------------------------------------------------------//
+
+    BOOST_TIMER_DECL void flush_thread_profile()
+    {
+      if (this_thread_tree.tree)
+        flush(*this_thread_tree.tree);
+    }
+
+    BOOST_TIMER_DECL profile_node profile_snapshot()
+    {
+      global_profile& g = the_profile();
+      profile_node root;
+      {
+        std::lock_guard<std::mutex> lock(g.mutex);
+        root = g.root;
+      }
+      //  the root's own times are those of zones already merged at the top level
+      root.count = 0;
+      root.inclusive.clear();
+      for (std::size_t i = 0; i < root.children.size(); ++i)
+        add(root.inclusive, root.children[i].inclusive);
+      compute_exclusive(root);
+      return root;
+    }
+
+    BOOST_TIMER_DECL void reset_profile()
+    {
+      global_profile& g = the_profile();
+      std::lock_guard<std::mutex> lock(g.mutex);
+      g.root = profile_node();
+      g.root.count = 0;
+      g.root.inclusive.clear();
+      g.root.exclusive.clear();
+    }
+
+    BOOST_TIMER_DECL void write_profile_report(std::ostream& os,
+      const profile_node& root, short places, const std::string& fmt)
+    {
+      for (std::size_t i = 0; i < root.children.size(); ++i)
+        write_report(os, root.children[i], 0, places, fmt);
+    }
+
+    BOOST_TIMER_DECL void write_folded_stacks(std::ostream& os,
+      const profile_node& root, unsigned fields)
+    {
+      std::string stack;
+      for (std::size_t i = 0; i < root.children.size(); ++i)
+        write_folded(os, root.children[i], stack, fields);
+    }
+
+  } // namespace timer
+} // namespace boost
+
+#endif  // !BOOST_TIMER_NO_CXX11_CONCURRENCY
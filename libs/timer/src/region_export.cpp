@@ -0,0 +1,399 @@
+//  boost region_export.cpp  -----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/config.hpp>
+
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+
+#include <boost/timer/region_export.hpp>
+#include <boost/system/api_config.hpp>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+# if defined(BOOST_POSIX_API)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <sys/types.h>
+#   include <unistd.h>
+# endif
+
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::region_stats;
+using boost::timer::export_header;
+using boost::timer::export_record;
+
+//  The layout is shared with other processes, which may have been built differently.
+static_assert(sizeof(export_header) == 64, "export_header layout");
+static_assert(sizeof(export_record) == 192, "export_record layout");
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+  "shared memory requires address-free atomics");
+
+namespace
+{
+  const char magic[8] = { 'B', 'T', 'E', 'X', 'P', 'O', 'R', 'T' };
+
+  //  A reader gives up on a record still being updated after this many attempts, as
+  //  it would be if the exporting process died during an update.
+  const int read_attempts = 10000;
+
+  struct exporter
+  {
+    std::mutex                    mutex;        // serializes starting, publishing,
+                                                //   and stopping
+    std::atomic<bool>             active;
+    std::string                   name;
+    unsigned char*                map;
+    std::size_t                   size;
+    std::vector<region_stats>     stats;        // publishing only
+    std::vector<boost::uint64_t>  published;    // count last published, by record
+
+    std::mutex                    wait_mutex;   // the background thread and stop only
+    std::condition_variable       wakeup;
+    bool                          stopping;
+    std::thread                   thread;
+  };
+
+  //  Intentionally never destroyed, so that an export may be stopped during static
+  //  destruction.
+  exporter& the_exporter()
+  {
+    static exporter* e = new exporter();
+    return *e;
+  }
+
+  export_header& header_of(unsigned char* map)
+  {
+    return *reinterpret_cast<export_header*>(map);
+  }
+
+  export_record& record_of(unsigned char* map, std::size_t i)
+  {
+    return *reinterpret_cast<export_record*>(
+      map + sizeof(export_header) + i * sizeof(export_record));
+  }
+
+  //  Requires e.mutex.
+  void publish(exporter& e)
+  {
+    boost::timer::snapshot_regions(e.stats);
+    export_header& h = header_of(e.map);
+    const std::size_t n = e.stats.size() < h.capacity ? e.stats.size() : h.capacity;
+    std::size_t count = h.record_count.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      const region_stats& st = e.stats[i];
+      export_record& r = record_of(e.map, i);
+      if (i == count)  // a new region; its name is published with record_count
+      {
+        const std::size_t size = st.name.size() < sizeof(r.name)
+          ? st.name.size() : sizeof(r.name);
+        std::memcpy(r.name, st.name.data(), size);
+        r.name_size = static_cast<boost::uint32_t>(size);
+        r.sampling_period = st.sampling_period;
+        r.sampling = static_cast<boost::uint32_t>(st.sampling);
+        h.record_count.store(static_cast<boost::uint32_t>(++count),
+          std::memory_order_release);
+        e.published.push_back(0);
+      }
+      else if (st.count == e.published[i])
+        continue;  // unchanged, so readers need not retry
+
+      const boost::uint32_t seq = r.sequence.load(std::memory_order_relaxed);
+      r.sequence.store(seq + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      const cpu_times* times[3] = { &st.total, &st.min, &st.max };
+      std::atomic<boost::int_least64_t>* cells[3] = { r.total, r.min, r.max };
+      r.count.store(static_cast<boost::int_least64_t>(st.count),
+        std::memory_order_relaxed);
+      for (int j = 0; j < 3; ++j)
+      {
+        cells[j][0].store(times[j]->wall, std::memory_order_relaxed);
+        cells[j][1].store(times[j]->user, std::memory_order_relaxed);
+        cells[j][2].store(times[j]->system, std::memory_order_relaxed);
+      }
+      r.sequence.store(seq + 2, std::memory_order_release);
+      e.published[i] = st.count;
+    }
+    h.region_count.store(static_cast<boost::uint32_t>(e.stats.size()),
+      std::memory_order_relaxed);
+    h.updated.store(boost::timer::current_wall_time(), std::memory_order_relaxed);
+    h.publications.fetch_add(1, std::memory_order_release);
+  }
+
+  void run(exporter& e, unsigned interval_ms)
+  {
+    typedef std::chrono::steady_clock clock;
+    const clock::duration interval = std::chrono::milliseconds(interval_ms);
+    clock::time_point next = clock::now() + interval;
+    std::unique_lock<std::mutex> wait_lock(e.wait_mutex);
+    for (;;)
+    {
+      if (e.wakeup.wait_until(wait_lock, next, [&e] { return e.stopping; }))
+        return;
+      {
+        std::lock_guard<std::mutex> lock(e.mutex);
+        publish(e);
+      }
+      next += interval;
+      const clock::time_point current = clock::now();
+      if (next < current)
+        next = current + interval;
+    }
+  }
+
+  //  Copies r into st, retrying while it is being updated. Returns false if it is
+  //  never seen intact.
+  bool read_record(const export_record& r, region_stats& st)
+  {
+    for (int attempt = 0; attempt < read_attempts; ++attempt)
+    {
+      const boost::uint32_t before = r.sequence.load(std::memory_order_acquire);
+      if (before & 1u)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+      st.count = static_cast<boost::uint64_t>(r.count.load(std::memory_order_relaxed));
+      cpu_times* times[3] = { &st.total, &st.min, &st.max };
+      const std::atomic<boost::int_least64_t>* cells[3] = { r.total, r.min, r.max };
+      for (int j = 0; j < 3; ++j)
+      {
+        times[j]->wall = cells[j][0].load(std::memory_order_relaxed);
+        times[j]->user = cells[j][1].load(std::memory_order_relaxed);
+        times[j]->system = cells[j][2].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (r.sequence.load(std::memory_order_relaxed) == before)
+        return true;
+    }
+    return false;
+  }
+
+} // unnamed namespace
+
+namespace boost
+{
+  namespace timer
+  {
+    //  exporting  ---------------------------------------------------------------------//
+
+    BOOST_TIMER_DECL
+    bool start_export(const std::string& name, unsigned interval_ms, std::size_t capacity)
+    {
+      exporter& e = the_exporter();
+      std::lock_guard<std::mutex> lock(e.mutex);
+      if (e.active.load())
+      {
+        errno = EBUSY;
+        return false;
+      }
+      if (capacity == 0)
+      {
+        errno = EINVAL;
+        return false;
+      }
+# if defined(BOOST_POSIX_API)
+      std::string path(name);
+      if (path.empty())
+      {
+        char buf[32];
+        std::sprintf(buf, "/boost_timer.%ld", static_cast<long>(::getpid()));
+        path = buf;
+      }
+      const std::size_t size = sizeof(export_header) + capacity * sizeof(export_record);
+      int fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+      if (fd < 0)
+        return false;
+      void* map = MAP_FAILED;
+      if (::ftruncate(fd, static_cast<off_t>(size)) == 0)
+        map = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      const int error = errno;
+      ::close(fd);
+      if (map == MAP_FAILED)
+      {
+        ::shm_unlink(path.c_str());
+        errno = error;
+        return false;
+      }
+
+      //  ftruncate() zero-filled the object, so every atomic starts at 0
+      e.map = static_cast<unsigned char*>(map);
+      e.size = size;
+      e.name = path;
+      e.published.clear();
+      export_header& h = header_of(e.map);
+      h.major_version = export_major_version;
+      h.minor_version = export_minor_version;
+      h.header_size = sizeof(export_header);
+      h.record_size = sizeof(export_record);
+      h.capacity = static_cast<boost::uint32_t>(capacity);
+      h.pid = ::getpid();
+      std::memcpy(h.magic, magic, sizeof(magic));
+      publish(e);  // the first publication makes the header visible to readers
+
+      e.stopping = false;
+      if (interval_ms)
+        e.thread = std::thread(&run, std::ref(e), interval_ms);
+      e.active.store(true);
+      return true;
+# else
+      (void)name;
+      (void)interval_ms;
+      errno = ENOSYS;
+      return false;
+# endif
+    }
+
+    BOOST_TIMER_DECL void stop_export(bool remove)
+    {
+      exporter& e = the_exporter();
+      if (!e.active.load())
+        return;
+      if (e.thread.joinable())
+      {
+        {
+          std::lock_guard<std::mutex> wait_lock(e.wait_mutex);
+          e.stopping = true;
+        }
+        e.wakeup.notify_one();
+        e.thread.join();
+      }
+
+      std::lock_guard<std::mutex> lock(e.mutex);
+      e.active.store(false);
+# if defined(BOOST_POSIX_API)
+      publish(e);
+      ::munmap(e.map, e.size);
+      if (remove)
+        ::shm_unlink(e.name.c_str());
+# else
+      (void)remove;
+# endif
+      e.map = 0;
+      e.name.clear();
+    }
+
+    BOOST_TIMER_DECL void publish_regions()
+    {
+      exporter& e = the_exporter();
+      std::lock_guard<std::mutex> lock(e.mutex);
+      if (e.active.load())
+        publish(e);
+    }
+
+    BOOST_TIMER_DECL bool export_active()
+    {
+      return the_exporter().active.load(std::memory_order_relaxed);
+    }
+
+    BOOST_TIMER_DECL std::string export_name()
+    {
+      exporter& e = the_exporter();
+      std::lock_guard<std::mutex> lock(e.mutex);
+      return e.name;
+    }
+
+    //  reading  -----------------------------------------------------------------------//
+
+    BOOST_TIMER_DECL
+    bool read_export(const std::string& name, export_snapshot& snapshot)
+    {
+# if defined(BOOST_POSIX_API)
+      int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+      if (fd < 0)
+        return false;
+      struct stat st;
+      void* map = MAP_FAILED;
+      if (::fstat(fd, &st) == 0)
+      {
+        if (static_cast<std::size_t>(st.st_size) < sizeof(export_header))
+          errno = EPROTO;
+        else
+          map = ::mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      }
+      const int error = errno;
+      ::close(fd);
+      if (map == MAP_FAILED)
+      {
+        errno = error;
+        return false;
+      }
+
+      const unsigned char* base = static_cast<const unsigned char*>(map);
+      const export_header& h = *reinterpret_cast<const export_header*>(base);
+      const std::size_t size = static_cast<std::size_t>(st.st_size);
+      const boost::uint64_t publications
+        = h.publications.load(std::memory_order_acquire);
+      bool ok = publications != 0 && std::memcmp(h.magic, magic, sizeof(magic)) == 0
+        && h.major_version == export_major_version
+        && h.header_size >= sizeof(export_header)
+        && h.record_size >= sizeof(export_record)
+        && h.header_size + static_cast<std::size_t>(h.capacity) * h.record_size <= size;
+      if (ok)
+      {
+        snapshot.pid = h.pid;
+        snapshot.minor_version = h.minor_version;
+        snapshot.publications = publications;
+        snapshot.updated = h.updated.load(std::memory_order_relaxed);
+        snapshot.region_count = h.region_count.load(std::memory_order_relaxed);
+        std::size_t count = h.record_count.load(std::memory_order_acquire);
+        if (count > h.capacity)
+          count = h.capacity;
+
+        snapshot.regions.clear();
+        snapshot.regions.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+          const export_record& r = *reinterpret_cast<const export_record*>(
+            base + h.header_size + i * h.record_size);
+          region_stats s;
+          if (!read_record(r, s))
+            continue;
+          s.name.assign(r.name, r.name_size < sizeof(r.name)
+            ? r.name_size : sizeof(r.name));
+          for (int j = 0; j < 3; ++j)
+            s.sum_of_squares[j] = 0.0;
+          s.sampling_period = r.sampling_period;
+          s.sampling = r.sampling == random_sampling
+            ? random_sampling : systematic_sampling;
+          snapshot.regions.push_back(s);
+        }
+      }
+      ::munmap(map, size);
+      if (!ok)
+        errno = EPROTO;
+      return ok;
+# else
+      (void)name;
+      (void)snapshot;
+      errno = ENOSYS;
+      return false;
+# endif
+    }
+
+  } // namespace timer
+} // namespace boost
+
+#endif  // !BOOST_TIMER_NO_CXX11_CONCURRENCY
@@ -0,0 +1,305 @@
+//  boost registry.cpp  ----------------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/config.hpp>
+
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+
+#include <boost/timer/registry.hpp>
+#include <boost/throw_exception.hpp>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+//  The number of regions is fixed when the library is built, so that every thread's
+//  slots can be allocated in one piece the first time the thread adds times.
+#ifndef BOOST_TIMER_MAX_REGIONS
+# define BOOST_TIMER_MAX_REGIONS 512
+#endif
+
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+
+namespace
+{
+  const std::size_t capacity = BOOST_TIMER_MAX_REGIONS;
+
+  typedef std::atomic<boost::int_least64_t> counter;
+
+  //  Each slot is written only by its owning thread, as a single-writer seqlock:
+  //  seq is odd while an update is in progress, so readers can retry torn reads.
+  struct slot
+  {
+    std::atomic<unsigned>   seq;
+    counter                 count;
+    counter                 total[3];
+    counter                 min[3];
+    counter                 max[3];
+    std::atomic<double>     sum_of_squares[3];
+  };
+
+  //  Slots are never freed. When a thread exits its slots become free for reuse by a
+  //  later thread, which continues to accumulate into them; since accumulations are
+  //  merged per region anyway, nothing is lost.
+  struct thread_slots
+  {
+    slot                        slots[capacity];
+    std::atomic<bool>           in_use;
+    thread_slots*               next;  // immutable once published
+  };
+
+  struct registry
+  {
+    std::mutex                  names_mutex;   // serializes registration
+    std::string                 names[capacity];
+    boost::uint32_t             periods[capacity];
+    boost::timer::sampling_method  methods[capacity];
+    std::atomic<std::size_t>    size;
+    std::atomic<thread_slots*>  head;
+  };
+
+  //  Intentionally never destroyed, so that threads exiting during or after static
+  //  destruction can still release their slots.
+  registry& the_registry()
+  {
+    static registry* r = new registry();
+    return *r;
+  }
+
+  thread_slots* acquire_slots()
+  {
+    registry& r = the_registry();
+    for (thread_slots* p = r.head.load(std::memory_order_acquire); p; p = p->next)
+    {
+      bool expected = false;
+      if (!p->in_use.load(std::memory_order_relaxed)
+        && p->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        return p;
+    }
+
+    thread_slots* p = new thread_slots();  // value-initialized, so all zero
+    p->in_use.store(true, std::memory_order_relaxed);
+    p->next = r.head.load(std::memory_order_relaxed);
+    while (!r.head.compare_exchange_weak(p->next, p,
+      std::memory_order_release, std::memory_order_relaxed)) {}
+    return p;
+  }
+
+  struct slots_owner
+  {
+    thread_slots* slots;
+   ~slots_owner()
+    {
+      if (slots)
+        slots->in_use.store(false, std::memory_order_release);
+    }
+  };
+
+  thread_local slots_owner this_thread_slots = { 0 };
+
+  inline void set_if_less(counter& c, nanosecond_type v)
+  {
+    if (v < c.load(std::memory_order_relaxed))
+      c.store(v, std::memory_order_relaxed);
+  }
+
+  inline void set_if_greater(counter& c, nanosecond_type v)
+  {
+    if (v > c.load(std::memory_order_relaxed))
+      c.store(v, std::memory_order_relaxed);
+  }
+
+  //  Reads a consistent copy of s, which may be concurrently updated by its owner.
+  void read_slot(const slot& s, boost::int_least64_t& count,
+    cpu_times& total, cpu_times& min, cpu_times& max, double sum_of_squares[3])
+  {
+    unsigned before, after;
+    do
+    {
+      while ((before = s.seq.load(std::memory_order_acquire)) & 1u) {}
+      count = s.count.load(std::memory_order_relaxed);
+      total.wall = s.total[0].load(std::memory_order_relaxed);
+      total.user = s.total[1].load(std::memory_order_relaxed);
+      total.system = s.total[2].load(std::memory_order_relaxed);
+      min.wall = s.min[0].load(std::memory_order_relaxed);
+      min.user = s.min[1].load(std::memory_order_relaxed);
+      min.system = s.min[2].load(std::memory_order_relaxed);
+      max.wall = s.max[0].load(std::memory_order_relaxed);
+      max.user = s.max[1].load(std::memory_order_relaxed);
+      max.system = s.max[2].load(std::memory_order_relaxed);
+      for (int i = 0; i < 3; ++i)
+        sum_of_squares[i] = s.sum_of_squares[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = s.seq.load(std::memory_order_relaxed);
+    } while (before != after);
+  }
+
+} // unnamed namespace
+
+namespace boost
+{
+  namespace timer
+  {
+    //  region  ------------------------------------------------------------------------//
+
+    region::region(const std::string& name)
+    {
+      register_name(name, 1, systematic_sampling);
+    }
+
+    region::region(const std::string& name, boost::uint32_t sampling_period,
+      sampling_method method)
+    {
+      if (sampling_period == 0)
+        BOOST_THROW_EXCEPTION(std::invalid_argument(
+          "boost::timer::region: sampling period of 0"));
+      register_name(name, sampling_period, method);
+    }
+
+    void region::register_name(const std::string& name,
+      boost::uint32_t sampling_period, sampling_method method)
+    {
+      registry& r = the_registry();
+      std::lock_guard<std::mutex> lock(r.names_mutex);
+      std::size_t size = r.size.load(std::memory_order_relaxed);
+      for (m_id = 0; m_id < size; ++m_id)
+      {
+        if (r.names[m_id] == name)
+        {
+          if (r.periods[m_id] != sampling_period
+            || (sampling_period > 1 && r.methods[m_id] != method))
+            BOOST_THROW_EXCEPTION(std::invalid_argument(
+              "boost::timer::region: " + name + " registered with different sampling"));
+          return;
+        }
+      }
+      if (size == capacity)
+        BOOST_THROW_EXCEPTION(std::length_error("boost::timer::region: too many regions"));
+      r.names[size] = name;
+      r.periods[size] = sampling_period;
+      r.methods[size] = method;
+      r.size.store(size + 1, std::memory_order_release);
+    }
+
+    const std::string& region::name() const
+    {
+      return the_registry().names[m_id];
+    }
+
+    void region::add(const cpu_times& times) const
+    {
+      thread_slots* ts = this_thread_slots.slots;
+      if (!ts)
+        ts = this_thread_slots.slots = acquire_slots();
+      slot& s = ts->slots[m_id];
+
+      const unsigned seq = s.seq.load(std::memory_order_relaxed);
+      s.seq.store(seq + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      const boost::int_least64_t count = s.count.load(std::memory_order_relaxed);
+      const nanosecond_type t[3] = { times.wall, times.user, times.system };
+      for (int i = 0; i < 3; ++i)
+      {
+        s.total[i].store(s.total[i].load(std::memory_order_relaxed) + t[i],
+          std::memory_order_relaxed);
+        s.sum_of_squares[i].store(s.sum_of_squares[i].load(std::memory_order_relaxed)
+          + static_cast<double>(t[i]) * static_cast<double>(t[i]),
+          std::memory_order_relaxed);
+        if (count == 0)
+        {
+          s.min[i].store(t[i], std::memory_order_relaxed);
+          s.max[i].store(t[i], std::memory_order_relaxed);
+        }
+        else
+        {
+          set_if_less(s.min[i], t[i]);
+          set_if_greater(s.max[i], t[i]);
+        }
+      }
+      s.count.store(count + 1, std::memory_order_relaxed);
+
+      s.seq.store(seq + 2, std::memory_order_release);
+    }
+
+    BOOST_TIMER_DECL
+    std::size_t max_regions()
+    {
+      return capacity;
+    }
+
+    BOOST_TIMER_DECL
+    void snapshot_regions(std::vector<region_stats>& stats)
+    {
+      registry& r = the_registry();
+      std::size_t size;
+      {
+        std::lock_guard<std::mutex> lock(r.names_mutex);
+        size = r.size.load(std::memory_order_relaxed);
+        stats.resize(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+          stats[i].name = r.names[i];
+          stats[i].count = 0;
+          stats[i].total.clear();
+          stats[i].min.clear();
+          stats[i].max.clear();
+          for (int j = 0; j < 3; ++j)
+            stats[i].sum_of_squares[j] = 0.0;
+          stats[i].sampling_period = r.periods[i];
+          stats[i].sampling = r.methods[i];
+        }
+      }
+
+      for (thread_slots* p = r.head.load(std::memory_order_acquire); p; p = p->next)
+      {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+          boost::int_least64_t count;
+          cpu_times total, min, max;
+          double sum_of_squares[3];
+          read_slot(p->slots[i], count, total, min, max, sum_of_squares);
+          if (count == 0)
+            continue;
+
+          region_stats& st = stats[i];
+          if (st.count == 0)
+          {
+            st.min = min;
+            st.max = max;
+          }
+          else
+          {
+            if (min.wall < st.min.wall) st.min.wall = min.wall;
+            if (min.user < st.min.user) st.min.user = min.user;
+            if (min.system < st.min.system) st.min.system = min.system;
+            if (max.wall > st.max.wall) st.max.wall = max.wall;
+            if (max.user > st.max.user) st.max.user = max.user;
+            if (max.system > st.max.system) st.max.system = max.system;
+          }
+          st.count += count;
+          st.total.wall += total.wall;
+          st.total.user += total.user;
+          st.total.system += total.system;
+          for (int j = 0; j < 3; ++j)
+            st.sum_of_squares[j] += sum_of_squares[j];
+        }
+      }
+    }
+
+  } // namespace timer
+} // namespace boost
+
+#endif  // !BOOST_TIMER_NO_CXX11_CONCURRENCY
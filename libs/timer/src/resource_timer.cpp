@@ -0,0 +1,100 @@
+//  boost resource_timer.cpp  ----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/resource_timer.hpp>
+#include <string>
+
+# if defined(BOOST_POSIX_API)
+#   include <sys/time.h>
+#   include <sys/resource.h>
+# endif
+
+namespace boost
+{
+  namespace timer
+  {
+    BOOST_TIMER_DECL
+    bool current_resource_usage(resource_usage& current, resource_scope scope)
+    {
+      current.clear();
+# if defined(BOOST_POSIX_API)
+      int who = RUSAGE_SELF;
+      if (scope == thread_resources)
+      {
+#   if defined(RUSAGE_THREAD)
+        who = RUSAGE_THREAD;
+#   else
+        return false;
+#   endif
+      }
+      rusage ru;
+      if (::getrusage(who, &ru) == -1)
+        return false;
+      current.minor_faults = ru.ru_minflt;
+      current.major_faults = ru.ru_majflt;
+      current.voluntary_switches = ru.ru_nvcsw;
+      current.involuntary_switches = ru.ru_nivcsw;
+      current.block_inputs = ru.ru_inblock;
+      current.block_outputs = ru.ru_oublock;
+#   if defined(__APPLE__)
+      current.max_rss = ru.ru_maxrss / 1024;  // bytes
+#   else
+      current.max_rss = ru.ru_maxrss;
+#   endif
+#   if defined(RUSAGE_THREAD)
+      if (scope == thread_resources)  // the thread's is not maintained
+      {
+        if (::getrusage(RUSAGE_SELF, &ru) == -1)
+          return false;
+        current.max_rss = ru.ru_maxrss;
+      }
+#   endif
+      return true;
+# else
+      (void)scope;
+      return false;
+# endif
+    }
+
+    BOOST_TIMER_DECL
+    const std::string& default_resource_format()
+    {
+      static std::string fmt(" %ws wall, %ts CPU (%p%), %f+%F faults,"
+        " %c+%C switches, %i+%o blocks, %m KB\n");
+      return fmt;
+    }
+
+    //  resource_timer  ----------------------------------------------------------------//
+
+    resource_usage resource_timer::elapsed_usage() const
+    {
+      cpu_times times;
+      resource_usage usage;
+      elapsed(times, usage);
+      return usage;
+    }
+
+    std::string resource_timer::format(short places, const std::string& fmt) const
+    {
+      cpu_times times;
+      resource_usage usage;
+      elapsed(times, usage);
+      format_extras extras;
+      extras.usage = has_usage() ? &usage : 0;
+      return timer::format(times, extras, places, fmt);
+    }
+
+  } // namespace timer
+} // namespace boost
@@ -0,0 +1,118 @@
+//  boost sampled_timer.cpp  -----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/config.hpp>
+
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+
+#include <boost/timer/sampled_timer.hpp>
+#include <cmath>
+#include <limits>
+
+using boost::timer::nanosecond_type;
+
+namespace
+{
+  const double z_95 = 1.96;  // standard normal quantile for a 95% interval
+
+  //  xorshift64*, seeded per thread from the state's address and the wall clock
+  struct generator
+  {
+    boost::uint64_t state;
+
+    double next()  // uniform in (0, 1]
+    {
+      if (state == 0)
+      {
+        state = reinterpret_cast<boost::uint64_t>(this)
+          ^ static_cast<boost::uint64_t>(boost::timer::current_wall_time());
+        state = (state ^ (state >> 31)) * 0x9E3779B97F4A7C15ULL;
+        if (state == 0)
+          state = 1;
+      }
+      state ^= state >> 12;
+      state ^= state << 25;
+      state ^= state >> 27;
+      const boost::uint64_t x = state * 0x2545F4914F6CDD1DULL;
+      return (static_cast<double>(x >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+    }
+  };
+
+  thread_local generator this_thread_generator = { 0 };
+
+  double sample_variance(double total, double sum_of_squares, double n)
+  {
+    if (n < 2.0)
+      return 0.0;
+    const double v = (sum_of_squares - total * total / n) / (n - 1.0);
+    return v > 0.0 ? v : 0.0;
+  }
+
+} // unnamed namespace
+
+namespace boost
+{
+  namespace timer
+  {
+    boost::int_least32_t sampled_region::next_interval() const
+    {
+      if (m_method == systematic_sampling || m_period == 1)
+        return static_cast<boost::int_least32_t>(m_period);
+
+      //  the number of Bernoulli trials, each a success with probability 1/period,
+      //  up to and including the first success
+      const double u = this_thread_generator.next();
+      const double k = std::floor(std::log(u) / std::log1p(-1.0 / m_period));
+      const double limit = std::numeric_limits<boost::int_least32_t>::max() - 1;
+      return static_cast<boost::int_least32_t>(k < limit ? k : limit) + 1;
+    }
+
+    BOOST_TIMER_DECL
+    sampled_estimate estimate_totals(const region_stats& stats)
+    {
+      const double n = static_cast<double>(stats.count);
+      const double period = stats.sampling_period;
+      const nanosecond_type sampled[3]
+        = { stats.total.wall, stats.total.user, stats.total.system };
+      double total[3], error[3];
+
+      for (int i = 0; i < 3; ++i)
+      {
+        total[i] = period * sampled[i];
+        if (period <= 1.0 || n == 0.0)
+          error[i] = 0.0;
+        else if (stats.sampling == systematic_sampling)
+          error[i] = z_95 * period * std::sqrt(n * (1.0 - 1.0 / period)
+            * sample_variance(static_cast<double>(sampled[i]),
+                stats.sum_of_squares[i], n));
+        else  // Horvitz-Thompson estimator under Bernoulli sampling
+          error[i] = z_95 * std::sqrt(period * (period - 1.0) * stats.sum_of_squares[i]);
+      }
+
+      sampled_estimate est;
+      est.executions = n * period;
+      est.total.wall = static_cast<nanosecond_type>(total[0]);
+      est.total.user = static_cast<nanosecond_type>(total[1]);
+      est.total.system = static_cast<nanosecond_type>(total[2]);
+      est.error.wall = static_cast<nanosecond_type>(error[0]);
+      est.error.user = static_cast<nanosecond_type>(error[1]);
+      est.error.system = static_cast<nanosecond_type>(error[2]);
+      return est;
+    }
+
+  } // namespace timer
+} // namespace boost
+
+#endif  // !BOOST_TIMER_NO_CXX11_CONCURRENCY
@@ -0,0 +1,141 @@
+//  boost sched_timer.cpp  -------------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/sched_timer.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+# if defined(__linux__)
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <sys/syscall.h>
+# endif
+
+using boost::timer::sched_times;
+
+namespace
+{
+  //  Opens the calling thread's statistics; -1 if not available
+  int open_schedstat()
+  {
+# if defined(__linux__)
+    int fd = ::open("/proc/thread-self/schedstat", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)  // before Linux 3.17
+    {
+      char path[64];
+      std::sprintf(path, "/proc/self/task/%ld/schedstat",
+        static_cast<long>(::syscall(SYS_gettid)));
+      fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    }
+    return fd;
+# else
+    return -1;
+# endif
+  }
+
+  //  "<running ns> <runnable ns> <timeslices>\n"
+  bool read_schedstat(int fd, sched_times& current)
+  {
+    current.clear();
+# if defined(__linux__)
+    char buf[128];
+    ssize_t n = ::pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0)
+      return false;
+    buf[n] = '\0';
+    char* end;
+    current.running = std::strtoll(buf, &end, 10);
+    current.runnable = std::strtoll(end, &end, 10);
+    return true;
+# else
+    (void)fd;
+    return false;
+# endif
+  }
+}  // unnamed namespace
+
+namespace boost
+{
+  namespace timer
+  {
+    BOOST_TIMER_DECL
+    bool current_sched_times(sched_times& current)
+    {
+      int fd = open_schedstat();
+      if (fd < 0)
+      {
+        current.clear();
+        return false;
+      }
+      bool ok = read_schedstat(fd, current);
+# if defined(__linux__)
+      ::close(fd);
+# endif
+      return ok;
+    }
+
+    BOOST_TIMER_DECL
+    const std::string& default_sched_format()
+    {
+      static std::string fmt(" %ws wall: %es running, %qs runnable, %bs blocked\n");
+      return fmt;
+    }
+
+    //  sched_timer  -------------------------------------------------------------------//
+
+    namespace detail
+    {
+      sched_source::sched_source() : m_fd(open_schedstat()) {}
+
+      sched_source::~sched_source()
+      {
+# if defined(__linux__)
+        if (m_fd >= 0)
+          ::close(m_fd);
+# endif
+      }
+
+      bool sched_source::read(sched_times& current) const
+      {
+        if (m_fd < 0)
+        {
+          current.clear();
+          return false;
+        }
+        return read_schedstat(m_fd, current);
+      }
+    }
+
+    sched_times sched_timer::elapsed_sched() const
+    {
+      cpu_times times;
+      sched_times sched;
+      elapsed(times, sched);
+      return sched;
+    }
+
+    std::string sched_timer::format(short places, const std::string& fmt) const
+    {
+      cpu_times times;
+      sched_times sched;
+      elapsed(times, sched);
+      format_extras extras;
+      extras.sched = has_sched() ? &sched : 0;
+      return timer::format(times, extras, places, fmt);
+    }
+
+  } // namespace timer
+} // namespace boost
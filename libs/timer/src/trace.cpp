@@ -0,0 +1,409 @@
+//  boost trace.cpp  -------------------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//--------------------------------------------------------------------------------------//
+
+// define BOOST_TIMER_SOURCE so that <boost/timer/config.hpp> knows
+// the library is being built (possibly exporting rather than importing code)
+#define BOOST_TIMER_SOURCE
+
+#include <boost/timer/config.hpp>
+
+#if !defined(BOOST_TIMER_NO_CXX11_CONCURRENCY)
+
+#include <boost/timer/trace.hpp>
+#include <boost/timer/detail/json.hpp>
+#include <boost/system/api_config.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+# if defined(BOOST_POSIX_API)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/types.h>
+#   include <unistd.h>
+# endif
+
+using boost::timer::nanosecond_type;
+using boost::timer::trace_record;
+
+namespace
+{
+  const std::size_t header_size = 32;
+  const char magic[] = "BTTRACE1";
+  const boost::uint32_t byte_order = 0x01020304;
+  const std::size_t buffer_records = 4096;  // 64KB per recording thread
+
+  //  The trace file. write() may be called concurrently for disjoint ranges.
+  class trace_file
+  {
+  public:
+# if defined(BOOST_POSIX_API)
+    trace_file() : m_fd(-1), m_map(0), m_size(0) {}
+
+    bool open(const std::string& path, std::size_t size)
+    {
+      m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+      if (m_fd < 0)
+        return false;
+      void* map = MAP_FAILED;
+      if (::ftruncate(m_fd, static_cast<off_t>(size)) == 0)
+        map = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+      if (map == MAP_FAILED)
+      {
+        int error = errno;
+        ::close(m_fd);
+        errno = error;
+        return false;
+      }
+      m_map = static_cast<char*>(map);
+      m_size = size;
+      return true;
+    }
+
+    void write(std::size_t offset, const void* data, std::size_t n)
+    {
+      std::memcpy(m_map + offset, data, n);
+    }
+
+    void close(std::size_t used)
+    {
+      ::munmap(m_map, m_size);
+      if (::ftruncate(m_fd, static_cast<off_t>(used))) {}  // the tail is zeros anyway
+      ::close(m_fd);
+    }
+
+  private:
+    int             m_fd;
+    char*           m_map;
+    std::size_t     m_size;
+# else
+    //  without mmap(), writes are serialized
+    trace_file() : m_file(0) {}
+
+    bool open(const std::string& path, std::size_t)
+    {
+      m_file = std::fopen(path.c_str(), "wb");
+      return m_file != 0;
+    }
+
+    void write(std::size_t offset, const void* data, std::size_t n)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      std::fseek(m_file, static_cast<long>(offset), SEEK_SET);
+      std::fwrite(data, 1, n, m_file);
+    }
+
+    void close(std::size_t)
+    {
+      std::fclose(m_file);
+    }
+
+  private:
+    std::FILE*      m_file;
+    std::mutex      m_mutex;
+# endif
+  };
+
+  struct tracer
+  {
+    std::mutex                    mutex;      // start, stop, and name registration
+    std::vector<std::string>      names;      // names[id - 1]
+    trace_file                    file;
+    std::size_t                   capacity;   // bytes
+    nanosecond_type               start;      // set before active
+
+    std::atomic<bool>             active;
+    std::atomic<unsigned>         generation; // of the trace, so stale buffers are discarded
+    std::atomic<std::size_t>      used;       // bytes reserved, possibly beyond capacity
+    std::atomic<int>              writers;    // appending, so stop_trace() must wait
+    std::atomic<boost::uint64_t>  dropped;
+    std::atomic<unsigned>         threads;
+  };
+
+  //  Intentionally never destroyed, so that threads exiting during or after static
+  //  destruction can still append their buffers.
+  tracer& the_tracer()
+  {
+    static tracer* t = new tracer();
+    return *t;
+  }
+
+  //  Appends records to the active trace, if it is still generation's
+  void append(const trace_record* records, std::size_t n, unsigned generation)
+  {
+    tracer& t = the_tracer();
+    t.writers.fetch_add(1);  // before checking active; stop_trace() clears active first
+    if (t.active.load() && t.generation.load() == generation)
+    {
+      const std::size_t bytes = n * sizeof(trace_record);
+      const std::size_t at = t.used.fetch_add(bytes);
+      if (at + bytes <= t.capacity)
+        t.file.write(at, records, bytes);
+      else
+        t.dropped.fetch_add(n, std::memory_order_relaxed);
+    }
+    t.writers.fetch_sub(1);
+  }
+
+  //  Caller holds the mutex, and the trace is active or being started
+  void append_name(boost::uint32_t id, const std::string& name, unsigned generation)
+  {
+    std::vector<trace_record> records;
+    std::size_t pos = 0;
+    do
+    {
+      trace_record r;
+      r.kind = boost::timer::name_record;
+      r.size = static_cast<boost::uint8_t>(std::min(name.size() - pos, sizeof(r.time)));
+      r.thread = 0;
+      r.name = id;
+      r.time = 0;
+      std::memcpy(&r.time, name.data() + pos, r.size);
+      records.push_back(r);
+      pos += r.size;
+    } while (pos < name.size());
+    append(&records[0], records.size(), generation);
+  }
+
+  struct thread_buffer
+  {
+    trace_record*     records;
+    std::size_t       size;
+    unsigned          generation;
+    boost::uint16_t   thread;
+
+    void flush()
+    {
+      if (size)
+        append(records, size, generation);
+      size = 0;
+    }
+
+   ~thread_buffer()
+    {
+      if (records)
+      {
+        flush();
+        delete [] records;
+      }
+    }
+  };
+
+  thread_local thread_buffer this_thread_buffer = { 0, 0, 0, 0 };
+
+  void record(boost::uint8_t kind, boost::uint32_t name)
+  {
+    tracer& t = the_tracer();
+    if (!t.active.load(std::memory_order_relaxed))
+      return;
+    thread_buffer& b = this_thread_buffer;
+    const unsigned generation = t.generation.load(std::memory_order_acquire);
+    if (!b.records)
+    {
+      b.records = new trace_record[buffer_records];
+      b.thread = static_cast<boost::uint16_t>(t.threads.fetch_add(1) + 1);
+      b.generation = generation;
+    }
+    if (b.generation != generation)  // left over from an earlier trace
+    {
+      b.size = 0;
+      b.generation = generation;
+    }
+    trace_record& r = b.records[b.size];
+    r.kind = kind;
+    r.size = 0;
+    r.thread = b.thread;
+    r.name = name;
+    r.time = static_cast<boost::uint64_t>(boost::timer::current_wall_time() - t.start);
+    if (++b.size == buffer_records)
+      b.flush();
+  }
+
+  //  Writes ns as microseconds with three decimals, without floating point
+  void put_microseconds(std::ostream& os, boost::uint64_t ns)
+  {
+    const unsigned fraction = static_cast<unsigned>(ns % 1000);
+    os << ns / 1000 << '.' << fraction / 100 << fraction / 10 % 10 << fraction % 10;
+  }
+}  // unnamed namespace
+
+namespace boost
+{
+  namespace timer
+  {
+    //  trace_name  --------------------------------------------------------------------//
+
+    trace_name::trace_name(const std::string& name)
+    {
+      tracer& t = the_tracer();
+      std::lock_guard<std::mutex> lock(t.mutex);
+      t.names.push_back(name);
+      m_id = static_cast<boost::uint32_t>(t.names.size());
+      if (t.active.load())
+        append_name(m_id, name, t.generation.load());
+    }
+
+    //  recording  ---------------------------------------------------------------------//
+
+    BOOST_TIMER_DECL bool start_trace(const std::string& path, std::size_t max_bytes)
+    {
+      tracer& t = the_tracer();
+      std::lock_guard<std::mutex> lock(t.mutex);
+      if (t.active.load())
+      {
+        errno = EBUSY;
+        return false;
+      }
+      if (max_bytes < header_size + sizeof(trace_record))
+      {
+        errno = EINVAL;
+        return false;
+      }
+      max_bytes = header_size
+        + (max_bytes - header_size) / sizeof(trace_record) * sizeof(trace_record);
+      if (!t.file.open(path, max_bytes))
+        return false;
+
+      t.capacity = max_bytes;
+      t.start = current_wall_time();
+      char header[header_size] = {};
+      const boost::uint32_t record_size = sizeof(trace_record);
+      const boost::uint64_t start = static_cast<boost::uint64_t>(t.start);
+      std::memcpy(header, magic, 8);
+      std::memcpy(header + 8, &record_size, 4);
+      std::memcpy(header + 12, &byte_order, 4);
+      std::memcpy(header + 16, &start, 8);
+      t.file.write(0, header, header_size);
+      t.used.store(header_size);
+      t.dropped.store(0);
+
+      const unsigned generation = t.generation.load() + 1;
+      t.generation.store(generation);
+      t.active.store(true);
+      for (std::size_t i = 0; i < t.names.size(); ++i)
+        append_name(static_cast<boost::uint32_t>(i + 1), t.names[i], generation);
+      return true;
+    }
+
+    BOOST_TIMER_DECL void stop_trace()
+    {
+      flush_thread_trace();
+      tracer& t = the_tracer();
+      std::lock_guard<std::mutex> lock(t.mutex);
+      if (!t.active.load())
+        return;
+      t.active.store(false);
+      while (t.writers.load())  // appends that saw the trace active
+        std::this_thread::yield();
+      t.file.close(std::min(t.used.load(), t.capacity));
+    }
+
+    BOOST_TIMER_DECL bool trace_active()
+    {
+      return the_tracer().active.load(std::memory_order_relaxed);
+    }
+
+    BOOST_TIMER_DECL void flush_thread_trace()
+    {
+      this_thread_buffer.flush();
+    }
+
+    BOOST_TIMER_DECL boost::uint64_t trace_dropped()
+    {
+      return the_tracer().dropped.load(std::memory_order_relaxed);
+    }
+
+    BOOST_TIMER_DECL void trace_begin(const trace_name& name)
+    {
+      record(begin_record, name.id());
+    }
+
+    BOOST_TIMER_DECL void trace_end(const trace_name& name)
+    {
+      record(end_record, name.id());
+    }
+
+    BOOST_TIMER_DECL void trace_instant(const trace_name& name)
+    {
+      record(instant_record, name.id());
+    }
+
+    //  conversion  --------------------------------------------------------------------//
+
+    BOOST_TIMER_DECL bool write_chrome_trace(std::istream& in, std::ostream& out)
+    {
+      char header[header_size];
+      boost::uint32_t record_size, order;
+      if (!in.read(header, header_size) || std::memcmp(header, magic, 8) != 0)
+        return false;
+      std::memcpy(&record_size, header + 8, 4);
+      std::memcpy(&order, header + 12, 4);
+      if (record_size != sizeof(trace_record) || order != byte_order)
+        return false;
+
+      //  names may follow the events that use them, so read everything first
+      std::vector<trace_record> records;
+      std::vector<std::string> names;
+      trace_record r;
+      while (in.read(reinterpret_cast<char*>(&r), sizeof(r)))
+      {
+        if (r.kind == name_record)
+        {
+          //  Names are written in the order of their ids, so an id beyond the next
+          //  one, like an id of 0 or an overlong piece, means the file is corrupt.
+          if (r.name == 0 || r.name > names.size() + 1 || r.size > sizeof(r.time))
+            return false;
+          if (r.name > names.size())
+            names.resize(r.name);
+          names[r.name - 1].append(reinterpret_cast<const char*>(&r.time), r.size);
+        }
+        else if (r.kind >= begin_record && r.kind <= instant_record)
+          records.push_back(r);
+        // else the zeros of an unused tail
+      }
+
+      std::ostringstream ss;
+      ss.imbue(std::locale::classic());
+      ss << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+      for (std::size_t i = 0; i < records.size(); ++i)
+      {
+        const trace_record& e = records[i];
+        ss << (i ? ",\n" : "\n") << "{\"name\": ";
+        if (e.name >= 1 && e.name <= names.size())
+          detail::put_json_string(ss, names[e.name - 1]);
+        else
+          ss << '"' << e.name << '"';
+        ss << ", \"ph\": \""
+           << (e.kind == begin_record ? "B" : e.kind == end_record ? "E" : "i")
+           << "\", \"ts\": ";
+        put_microseconds(ss, e.time);
+        ss << ", \"pid\": 1, \"tid\": " << e.thread;
+        if (e.kind == instant_record)
+          ss << ", \"s\": \"t\"";
+        ss << '}';
+      }
+      ss << "\n]}\n";
+      out << ss.str();
+      return true;
+    }
+
+  } // namespace timer
+} // namespace boost
+
+#endif  // !BOOST_TIMER_NO_CXX11_CONCURRENCY
@@ -0,0 +1,168 @@
+//  boost async_sink_test.cpp  ---------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/async_sink.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::parsed_format;
+using boost::timer::async_sink;
+
+namespace
+{
+  //  A stream buffer that takes its time, so that the ring fills
+  class slow_buf : public std::stringbuf
+  {
+  protected:
+    std::streamsize xsputn(const char* s, std::streamsize n)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      return std::stringbuf::xsputn(s, n);
+    }
+  };
+
+  cpu_times make_times(nanosecond_type i)
+  {
+    cpu_times times;
+    times.wall = i * 1000000LL;
+    times.user = i * 500000LL;
+    times.system = 0;
+    return times;
+  }
+
+  void order_test()
+  {
+    cout << "order test..." << endl;
+
+    std::stringstream ss;
+    parsed_format fmt("%w %u\n");
+    string expected;
+    {
+      async_sink sink(ss, 8, async_sink::block_on_overflow);
+      BOOST_TEST_EQ(sink.capacity(), 8u);
+      BOOST_TEST_EQ(&sink.stream(), static_cast<std::ostream*>(&ss));
+      for (int i = 0; i < 1000; ++i)
+      {
+        BOOST_TEST(sink.push(make_times(i), 3, fmt.view()));
+        expected += format(make_times(i), 3, "%w %u\n");
+      }
+      sink.flush();
+      BOOST_TEST_EQ(ss.str(), expected);
+      BOOST_TEST_EQ(sink.written(), 1000u);
+      BOOST_TEST_EQ(sink.dropped(), 0u);
+
+      sink.flush();  // nothing pending
+      BOOST_TEST(sink.push(make_times(1)));  // default format
+      expected += format(make_times(1));
+    }  // destructor writes what remains
+    BOOST_TEST_EQ(ss.str(), expected);
+  }
+
+  void producers_test()
+  {
+    cout << "producers test..." << endl;
+
+    std::stringstream ss;
+    parsed_format fmt("%w\n");
+    const int threads = 4;
+    const int pushes = 20000;
+    {
+      async_sink sink(ss, 64, async_sink::block_on_overflow);
+      std::vector<std::thread> producers;
+      for (int t = 0; t < threads; ++t)
+        producers.push_back(std::thread([&sink, &fmt, t]()
+        {
+          for (int i = 0; i < pushes; ++i)
+            sink.push(make_times(t + 1), 0, fmt.view());
+        }));
+      for (std::size_t t = 0; t < producers.size(); ++t)
+        producers[t].join();
+      sink.flush();
+      BOOST_TEST_EQ(sink.written(), boost::uint64_t(threads * pushes));
+      BOOST_TEST_EQ(sink.dropped(), 0u);
+    }
+    string s = ss.str();
+    BOOST_TEST_EQ(std::count(s.begin(), s.end(), '\n'), threads * pushes);
+    // every record is intact: a few milliseconds to 0 places is "0\n"
+    BOOST_TEST_EQ(std::count(s.begin(), s.end(), '0'), threads * pushes);
+  }
+
+  void drop_test()
+  {
+    cout << "drop test..." << endl;
+
+    slow_buf buf;
+    std::ostream os(&buf);
+    const int pushes = 2000;
+    int accepted = 0;
+    {
+      async_sink sink(os, 4);
+      BOOST_TEST(sink.policy() == async_sink::drop_on_overflow);
+      for (int i = 0; i < pushes; ++i)
+        accepted += sink.push(make_times(i), 0, sink.default_view());
+      sink.flush();
+      BOOST_TEST(sink.dropped() > 0u);
+      BOOST_TEST_EQ(sink.written() + sink.dropped(), boost::uint64_t(pushes));
+      BOOST_TEST_EQ(sink.written(), boost::uint64_t(accepted));
+    }
+    string s = buf.str();
+    BOOST_TEST_EQ(std::count(s.begin(), s.end(), '\n'), accepted);
+  }
+
+  void auto_timer_test()
+  {
+    cout << "auto timer test..." << endl;
+
+    std::stringstream ss;
+    parsed_format fmt("[%w]");
+    {
+      async_sink sink(ss);
+      {
+        boost::timer::auto_cpu_timer t(sink, 2, fmt.view());
+      }
+      {
+        boost::timer::auto_thread_cpu_timer t(sink);
+        t.report();
+        t.stop();
+      }
+      sink.flush();
+      BOOST_TEST_EQ(sink.written(), 2u);
+    }
+    string s = ss.str();
+    cout << "  " << s;
+    BOOST_TEST_EQ(s.substr(0, 2), string("[0"));
+    BOOST_TEST_EQ(s.find(']'), 5u);
+    BOOST_TEST(s.find("wall") != string::npos);
+  }
+}
+
+int cpp_main(int, char *[])
+{
+  cout << "----------  async_sink_test  ----------\n";
+
+  order_test();
+  producers_test();
+  drop_test();
+  auto_timer_test();
+
+  return ::boost::report_errors();
+}
@@ -0,0 +1,285 @@
+//  boost baseline_test.cpp  -----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/baseline.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::baseline;
+using boost::timer::baseline_case;
+using boost::timer::case_comparison;
+using boost::timer::compare_options;
+using boost::timer::mann_whitney_p;
+
+namespace
+{
+  volatile unsigned sink;
+
+  void spin_100()
+  {
+    unsigned x = sink;
+    for (int i = 0; i < 100; ++i)
+      x = x * 1664525u + 1013904223u;
+    sink = x;
+  }
+
+  cpu_times make_times(nanosecond_type wall, nanosecond_type user, nanosecond_type system)
+  {
+    cpu_times t;
+    t.wall = wall;
+    t.user = user;
+    t.system = system;
+    return t;
+  }
+
+  //  A case of n samples of 1000 iterations taking about per_iteration ns each, with
+  //  a deterministic spread of +/- 2%.
+  baseline_case make_case(const string& name, double per_iteration, int n, int phase)
+  {
+    baseline_case c;
+    c.name = name;
+    c.iterations = 1000;
+    c.overhead = 0.0;
+    for (int i = 0; i < n; ++i)
+    {
+      const double jitter = 0.02 * std::sin(1.7 * (i + phase));
+      const nanosecond_type wall
+        = static_cast<nanosecond_type>(per_iteration * (1.0 + jitter) * 1000);
+      c.samples.push_back(make_times(wall, wall * 9 / 10, wall / 10));
+    }
+    return c;
+  }
+
+  void mann_whitney_test()
+  {
+    cout << "Mann-Whitney test..." << endl;
+
+    std::vector<double> a, b;
+    BOOST_TEST_EQ(mann_whitney_p(a, b), 1.0);
+
+    //  Completely separated samples of 5: the exact two-sided p-value is 2 / C(10, 5).
+    double lo[] = { 1, 2, 3, 4, 5 };
+    double hi[] = { 6, 7, 8, 9, 10 };
+    a.assign(lo, lo + 5);
+    b.assign(hi, hi + 5);
+    BOOST_TEST(std::fabs(mann_whitney_p(a, b) - 2.0 / 252) < 1e-12);
+    BOOST_TEST(std::fabs(mann_whitney_p(b, a) - 2.0 / 252) < 1e-12);
+
+    //  Interleaved samples are not significantly different.
+    double odd[] = { 1, 3, 5, 7, 9 };
+    double even[] = { 2, 4, 6, 8, 10 };
+    a.assign(odd, odd + 5);
+    b.assign(even, even + 5);
+    BOOST_TEST(mann_whitney_p(a, b) > 0.5);
+
+    //  One value of a above one of b: U = 1, P(U <= 1) = 2 / 252.
+    double one_lo[] = { 1, 2, 3, 4, 6 };
+    double one_hi[] = { 5, 7, 8, 9, 10 };
+    a.assign(one_lo, one_lo + 5);
+    b.assign(one_hi, one_hi + 5);
+    BOOST_TEST(std::fabs(mann_whitney_p(a, b) - 4.0 / 252) < 1e-12);
+
+    //  With ties, the normal approximation; all values tied is no evidence at all.
+    std::vector<double> same(8, 3.0);
+    BOOST_TEST_EQ(mann_whitney_p(same, same), 1.0);
+    double tied_lo[] = { 1, 1, 2, 2, 3, 3, 4, 4 };
+    double tied_hi[] = { 5, 5, 6, 6, 7, 7, 8, 8 };
+    a.assign(tied_lo, tied_lo + 8);
+    b.assign(tied_hi, tied_hi + 8);
+    const double p = mann_whitney_p(a, b);
+    cout << "  tied p = " << p << endl;
+    BOOST_TEST(p < 0.01);
+    BOOST_TEST(p > 0.0);
+
+    //  Large samples use the normal approximation, which agrees with the exact test.
+    a.clear();
+    b.clear();
+    for (int i = 0; i < 60; ++i)
+    {
+      a.push_back(2 * i);
+      b.push_back(2 * i + 1);
+    }
+    BOOST_TEST(mann_whitney_p(a, b) > 0.8);
+
+    cout << "  Mann-Whitney test complete" << endl;
+  }
+
+  void file_test()
+  {
+    cout << "file test..." << endl;
+
+    baseline b;
+    b.metadata = boost::timer::current_metadata("commit 1234\nabc");
+    BOOST_TEST(!b.metadata.wall_clock.empty());
+    BOOST_TEST(!b.metadata.cpu_clock.empty());
+    BOOST_TEST(b.metadata.created > 0);
+    b.cases.push_back(make_case("a case, with spaces", 100.0, 4, 0));
+    b.cases.push_back(make_case("empty", 100.0, 0, 0));
+    b.cases[0].overhead = 12.25;
+
+    std::stringstream ss;
+    boost::timer::write_baseline(ss, b);
+    cout << ss.str().substr(0, ss.str().find("case"));
+    BOOST_TEST_EQ(ss.str().find("boost_timer_baseline 1\n"), 0u);
+
+    baseline r;
+    BOOST_TEST(boost::timer::read_baseline(ss, r));
+    BOOST_TEST_EQ(r.metadata.host, b.metadata.host);
+    BOOST_TEST_EQ(r.metadata.label, string("commit 1234 abc"));  // one line
+    BOOST_TEST_EQ(r.metadata.created, b.metadata.created);
+    BOOST_TEST_EQ(r.metadata.wall_clock, b.metadata.wall_clock);
+    BOOST_TEST_EQ(r.metadata.wall_clock_steady, b.metadata.wall_clock_steady);
+    BOOST_TEST_EQ(r.metadata.tsc_invariant, b.metadata.tsc_invariant);
+    BOOST_TEST_EQ(r.metadata.tsc_frequency, b.metadata.tsc_frequency);
+    BOOST_TEST_EQ(r.metadata.cpu_clock, b.metadata.cpu_clock);
+    BOOST_TEST_EQ(r.metadata.cpu_clock_resolution, b.metadata.cpu_clock_resolution);
+    BOOST_TEST_EQ(r.metadata.timer_overhead.wall, b.metadata.timer_overhead.wall);
+    BOOST_TEST_EQ(r.cases.size(), 2u);
+    if (r.cases.size() == 2)
+    {
+      BOOST_TEST_EQ(r.cases[0].name, b.cases[0].name);
+      BOOST_TEST_EQ(r.cases[0].iterations, 1000u);
+      BOOST_TEST_EQ(r.cases[0].overhead, 12.25);
+      BOOST_TEST_EQ(r.cases[0].samples.size(), 4u);
+      for (std::size_t i = 0; i < r.cases[0].samples.size(); ++i)
+      {
+        BOOST_TEST_EQ(r.cases[0].samples[i].wall, b.cases[0].samples[i].wall);
+        BOOST_TEST_EQ(r.cases[0].samples[i].user, b.cases[0].samples[i].user);
+        BOOST_TEST_EQ(r.cases[0].samples[i].system, b.cases[0].samples[i].system);
+      }
+      BOOST_TEST(r.cases[1].samples.empty());
+    }
+
+    //  unknown keys and lines are ignored
+    std::istringstream future("boost_timer_baseline 1\nmeta cores 8\nfuture stuff\n"
+      "case 10 0 x\nsample 1 2 3\n\n");
+    BOOST_TEST(boost::timer::read_baseline(future, r));
+    BOOST_TEST_EQ(r.cases.size(), 1u);
+
+    std::istringstream bad_version("boost_timer_baseline 2\n");
+    BOOST_TEST(!boost::timer::read_baseline(bad_version, r));
+    std::istringstream not_baseline("name,iterations,samples\n");
+    BOOST_TEST(!boost::timer::read_baseline(not_baseline, r));
+    std::istringstream orphan("boost_timer_baseline 1\nsample 1 2 3\n");
+    BOOST_TEST(!boost::timer::read_baseline(orphan, r));
+    std::istringstream malformed("boost_timer_baseline 1\ncase 10 0 x\nsample 1 two 3\n");
+    BOOST_TEST(!boost::timer::read_baseline(malformed, r));
+
+    cout << "  file test complete" << endl;
+  }
+
+  void compare_test()
+  {
+    cout << "compare test..." << endl;
+
+    baseline base, candidate;
+    base.cases.push_back(make_case("same", 100.0, 10, 0));
+    base.cases.push_back(make_case("slower", 100.0, 10, 0));
+    base.cases.push_back(make_case("faster", 100.0, 10, 0));
+    base.cases.push_back(make_case("slightly", 100.0, 10, 0));
+    base.cases.push_back(make_case("only in base", 100.0, 10, 0));
+    candidate.cases.push_back(make_case("faster", 90.0, 10, 3));
+    candidate.cases.push_back(make_case("same", 100.0, 10, 5));
+    candidate.cases.push_back(make_case("slower", 110.0, 10, 3));
+    candidate.cases.push_back(make_case("slightly", 100.5, 10, 3));
+    candidate.cases.push_back(make_case("only in candidate", 100.0, 10, 0));
+
+    compare_options options;
+    options.threshold = 0.02;
+    std::vector<case_comparison> r = boost::timer::compare(base, candidate, options);
+    BOOST_TEST_EQ(r.size(), 4u);
+    if (r.size() != 4)
+      return;
+    for (std::size_t i = 0; i < r.size(); ++i)
+      cout << "  " << r[i].name << ": ratio " << r[i].ratio << " [" << r[i].ratio_low
+           << ", " << r[i].ratio_high << "], p " << r[i].p_value << endl;
+
+    BOOST_TEST_EQ(r[0].name, string("faster"));  // in the candidate's order
+    BOOST_TEST_EQ(r[0].verdict, boost::timer::improved);
+    BOOST_TEST(std::fabs(r[0].ratio - 0.9) < 0.02);
+    BOOST_TEST(r[0].ratio_high < 1.0);
+
+    BOOST_TEST_EQ(r[1].name, string("same"));
+    BOOST_TEST_EQ(r[1].verdict, boost::timer::unchanged);
+    BOOST_TEST(r[1].p_value > options.alpha);
+    BOOST_TEST(r[1].ratio_low <= 1.0 && r[1].ratio_high >= 1.0);
+
+    BOOST_TEST_EQ(r[2].verdict, boost::timer::regressed);
+    BOOST_TEST(std::fabs(r[2].ratio - 1.1) < 0.02);
+    BOOST_TEST(r[2].ratio_low > 1.0);
+    BOOST_TEST(r[2].p_value < 0.001);
+    BOOST_TEST(r[2].baseline_median > 95.0 && r[2].baseline_median < 105.0);
+
+    BOOST_TEST_EQ(r[3].verdict, boost::timer::unchanged);  // within the threshold
+
+    //  repeatable
+    std::vector<case_comparison> again = boost::timer::compare(base, candidate, options);
+    BOOST_TEST_EQ(again[2].ratio_low, r[2].ratio_low);
+
+    //  CPU time, and the overhead subtracted from wall time
+    options.cpu = true;
+    r = boost::timer::compare(base, candidate, options);
+    BOOST_TEST(std::fabs(r[2].baseline_median - 100.0) < 3.0);  // user + system
+    candidate.cases[2].overhead = 10000.0;  // 10 ns per iteration
+    options.cpu = false;
+    r = boost::timer::compare(base, candidate, options);
+    BOOST_TEST(std::fabs(r[2].ratio - 1.0) < 0.02);
+
+    cout << "  compare test complete" << endl;
+  }
+
+  void benchmark_test()
+  {
+    cout << "benchmark test..." << endl;
+
+    boost::timer::benchmark_options options;
+    options.warmup_time = 2000000LL;
+    options.sample_time = 1000000LL;
+    options.samples = 5;
+    boost::timer::benchmark bm(options);
+    bm.add("spin_100", spin_100);
+    bm.run();
+
+    const baseline b = boost::timer::make_baseline(bm.results(), "test");
+    BOOST_TEST_EQ(b.metadata.label, string("test"));
+    BOOST_TEST_EQ(b.cases.size(), 1u);
+    BOOST_TEST_EQ(b.cases[0].samples.size(), 5u);
+    BOOST_TEST_EQ(b.cases[0].iterations, bm.results()[0].iterations);
+
+    const std::vector<case_comparison> r = boost::timer::compare(b, b);
+    BOOST_TEST_EQ(r.size(), 1u);
+    BOOST_TEST_EQ(r[0].ratio, 1.0);
+    BOOST_TEST_EQ(r[0].verdict, boost::timer::unchanged);
+
+    cout << "  benchmark test complete" << endl;
+  }
+
+} // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "---------------  baseline_test  ---------------\n";
+
+  mann_whitney_test();
+  file_test();
+  compare_test();
+  benchmark_test();
+
+  return ::boost::report_errors();
+}
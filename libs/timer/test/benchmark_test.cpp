@@ -0,0 +1,189 @@
+//  boost benchmark_test.cpp  ----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/benchmark.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::sample_statistics;
+using boost::timer::summarize;
+using boost::timer::benchmark;
+using boost::timer::benchmark_options;
+using boost::timer::benchmark_result;
+
+namespace
+{
+  volatile unsigned sink;
+
+  void spin_100()
+  {
+    unsigned x = sink;
+    for (int i = 0; i < 100; ++i)
+      x = x * 1664525u + 1013904223u;
+    sink = x;
+  }
+
+  struct counter
+  {
+    long* calls;
+    explicit counter(long* c) : calls(c) {}
+    void operator()() const { ++*calls; spin_100(); }
+  };
+
+  void summarize_test()
+  {
+    cout << "summarize test..." << endl;
+
+    std::vector<double> v;
+    sample_statistics s = summarize(v, 3.5);
+    BOOST_TEST_EQ(s.count, 0u);
+    BOOST_TEST_EQ(s.mean, 0.0);
+
+    double a[] = { 5, 3, 1, 4, 2 };
+    v.assign(a, a + 5);
+    s = summarize(v);
+    BOOST_TEST_EQ(s.count, 5u);
+    BOOST_TEST_EQ(s.rejected, 0u);
+    BOOST_TEST_EQ(s.mean, 3.0);
+    BOOST_TEST_EQ(s.median, 3.0);
+    BOOST_TEST_EQ(s.min, 1.0);
+    BOOST_TEST_EQ(s.max, 5.0);
+    BOOST_TEST(std::fabs(s.stddev - std::sqrt(2.5)) < 1e-12);
+    BOOST_TEST_EQ(v[0], 1.0);  // sorted
+
+    // even count: median is the average of the middle two
+    double b[] = { 4, 1, 3, 2 };
+    v.assign(b, b + 4);
+    BOOST_TEST_EQ(summarize(v).median, 2.5);
+
+    // outliers at both ends are rejected
+    double c[] = { 10, 11, 9, 10, 10.5, 9.5, 10, 1000, 0.001 };
+    v.assign(c, c + 9);
+    s = summarize(v, 3.5);
+    BOOST_TEST_EQ(s.count, 7u);
+    BOOST_TEST_EQ(s.rejected, 2u);
+    BOOST_TEST_EQ(s.min, 9.0);
+    BOOST_TEST_EQ(s.max, 11.0);
+    BOOST_TEST_EQ(v.size(), 7u);
+    BOOST_TEST_EQ(s.median, 10.0);
+
+    // a threshold of 0 rejects nothing
+    v.assign(c, c + 9);
+    BOOST_TEST_EQ(summarize(v, 0.0).rejected, 0u);
+
+    // all equal but one: a MAD of 0 rejects nothing
+    double d[] = { 7, 7, 7, 7, 100 };
+    v.assign(d, d + 5);
+    BOOST_TEST_EQ(summarize(v, 3.5).rejected, 0u);
+  }
+
+  void measure_test()
+  {
+    cout << "measure test..." << endl;
+
+    benchmark_options options;
+    options.warmup_time = 5000000LL;
+    options.sample_time = 2000000LL;
+    options.samples = 5;
+
+    long calls = 0;
+    benchmark_result r = benchmark::measure("spin", counter(&calls), options);
+    cout << "  " << r.iterations << " iterations, median " << r.wall.median
+         << "ns, overhead " << r.overhead << "ns" << endl;
+
+    BOOST_TEST_EQ(r.name, string("spin"));
+    BOOST_TEST(r.iterations > 1u);
+    BOOST_TEST_EQ(r.wall.count + r.wall.rejected, 5u);
+    BOOST_TEST(calls >= static_cast<long>(5 * r.iterations));
+    BOOST_TEST(r.total.wall >= 5 * options.sample_time / 2);
+    BOOST_TEST(r.wall.min <= r.wall.median);
+    BOOST_TEST(r.wall.median <= r.wall.max);
+    BOOST_TEST(r.wall.min > 0.0);
+    BOOST_TEST(r.wall.stddev >= 0.0);
+    BOOST_TEST(r.overhead >= 0.0);
+    // per iteration times are consistent with the total
+    BOOST_TEST(r.wall.mean * r.iterations * r.wall.count
+      <= static_cast<double>(r.total.wall) * 1.01);
+    BOOST_TEST_EQ(r.samples.size(), 5u);
+    nanosecond_type sampled = 0;
+    for (std::size_t i = 0; i < r.samples.size(); ++i)
+      sampled += r.samples[i].wall;
+    BOOST_TEST_EQ(sampled, r.total.wall);
+
+    options.subtract_overhead = false;
+    r = benchmark::measure("spin", counter(&calls), options);
+    BOOST_TEST_EQ(r.overhead, 0.0);
+  }
+
+  void output_test()
+  {
+    cout << "output test..." << endl;
+
+    benchmark_options options;
+    options.warmup_time = 1000000LL;
+    options.sample_time = 1000000LL;
+    options.samples = 3;
+    benchmark b(options);
+    b.add("spin_100", spin_100);
+    b.add("quote\" and, comma", spin_100);
+    b.run();
+    BOOST_TEST_EQ(b.results().size(), 2u);
+    b.run();  // runs nothing new
+    BOOST_TEST_EQ(b.results().size(), 2u);
+
+    std::ostringstream human_stream;
+    b.report(human_stream);
+    const string human = human_stream.str();
+    cout << human;
+    BOOST_TEST(human.find("spin_100: ") == 0);
+    BOOST_TEST(human.find("s wall, ") != string::npos);
+    BOOST_TEST_EQ(std::count(human.begin(), human.end(), '\n'), 2);
+
+    std::ostringstream json_stream;
+    b.write_json(json_stream);
+    const string json = json_stream.str();
+    cout << json;
+    BOOST_TEST(json.find("\"name\": \"spin_100\"") != string::npos);
+    BOOST_TEST(json.find("\"name\": \"quote\\\" and, comma\"") != string::npos);
+    BOOST_TEST(json.find("\"wall_ns\": {\"mean\": ") != string::npos);
+    BOOST_TEST_EQ(std::count(json.begin(), json.end(), '{'),
+      std::count(json.begin(), json.end(), '}'));
+
+    std::ostringstream csv_stream;
+    b.write_csv(csv_stream);
+    const string csv = csv_stream.str();
+    cout << csv;
+    BOOST_TEST(csv.find("name,iterations,samples,") == 0);
+    BOOST_TEST(csv.find("\nspin_100,") != string::npos);
+    BOOST_TEST(csv.find("\n\"quote\"\" and, comma\",") != string::npos);
+    BOOST_TEST_EQ(std::count(csv.begin(), csv.end(), '\n'), 3);
+  }
+}
+
+int cpp_main(int, char *[])
+{
+  cout << "----------  benchmark_test  ----------\n";
+
+  summarize_test();
+  measure_test();
+  output_test();
+
+  return ::boost::report_errors();
+}
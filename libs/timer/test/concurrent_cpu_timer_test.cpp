@@ -0,0 +1,186 @@
+//  boost concurrent_cpu_timer_test.cpp  -----------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/concurrent_cpu_timer.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::format_extras;
+using boost::timer::concurrency_stats;
+using boost::timer::concurrent_cpu_timer;
+
+namespace
+{
+  void format_test()
+  {
+    cout << "format test..." << endl;
+
+    cpu_times times;
+    times.wall = 2000000000LL;
+    times.user = 3000000000LL;
+    times.system = 1000000000LL;
+    concurrency_stats stats;
+    stats.segments = 40;
+    stats.threads = 4;
+    stats.busy = 7500000000LL;
+
+    format_extras extras;
+    extras.concurrency = &stats;
+    BOOST_TEST_EQ(boost::timer::format(times, extras, 1, "%n %N %Ls %p% %E%"),
+      "40 4 7.5s 200.0% 50.0%");
+    BOOST_TEST_EQ(boost::timer::format(times, 1, "%n|%N|%L|%E"), "%n|%N|%L|%E");
+    stats.threads = 0;
+    BOOST_TEST_EQ(boost::timer::format(times, extras, 1, "%E"), "n/a");
+
+    cout << "  format test complete" << endl;
+  }
+
+  //  spins for at least ms milliseconds of the calling thread's CPU time
+  void spin(int ms)
+  {
+    boost::timer::thread_cpu_timer t;
+    volatile unsigned long x = 0;
+    while (t.elapsed().user + t.elapsed().system < ms * 1000000LL)
+      for (int i = 0; i < 10000; ++i)
+        x = x + i;
+  }
+
+  void threads_test()
+  {
+    cout << "threads test..." << endl;
+
+    const int thread_count = 4;
+    const int segments = 5;
+    concurrent_cpu_timer timer;
+    boost::timer::cpu_timer outer;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; ++i)
+      threads.push_back(std::thread([&timer]()
+      {
+        for (int j = 0; j < segments; ++j)
+        {
+          concurrent_cpu_timer::segment s(timer);
+          spin(4);
+        }
+      }));
+    for (std::size_t i = 0; i < threads.size(); ++i)
+      threads[i].join();
+    const cpu_times outer_times = outer.elapsed();
+
+    cout << timer.format(3);
+    cpu_times times = timer.elapsed();
+    concurrency_stats stats = timer.elapsed_stats();
+    BOOST_TEST_EQ(stats.segments, thread_count * segments);
+    BOOST_TEST_EQ(stats.threads, thread_count);
+    BOOST_TEST(times.user + times.system >= thread_count * segments * 4000000LL);
+    BOOST_TEST(times.wall > 0);
+    BOOST_TEST(times.wall <= outer_times.wall);
+    BOOST_TEST(stats.busy >= times.wall);  // the longest thread's work at least
+    const double efficiency = timer.parallel_efficiency();
+    BOOST_TEST(efficiency > 0.0);
+    BOOST_TEST(efficiency <= 1.05);
+    cout << "  hardware threads " << std::thread::hardware_concurrency()
+         << ", efficiency " << efficiency << endl;
+
+    cout << "  threads test complete" << endl;
+  }
+
+  //  more threads than shards: those left over share shards, but each thread is
+  //  still counted once, and efficiency stays within bounds
+  void many_threads_test()
+  {
+    cout << "many threads test..." << endl;
+
+    const int thread_count = static_cast<int>(concurrent_cpu_timer::shard_count) + 36;
+    const int segments = 3;
+    concurrent_cpu_timer timer;
+
+    for (int pass = 0; pass < 2; ++pass)  // start() discards the threads counted
+    {
+      timer.start();
+      std::vector<std::thread> threads;
+      for (int i = 0; i < thread_count; ++i)
+        threads.push_back(std::thread([&timer]()
+        {
+          for (int j = 0; j < segments; ++j)
+          {
+            concurrent_cpu_timer::segment s(timer);
+            spin(1);
+          }
+        }));
+      for (std::size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+
+      concurrency_stats stats = timer.elapsed_stats();
+      BOOST_TEST_EQ(stats.segments, thread_count * segments);
+      BOOST_TEST_EQ(stats.threads, thread_count);
+      BOOST_TEST(timer.parallel_efficiency() <= 1.05);
+    }
+    cout << timer.format(3);
+
+    cout << "  many threads test complete" << endl;
+  }
+
+  void stop_test()
+  {
+    cout << "stop test..." << endl;
+
+    concurrent_cpu_timer timer;
+    BOOST_TEST(!timer.is_stopped());
+    BOOST_TEST_EQ(timer.elapsed().wall, 0);
+    BOOST_TEST_EQ(timer.parallel_efficiency(), 0.0);
+    BOOST_TEST_EQ(timer.format(3, "%E"), "n/a");
+
+    {
+      concurrent_cpu_timer::segment s(timer);
+      spin(2);
+      s.close();
+      s.close();  // no effect
+    }
+    BOOST_TEST_EQ(timer.elapsed_stats().segments, 1);
+
+    concurrent_cpu_timer::segment late(timer);
+    timer.stop();
+    const cpu_times stopped = timer.elapsed();
+    late.close();  // not added, since stopped
+    BOOST_TEST(timer.is_stopped());
+    BOOST_TEST_EQ(timer.elapsed_stats().segments, 1);
+    BOOST_TEST_EQ(timer.elapsed().wall, stopped.wall);
+    BOOST_TEST_EQ(timer.elapsed().user, stopped.user);
+
+    timer.start();
+    BOOST_TEST(!timer.is_stopped());
+    BOOST_TEST_EQ(timer.elapsed_stats().segments, 0);
+
+    cout << "  stop test complete" << endl;
+  }
+
+} // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "----------  concurrent_cpu_timer_test  ----------\n";
+
+  format_test();
+  threads_test();
+  many_threads_test();
+  stop_test();
+
+  return ::boost::report_errors();
+}
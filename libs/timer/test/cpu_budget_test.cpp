@@ -0,0 +1,193 @@
+//  boost cpu_budget_test.cpp  ---------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/cpu_budget.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::cpu_budget;
+using boost::timer::wall_budget;
+
+namespace
+{
+  const nanosecond_type ms = 1000000LL;
+  const nanosecond_type us = 1000LL;
+
+  //  The tolerance for preemption and clock granularity in the overshoot bounds.
+  const nanosecond_type tolerance = 2 * ms;
+
+  //  spins for at least n nanoseconds of wall-clock time
+  void spin(nanosecond_type n)
+  {
+    const nanosecond_type end = boost::timer::current_wall_time() + n;
+    volatile unsigned long x = 0;
+    while (boost::timer::current_wall_time() < end)
+      for (int i = 0; i < 100; ++i)
+        x = x + i;
+  }
+
+  //  Calls check() after each tick of work until the budget is exceeded; returns the
+  //  number of ticks, and the longest tick.
+  template <class Budget>
+  boost::uint64_t run(Budget& budget, nanosecond_type tick, nanosecond_type& longest)
+  {
+    boost::uint64_t ticks = 0;
+    longest = 0;
+    for (;;)
+    {
+      const nanosecond_type begin = boost::timer::current_wall_time();
+      spin(tick);
+      const nanosecond_type cost = boost::timer::current_wall_time() - begin;
+      if (cost > longest)
+        longest = cost;
+      ++ticks;
+      if (budget.check())
+        return ticks;
+    }
+  }
+
+  void overshoot_test()
+  {
+    cout << "overshoot test..." << endl;
+
+    //  With calls of even cost, the budget is found exceeded within a call's cost.
+    wall_budget b(50 * ms);
+    nanosecond_type longest;
+    const boost::uint64_t ticks = run(b, 100 * us, longest);
+    const nanosecond_type overshoot = b.elapsed().wall - 50 * ms;
+    cout << "  " << ticks << " calls, " << b.polls() << " polls, overshoot "
+         << overshoot / us << " us, longest call " << longest / us << " us" << endl;
+    BOOST_TEST(b.exceeded());
+    BOOST_TEST(overshoot >= 0);
+    BOOST_TEST(overshoot <= longest + tolerance);
+    BOOST_TEST(b.polls() * 4 < ticks);  // amortized
+
+    BOOST_TEST(b.check());  // stays exceeded
+    BOOST_TEST(b.poll());
+
+    cpu_budget c(30 * ms);
+    run(c, 100 * us, longest);
+    const cpu_times used = c.elapsed();
+    const nanosecond_type cpu_overshoot = used.user + used.system - 30 * ms;
+    cout << "  CPU overshoot " << cpu_overshoot / us << " us, " << c.polls()
+         << " polls" << endl;
+    BOOST_TEST(c.exceeded());
+    BOOST_TEST(cpu_overshoot >= 0);
+    BOOST_TEST(cpu_overshoot <= longest + tolerance);
+
+    cout << "  overshoot test complete" << endl;
+  }
+
+  void stride_test()
+  {
+    cout << "stride test..." << endl;
+
+    wall_budget b(20 * ms);
+    BOOST_TEST_EQ(b.stride(), 1u);
+    BOOST_TEST_EQ(b.max_stride(), wall_budget::default_max_stride);
+    BOOST_TEST_EQ(b.wall_limit(), 20 * ms);  // a wall_budget's limit is of wall time
+    BOOST_TEST_EQ(b.cpu_limit(), wall_budget::unlimited);
+    cpu_budget c(20 * ms, 30 * ms);
+    BOOST_TEST_EQ(c.cpu_limit(), 20 * ms);
+    BOOST_TEST_EQ(c.wall_limit(), 30 * ms);
+    b.set_max_stride(1);  // every check() polls
+    nanosecond_type longest;
+    const boost::uint64_t ticks = run(b, 200 * us, longest);
+    BOOST_TEST_EQ(b.polls(), ticks);
+    BOOST_TEST_EQ(b.stride(), 1u);
+
+    b.set_max_stride(0);
+    BOOST_TEST_EQ(b.max_stride(), 1u);
+
+    b.set_max_stride(4);  // a fixed stride: within four calls
+    b.start();
+    BOOST_TEST(!b.exceeded());
+    run(b, 200 * us, longest);
+    BOOST_TEST(b.stride() <= 4u);
+    BOOST_TEST(b.elapsed().wall - 20 * ms <= 4 * longest + tolerance);
+
+    wall_budget unlimited(wall_budget::unlimited);
+    for (int i = 0; i < 100000; ++i)
+      BOOST_TEST(!unlimited.check());
+    BOOST_TEST(unlimited.polls() < 40u);  // the stride doubles
+
+    cout << "  stride test complete" << endl;
+  }
+
+  std::vector<std::string> calls;
+
+  void parent_called(wall_budget&)  { calls.push_back("parent"); }
+  void child_called(wall_budget&)   { calls.push_back("child"); }
+
+  void nested_test()
+  {
+    cout << "nested test..." << endl;
+
+    //  The child is charged against its parent's remaining 30 ms.
+    wall_budget parent(40 * ms, wall_budget::unlimited, &parent_called);
+    spin(10 * ms);
+    wall_budget child(parent, 1000 * ms, wall_budget::unlimited, &child_called);
+    BOOST_TEST_EQ(child.parent(), &parent);
+    nanosecond_type longest;
+    run(child, 100 * us, longest);
+    BOOST_TEST(child.exceeded());
+    BOOST_TEST(parent.exceeded());
+    BOOST_TEST(parent.check());
+    const nanosecond_type overshoot = parent.elapsed().wall - 40 * ms;
+    cout << "  parent overshoot " << overshoot / us << " us" << endl;
+    BOOST_TEST(overshoot <= longest + tolerance);
+    BOOST_TEST_EQ(calls.size(), 2u);
+    if (calls.size() == 2)
+    {
+      BOOST_TEST_EQ(calls[0], "parent");  // outermost first
+      BOOST_TEST_EQ(calls[1], "child");
+    }
+    child.poll();
+    BOOST_TEST_EQ(calls.size(), 2u);  // once each
+
+    //  A child's own limit leaves its parent within budget.
+    calls.clear();
+    parent.start();
+    wall_budget small(parent, 10 * ms, wall_budget::unlimited, &child_called);
+    run(small, 100 * us, longest);
+    BOOST_TEST(small.exceeded());
+    BOOST_TEST(!parent.exceeded());
+    BOOST_TEST_EQ(calls.size(), 1u);
+
+    //  A grandchild sees its grandparent's limit.
+    parent.start();
+    wall_budget middle(parent, 1000 * ms);
+    wall_budget inner(middle, 1000 * ms);
+    run(inner, 100 * us, longest);
+    BOOST_TEST(parent.exceeded());
+    BOOST_TEST(middle.exceeded());
+    BOOST_TEST(parent.elapsed().wall - 40 * ms <= longest + tolerance);
+
+    cout << "  nested test complete" << endl;
+  }
+
+} // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "---------------  cpu_budget_test  ---------------\n";
+
+  overshoot_test();
+  stride_test();
+  nested_test();
+
+  return ::boost::report_errors();
+}
@@ -0,0 +1,206 @@
+//  boost cpu_sampler_test.cpp  --------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/cpu_sampler.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+# include <unistd.h>
+#endif
+
+using std::string;
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::cpu_sample;
+using boost::timer::cpu_sampler;
+using boost::timer::sampled_thread;
+
+namespace
+{
+  //  spins for at least ms milliseconds of wall-clock time
+  void spin(int ms)
+  {
+    boost::timer::wall_timer t;
+    volatile unsigned long x = 0;
+    while (t.elapsed().wall < ms * 1000000LL)
+      for (int i = 0; i < 10000; ++i)
+        x = x + i;
+  }
+
+  void construction_test()
+  {
+    cout << "construction test..." << endl;
+
+    bool thrown = false;
+    try { cpu_sampler s(0); }
+    catch (const std::invalid_argument&) { thrown = true; }
+    BOOST_TEST(thrown);
+
+    cpu_sampler s(5, 8);
+    BOOST_TEST_EQ(s.interval_ms(), 5u);
+    BOOST_TEST_EQ(s.capacity(), 8u);
+    BOOST_TEST_EQ(s.max_threads(), 0u);
+    BOOST_TEST(!s.has_threads());
+    BOOST_TEST(!s.is_stopped());
+    s.stop();
+    BOOST_TEST(s.is_stopped());
+    s.stop();  // no effect
+
+    cout << "  construction test complete" << endl;
+  }
+
+  void timeline_test()
+  {
+    cout << "timeline test..." << endl;
+
+    cpu_sampler s(10, 8);
+    std::vector<cpu_sample> samples;
+    for (int i = 0; i < 40; ++i)  // queries while sampling
+    {
+      spin(5);
+      s.snapshot(samples);
+      BOOST_TEST(samples.size() <= 8u);
+      for (std::size_t j = 1; j < samples.size(); ++j)
+        BOOST_TEST_EQ(samples[j].sequence, samples[j-1].sequence + 1);
+    }
+    s.stop();
+    const boost::uint64_t taken = s.samples_taken();
+    cout << "  " << taken << " samples taken" << endl;
+    BOOST_TEST(taken >= 10);  // 20 intervals, allowing for a loaded machine
+
+    s.snapshot(samples);
+    BOOST_TEST_EQ(samples.size(), 8u);  // the ring wrapped
+    nanosecond_type cpu = 0;
+    for (std::size_t i = 0; i < samples.size(); ++i)
+    {
+      BOOST_TEST_EQ(samples[i].sequence, taken - samples.size() + i);
+      BOOST_TEST(samples[i].times.wall > 0);
+      if (i > 0)
+        BOOST_TEST_EQ(samples[i].start,
+          samples[i-1].start + samples[i-1].times.wall);
+      cpu += samples[i].times.user + samples[i].times.system;
+      cout << boost::timer::format(samples[i].times, 3, "  %ws wall, %ts CPU (%p%)\n");
+    }
+    BOOST_TEST(cpu > 0);
+
+    std::vector<cpu_sample> again;
+    s.snapshot(again);  // stopped, so unchanged
+    BOOST_TEST_EQ(again.size(), samples.size());
+    BOOST_TEST_EQ(again.back().sequence, samples.back().sequence);
+
+    cout << "  timeline test complete" << endl;
+  }
+
+  void threads_test()
+  {
+    cout << "threads test..." << endl;
+
+    cpu_sampler s(10, 64, 8);
+#if defined(__linux__)
+    BOOST_TEST(s.has_threads());
+#endif
+    if (!s.has_threads())
+    {
+      cout << "  threads not sampled on this platform; skipped" << endl;
+      return;
+    }
+
+    std::thread worker([] { spin(100); });
+    worker.join();
+    spin(50);
+    s.stop();
+
+    std::vector<cpu_sample> samples;
+    std::vector<sampled_thread> threads;
+    std::vector<cpu_times> thread_times;
+    s.snapshot(samples, threads, thread_times);
+    BOOST_TEST(!samples.empty());
+    BOOST_TEST_EQ(thread_times.size(), samples.size() * threads.size());
+    BOOST_TEST(threads.size() >= 3);  // main, worker, and sampler
+    BOOST_TEST_EQ(s.untracked_threads(), 0u);
+
+    const long main_id = ::getpid();
+    nanosecond_type main_cpu = 0, all_cpu = 0;
+    for (std::size_t j = 0; j < threads.size(); ++j)
+    {
+      nanosecond_type cpu = 0;
+      for (std::size_t i = 0; i < samples.size(); ++i)
+      {
+        const cpu_times& t = thread_times[i * threads.size() + j];
+        BOOST_TEST_EQ(t.wall, samples[i].times.wall);
+        cpu += t.user + t.system;
+      }
+      cout << "  thread " << threads[j].id << " (" << threads[j].name << "): "
+           << cpu / 1000000 << " ms CPU" << endl;
+      if (threads[j].id == main_id)
+        main_cpu = cpu;
+      all_cpu += cpu;
+    }
+    BOOST_TEST(main_cpu > 0);
+    BOOST_TEST(all_cpu >= main_cpu);
+
+    std::ostringstream csv;
+    s.write_csv(csv);
+    const string text = csv.str();
+    cout << text.substr(0, text.find('\n') + 1);
+    const string header("sequence,start_ns,wall_ns,user_ns,system_ns,cpu_percent,");
+    BOOST_TEST_EQ(text.compare(0, header.size(), header), 0);
+    std::size_t lines = 0;
+    for (std::size_t i = 0; i < text.size(); ++i)
+      if (text[i] == '\n')
+        ++lines;
+    BOOST_TEST_EQ(lines, samples.size() + 1);
+    BOOST_TEST(text.find("_percent,thread_") != string::npos);
+
+    cout << "  threads test complete" << endl;
+  }
+
+  void untracked_test()
+  {
+    cout << "untracked test..." << endl;
+
+    cpu_sampler s(5, 16, 1);
+    if (!s.has_threads())
+      return;
+    std::thread worker([] { spin(30); });
+    worker.join();
+    s.stop();
+
+    std::vector<cpu_sample> samples;
+    std::vector<sampled_thread> threads;
+    std::vector<cpu_times> thread_times;
+    s.snapshot(samples, threads, thread_times);
+    BOOST_TEST_EQ(threads.size(), 1u);
+    BOOST_TEST(s.untracked_threads() >= 1u);  // the sampler at least
+
+    cout << "  untracked test complete" << endl;
+  }
+
+} // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "---------------  cpu_sampler_test  ---------------\n";
+
+  construction_test();
+  timeline_test();
+  threads_test();
+  untracked_test();
+
+  return ::boost::report_errors();
+}
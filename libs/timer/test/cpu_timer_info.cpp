@@ -8,6 +8,7 @@
 //  See http://www.boost.org/libs/timer for documentation.
 
 #include <boost/timer/timer.hpp>
+#include <boost/timer/perf_counter_timer.hpp>
 #include <boost/chrono/chrono.hpp>
 #include <boost/detail/lightweight_main.hpp>
 #include <cstdlib> // for atol()
@@ -20,6 +21,17 @@ using boost::timer::cpu_timer;
 using boost::timer::auto_cpu_timer;
 using std::cout; using std::endl;
 
+namespace
+{
+  void print_overhead(const char* name, const boost::timer::overhead_calibration& c)
+  {
+    cout << "  " << name << ": " << c.overhead.wall << "ns (" << c.deviation.wall
+         << "ns) wall, " << c.overhead.user << "ns (" << c.deviation.user
+         << "ns) user, " << c.overhead.system << "ns (" << c.deviation.system
+         << "ns) system\n";
+  }
+}
+
 int cpp_main( int argc, char * argv[] )
 {
   cout << '\n';
@@ -32,15 +44,35 @@ int cpp_main( int argc, char * argv[] )
           "of time_point never decrease as physical time advances and for "
           "which values of time_point advance at a steady rate relative to "
           "real time. That is, the clock may not be adjusted.\n\n";
+
+  cout << "The time stamp counter "
+       << (boost::timer::tsc_is_invariant() ? "is" : "is not")
+       << " invariant";
+  if (boost::timer::tsc_is_invariant())
+    cout << ", calibrated at " << boost::timer::tsc_frequency() << " ticks per second";
+  cout << ". The active wall-clock source is "
+       << boost::timer::wall_clock_name(boost::timer::wall_clock()) << ".\n\n";
   
   cpu_times start_time;
   start_time.clear();
   cpu_times current_time;
 
+  const boost::timer::cpu_clock_type active = boost::timer::cpu_clock();
+  cout << "For cpu_times.user and cpu_times.system, the active source is "
+       << boost::timer::cpu_clock_name(active) << ".\n\n";
+
+  const boost::timer::cpu_clock_type types[] = { boost::timer::times_clock,
+    boost::timer::rusage_clock, boost::timer::cputime_clock,
+    boost::timer::process_times_clock };
+
+  for (std::size_t t = 0; t < sizeof(types)/sizeof(types[0]); ++t)
   {
+    if (!boost::timer::set_cpu_clock(types[t]))
+      continue;
     cpu_timer cpu;
-    cout << "measure boost::timer::cpu_timer resolution for user time..."
-              << endl;
+    cout << "measure boost::timer::cpu_timer resolution for user time using "
+         << boost::timer::cpu_clock_name(types[t]) << " (nominal "
+         << boost::timer::cpu_clock_resolution(types[t]) << "ns)..." << endl;
     for (int i = 0; i < 3; ++i)
     {
       cpu.start();
@@ -53,11 +85,19 @@ int cpp_main( int argc, char * argv[] )
       cout << current_time.user - start_time.user << "ns\n";
     }
   }
+  boost::timer::set_cpu_clock(active);
  
+  const boost::timer::wall_clock_type active_wall = boost::timer::wall_clock();
+  const boost::timer::wall_clock_type wall_types[] = {
+    boost::timer::high_resolution_wall_clock, boost::timer::tsc_wall_clock };
+
+  for (std::size_t t = 0; t < sizeof(wall_types)/sizeof(wall_types[0]); ++t)
   {
-    cpu_timer cpu;
-    cout << "measure boost::timer::cpu_timer resolution for wall-clock time..."
-              << endl;
+    if (!boost::timer::set_wall_clock(wall_types[t]))
+      continue;
+    boost::timer::wall_timer cpu;
+    cout << "\nmeasure boost::timer::wall_timer resolution for wall-clock time using "
+         << boost::timer::wall_clock_name(wall_types[t]) << "..." << endl;
     for (int i = 0; i < 100; ++i)
     {
       cpu.start();
@@ -69,7 +109,27 @@ int cpp_main( int argc, char * argv[] )
       }
       cout << current_time.wall - start_time.wall << "ns ";
     }
+    cout << '\n';
   }
+  boost::timer::set_wall_clock(active_wall);
+
+  cout << "\ntimer overhead (median absolute deviation), from "
+       << boost::timer::timer_overhead<cpu_timer::policy_type>().trials << " trials:\n";
+  print_overhead("cpu_timer",
+    boost::timer::timer_overhead<cpu_timer::policy_type>());
+  print_overhead("thread_cpu_timer",
+    boost::timer::timer_overhead<boost::timer::thread_cpu_timer::policy_type>());
+  print_overhead("wall_timer",
+    boost::timer::timer_overhead<boost::timer::wall_timer::policy_type>());
+
+  const unsigned events = boost::timer::perf_events_available();
+  cout << "\nperf_event counters available:";
+  for (int e = 0; e != boost::timer::perf_event_count; ++e)
+    if (events & (1u << e))
+      cout << ' '
+           << boost::timer::perf_event_name(static_cast<boost::timer::perf_event_type>(e));
+  cout << (events ? "" : " none") << "; user space reads (rdpmc) "
+       << (boost::timer::perf_rdpmc_available() ? "are" : "are not") << " available\n";
  return 0;
 }
 
@@ -8,11 +8,17 @@
 //  See http://www.boost.org/libs/timer for documentation.
 
 #include <boost/timer/timer.hpp>
+#include <boost/chrono/chrono.hpp>
 #include <boost/detail/lightweight_main.hpp>
 #include <boost/detail/lightweight_test.hpp>
 #include <cstdlib> // for atol()
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <cstring>
+#if !defined(BOOST_NO_CXX11_HDR_THREAD)
+#  include <thread>
+#endif
 
 namespace old
 {
@@ -27,6 +33,8 @@ using boost::timer::cpu_times;
 using boost::timer::format;
 using boost::timer::cpu_timer;
 using boost::timer::auto_cpu_timer;
+using boost::timer::thread_cpu_timer;
+using boost::timer::auto_thread_cpu_timer;
 
 namespace
 {
@@ -80,6 +88,140 @@ namespace
     cout << "  format test complete" << endl; 
   }
 
+  //  format() as implemented with long double and stream insertion, before format_to()
+  std::string reference_format(const cpu_times& times, short places, const std::string& fmt)
+  {
+    if (places > 9)
+      places = 9;
+    else if (places < 0)
+      places = boost::timer::default_places;
+    std::stringstream os;
+    os.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    os.precision(places);
+    const long double sec = 1000000000.0L;
+    nanosecond_type total = times.system + times.user;
+    long double wall_sec = times.wall / sec;
+    long double total_sec = total / sec;
+    for (const char* format = fmt.c_str(); *format; ++format)
+    {
+      if (*format != '%' || !*(format+1) || !std::strchr("wustp", *(format+1)))
+        os << *format;
+      else
+      {
+        switch (*++format)
+        {
+        case 'w': os << times.wall / sec; break;
+        case 'u': os << times.user / sec; break;
+        case 's': os << times.system / sec; break;
+        case 't': os << total / sec; break;
+        case 'p':
+          os.precision(1);
+          if (wall_sec > 0.001L && total_sec > 0.001L)
+            os << (total_sec/wall_sec) * 100.0;
+          else
+            os << "n/a";
+          os.precision(places);
+          break;
+        }
+      }
+    }
+    return os.str();
+  }
+
+  //  true if v, as seconds to places decimal places, lies exactly halfway between two
+  //  representable results, where decimal and binary rounding may legitimately differ
+  bool is_tie(nanosecond_type v, short places)
+  {
+    if (v < 0)
+      v = -v;
+    nanosecond_type divisor = 1;
+    for (short i = places; i < 9; ++i)
+      divisor *= 10;
+    return divisor > 1 && v % divisor * 2 == divisor;
+  }
+
+  void format_to_test()
+  {
+    cout << "format_to test..." << endl;
+
+    cpu_times times;
+    times.wall = 5123456789LL;
+    times.user = 2123456789LL;
+    times.system = 1234567890LL;
+
+    char buf[128];
+    std::size_t n = boost::timer::format_to(buf, sizeof(buf), times, 3);
+    BOOST_TEST_EQ(string(buf), format(times, 3));
+    BOOST_TEST_EQ(n, std::strlen(buf));
+
+    // truncation, as for snprintf
+    string full(format(times, 9));
+    std::memset(buf, 'x', sizeof(buf));
+    n = boost::timer::format_to(buf, 10, times, 9);
+    BOOST_TEST_EQ(n, full.size());
+    BOOST_TEST_EQ(string(buf), full.substr(0, 9));
+    BOOST_TEST_EQ(buf[10], 'x');
+    BOOST_TEST_EQ(boost::timer::format_to(0, 0, times, 9), full.size());
+
+    // pre-parsed formats give the same results
+    const char* formats[] = { "", "boo", " %w, %u, %s, %t, %%p%", "%", "%w%", "%%%x%t",
+      " %ws wall, %us user + %ss system = %ts CPU (%p%)\n" };
+    for (std::size_t i = 0; i < sizeof(formats)/sizeof(formats[0]); ++i)
+    {
+      boost::timer::parsed_format parsed(formats[i]);
+      BOOST_TEST_EQ(parsed.str(), string(formats[i]));
+      for (short places = -1; places <= 10; ++places)
+      {
+        boost::timer::format_to(buf, sizeof(buf), times, places, parsed);
+        BOOST_TEST_EQ(string(buf), format(times, places, formats[i]));
+      }
+    }
+    boost::timer::parsed_format default_parsed;
+    BOOST_TEST_EQ(default_parsed.str(), boost::timer::default_format());
+
+    // error values and ties
+    times.wall = -1;
+    times.user = 500000000LL;
+    times.system = 0;
+    BOOST_TEST_EQ(format(times, 6, "%w %p"), string("-0.000000 n/a"));
+    BOOST_TEST_EQ(format(times, 0, "%u"), string("0"));
+    times.user = 1500000000LL;
+    BOOST_TEST_EQ(format(times, 0, "%u"), string("2"));
+    times.user = 250000000LL;
+    BOOST_TEST_EQ(format(times, 1, "%u"), string("0.2"));
+    times.wall = 3000000LL;
+    times.user = 1000001LL;
+    BOOST_TEST_EQ(format(times, 1, "%p"), string("33.3"));
+
+    // agreement with the previous floating point implementation
+    boost::uint64_t x = 88172645463325252ULL;
+    int compared = 0;
+    for (int i = 0; i < 20000; ++i)
+    {
+      x ^= x << 13; x ^= x >> 7; x ^= x << 17;  // xorshift
+      const int digits = static_cast<int>(x % 13) + 1;  // up to 13 digits: LDBL_DIG
+      nanosecond_type scale = 1;
+      for (int d = 0; d < digits; ++d)
+        scale *= 10;
+      times.wall = nanosecond_type((x >> 8) % scale);
+      times.user = nanosecond_type((x >> 16) % scale) / 2;
+      times.system = nanosecond_type((x >> 24) % scale) / 3;
+      const short places = static_cast<short>(x % 10);
+      if (is_tie(times.wall, places) || is_tie(times.user, places)
+        || is_tie(times.system, places) || is_tie(times.user + times.system, places))
+        continue;
+      std::string fmt(" %ws wall, %us user + %ss system = %ts CPU");
+      const nanosecond_type total = times.user + times.system;
+      if (times.wall && total * 10000 % times.wall * 2 != times.wall)
+        fmt += " (%p%)";  // unless the percentage is itself a tie
+      BOOST_TEST_EQ(format(times, places, fmt), reference_format(times, places, fmt));
+      ++compared;
+    }
+    cout << "  " << compared << " random values compared" << endl;
+
+    cout << "  format_to test complete" << endl; 
+  }
+
   void std_c_consistency_test()
   {
     cout << "C library consistency test..." << endl;
@@ -116,6 +258,340 @@ namespace
     cout << "  C library consistency test complete" << endl; 
   }
 
+  void cpu_clock_test()
+  {
+    cout << "cpu clock test..." << endl;
+
+    const boost::timer::cpu_clock_type active = boost::timer::cpu_clock();
+    cout << "  active cpu clock is " << boost::timer::cpu_clock_name(active) << endl;
+    BOOST_TEST(boost::timer::cpu_clock_resolution(active) > 0);
+
+# if defined(BOOST_POSIX_API)
+    BOOST_TEST(active == boost::timer::rusage_clock);
+    BOOST_TEST(!boost::timer::set_cpu_clock(boost::timer::process_times_clock));
+    BOOST_TEST(boost::timer::cpu_clock() == active);
+
+    // Sub-tick regions must register CPU time with the fine grained sources
+    const boost::timer::cpu_clock_type fine[] = { boost::timer::rusage_clock,
+      boost::timer::cputime_clock };
+    for (std::size_t i = 0; i < sizeof(fine)/sizeof(fine[0]); ++i)
+    {
+      if (!boost::timer::set_cpu_clock(fine[i]))
+        continue;
+      cout << "  " << boost::timer::cpu_clock_name(fine[i]) << endl;
+      BOOST_TEST(boost::timer::cpu_clock() == fine[i]);
+      BOOST_TEST(boost::timer::cpu_clock_resolution(fine[i]) <= 1000);
+      cpu_timer t;
+      while (t.elapsed().wall < 2000000) {}
+      t.stop();
+      BOOST_TEST(t.elapsed().user + t.elapsed().system > 0);
+      BOOST_TEST(t.elapsed().user >= 0);
+      BOOST_TEST(t.elapsed().system >= 0);
+
+      // Neither user nor system time ever goes backwards
+      int backwards = 0;
+      cpu_times previous, current, previous_thread, current_thread;
+      boost::timer::current_process_cpu(previous);
+      boost::timer::current_thread_cpu(previous_thread);
+      for (int j = 0; j < 20000; ++j)
+      {
+        boost::timer::current_process_cpu(current);
+        boost::timer::current_thread_cpu(current_thread);
+        if (current.user < previous.user || current.system < previous.system
+          || current_thread.user < previous_thread.user
+          || current_thread.system < previous_thread.system)
+          ++backwards;
+        previous = current;
+        previous_thread = current_thread;
+      }
+      BOOST_TEST_EQ(backwards, 0);
+    }
+# endif
+    boost::timer::set_cpu_clock(active);
+
+    cout << "  cpu clock test complete" << endl; 
+  }
+
+  void burn(nanosecond_type ns)
+  {
+    cpu_timer t;
+    while (t.elapsed().wall < ns) {}
+  }
+
+  void read_tsc_frequency(double* frequency)
+  {
+    *frequency = boost::timer::tsc_frequency();
+  }
+
+  void wall_clock_test()
+  {
+    cout << "wall clock test..." << endl;
+
+#if !defined(BOOST_NO_CXX11_HDR_THREAD)
+    // Threads racing to the first calibration all see it complete
+    double frequencies[4];
+    std::thread racers[4];
+    for (int i = 0; i < 4; ++i)
+      racers[i] = std::thread(read_tsc_frequency, &frequencies[i]);
+    for (int i = 0; i < 4; ++i)
+      racers[i].join();
+    for (int i = 1; i < 4; ++i)
+      BOOST_TEST_EQ(frequencies[i], frequencies[0]);
+    BOOST_TEST_EQ(frequencies[0], boost::timer::tsc_frequency());
+#endif
+
+    const boost::timer::wall_clock_type active = boost::timer::wall_clock();
+    BOOST_TEST(active == boost::timer::high_resolution_wall_clock
+      || boost::timer::tsc_is_invariant());
+    BOOST_TEST(boost::timer::set_wall_clock(boost::timer::high_resolution_wall_clock));
+
+    if (!boost::timer::set_wall_clock(boost::timer::tsc_wall_clock))
+    {
+      cout << "  time stamp counter is not invariant; fell back to "
+           << boost::timer::wall_clock_name(boost::timer::wall_clock()) << endl;
+      BOOST_TEST(!boost::timer::tsc_is_invariant());
+      BOOST_TEST(boost::timer::tsc_frequency() == 0.0);
+      BOOST_TEST(boost::timer::wall_clock() == boost::timer::high_resolution_wall_clock);
+    }
+    else
+    {
+      cout << "  tsc frequency is " << boost::timer::tsc_frequency() << endl;
+      BOOST_TEST(boost::timer::wall_clock() == boost::timer::tsc_wall_clock);
+      BOOST_TEST(boost::timer::tsc_frequency() > 0.0);
+
+      // agree with the steady clock to within the calibration accuracy
+      typedef boost::chrono::steady_clock clock;
+      cpu_timer t;
+      clock::time_point start = clock::now();
+      while (clock::now() - start < boost::chrono::milliseconds(100)) {}
+      t.stop();
+      nanosecond_type steady_ns = boost::chrono::duration_cast<
+        boost::chrono::nanoseconds>(clock::now() - start).count();
+      cout << "  tsc wall " << t.elapsed().wall << "ns, steady " << steady_ns << "ns\n";
+      BOOST_TEST(t.elapsed().wall > steady_ns * 95 / 100);
+      BOOST_TEST(t.elapsed().wall < steady_ns * 105 / 100);
+
+      // monotonic
+      cpu_timer m;
+      nanosecond_type last = 0;
+      for (int i = 0; i < 100000; ++i)
+      {
+        nanosecond_type now = m.elapsed().wall;
+        BOOST_TEST(now >= last);
+        last = now;
+      }
+    }
+    boost::timer::set_wall_clock(active);
+
+    cout << "  wall clock test complete" << endl; 
+  }
+
+  void capture_policy_test()
+  {
+    cout << "capture policy test..." << endl;
+
+    boost::timer::wall_timer w;
+    BOOST_TEST(!w.is_stopped());
+    burn(2000000);
+    w.stop();
+    BOOST_TEST(w.elapsed().wall >= 2000000);
+    BOOST_TEST_EQ(w.elapsed().user, 0);
+    BOOST_TEST_EQ(w.elapsed().system, 0);
+    w.resume();
+    burn(1000000);
+    BOOST_TEST(w.elapsed().wall >= 3000000);
+
+    typedef boost::timer::capture_policy<boost::timer::user_field
+      | boost::timer::system_field> cpu_only_policy;
+    boost::timer::basic_cpu_timer<cpu_only_policy> c;
+    burn(2000000);
+    c.stop();
+    BOOST_TEST_EQ(c.elapsed().wall, 0);
+    BOOST_TEST(c.elapsed().user + c.elapsed().system > 0);
+
+    typedef boost::timer::capture_policy<boost::timer::wall_field
+      | boost::timer::user_field> user_policy;
+    boost::timer::basic_cpu_timer<user_policy> u;
+    burn(1000000);
+    u.stop();
+    BOOST_TEST(u.elapsed().wall >= 1000000);
+    BOOST_TEST_EQ(u.elapsed().system, 0);
+
+    // a wall_timer within a cpu_timer's interval sees no more wall time
+    cpu_timer outer;
+    boost::timer::wall_timer inner;
+    burn(1000000);
+    inner.stop();
+    outer.stop();
+    BOOST_TEST(inner.elapsed().wall <= outer.elapsed().wall);
+
+    // the cost difference is the point of the exercise: a wall_timer never asks
+    // the operating system for CPU times
+    const int n = 100000;
+    int nonzero = 0;
+    boost::timer::wall_timer cost;
+    for (int i = 0; i < n; ++i)
+    {
+      const cpu_times times = w.elapsed();
+      if (times.user != 0 || times.system != 0)
+        ++nonzero;
+    }
+    nanosecond_type wall_only_ns = cost.elapsed().wall / n;
+    cost.start();
+    cpu_timer all;
+    for (int i = 0; i < n; ++i)
+      all.elapsed();
+    nanosecond_type all_ns = cost.elapsed().wall / n;
+    cout << "  elapsed() cost: wall_timer " << wall_only_ns << "ns, cpu_timer "
+         << all_ns << "ns" << endl;
+    BOOST_TEST_EQ(nonzero, 0);
+    BOOST_TEST(wall_only_ns <= all_ns);
+
+    cout << "  capture policy test complete" << endl; 
+  }
+
+  void thread_cpu_timer_test()
+  {
+    cout << "thread_cpu_timer test..." << endl;
+
+    thread_cpu_timer t;
+    burn(20000000);
+    t.stop();
+    cout << "  busy thread: " << t.format();
+    BOOST_TEST(t.elapsed().wall >= 20000000);
+    BOOST_TEST(t.elapsed().user + t.elapsed().system > 0);
+
+    t.resume();
+    BOOST_TEST(!t.is_stopped());
+    burn(5000000);
+    t.stop();
+    BOOST_TEST(t.elapsed().wall >= 25000000);
+
+#if !defined(BOOST_NO_CXX11_HDR_THREAD)
+    // CPU time burnt by another thread is not charged to the waiting thread
+    thread_cpu_timer waiting;
+    cpu_timer process;
+    std::thread other(burn, 50000000);
+    other.join();
+    waiting.stop();
+    process.stop();
+    cout << "  waiting thread: " << waiting.format();
+    cout << "  process: " << process.format();
+    BOOST_TEST(waiting.elapsed().user + waiting.elapsed().system < 25000000);
+    BOOST_TEST(process.elapsed().user + process.elapsed().system >= 25000000);
+#endif
+
+    std::stringstream ss;
+    {
+      auto_thread_cpu_timer auto_t(ss, 3, "%w|%t");
+      burn(1000000);
+    }
+    cout << "  auto_thread_cpu_timer output: " << ss.str() << endl;
+    BOOST_TEST(ss.str().find('|') != string::npos);
+
+    cout << "  thread_cpu_timer test complete" << endl; 
+  }
+
+  //  A clock that advances a fixed amount per reading, every tenth reading much more
+  nanosecond_type fake_now = 0;
+  int fake_calls = 0;
+
+  struct fake_policy
+  {
+    static void get(cpu_times& current)
+    {
+      fake_now += ++fake_calls % 10 ? 1000 : 1000000;
+      current.wall = fake_now;
+      current.user = fake_now / 100;
+      current.system = 0;
+    }
+  };
+
+  int counted_calls = 0;
+
+  struct counting_policy
+  {
+    static void get(cpu_times& current)
+    {
+      ++counted_calls;
+      current.clear();
+    }
+  };
+
+  void overhead_test()
+  {
+    cout << "overhead test..." << endl;
+
+    boost::timer::overhead_calibration c
+      = boost::timer::calibrate_overhead(&fake_policy::get, 101);
+    BOOST_TEST_EQ(c.trials, 101u);
+    BOOST_TEST_EQ(c.overhead.wall, 1000);  // the outliers are ignored
+    BOOST_TEST_EQ(c.deviation.wall, 0);
+    BOOST_TEST_EQ(c.overhead.user, 10);
+    BOOST_TEST_EQ(c.overhead.system, 0);
+
+    // calibrated once, on first use
+    const boost::timer::overhead_calibration& fake
+      = boost::timer::timer_overhead<fake_policy>();
+    BOOST_TEST_EQ(&fake, &boost::timer::timer_overhead<fake_policy>());
+    BOOST_TEST_EQ(fake.overhead.wall, 1000);
+    BOOST_TEST_EQ(fake.trials, 1001u);
+
+    fake_calls = 1;  // next reading advances 1000
+    boost::timer::basic_cpu_timer<fake_policy> t;
+    BOOST_TEST(!t.subtracts_overhead());
+    BOOST_TEST_EQ(t.elapsed().wall, 1000);
+    t.subtract_overhead();
+    BOOST_TEST(t.subtracts_overhead());
+    fake_calls = 1;
+    t.start();
+    cpu_times e = t.elapsed();
+    BOOST_TEST_EQ(e.wall, 0);
+    BOOST_TEST_EQ(e.user, 0);
+    fake_calls = 1;
+    t.start();
+    t.stop();
+    fake_now += 5000;
+    t.resume();
+    fake_now += 5000;
+    t.stop();
+    BOOST_TEST_EQ(t.elapsed().wall, 5000);  // each interval's overhead is subtracted
+    fake_calls = 8;  // the reading after next advances 1000000
+    t.start();
+    t.subtract_overhead(false);
+    BOOST_TEST_EQ(t.elapsed().wall, 1000000);
+    fake_calls = 0;  // subtraction cannot go negative
+    t.subtract_overhead();
+    t.start();
+    fake_now -= 500;
+    BOOST_TEST_EQ(t.elapsed().wall, 0);
+
+    // calibrated by subtract_overhead(), not within the interval timed
+    boost::timer::basic_cpu_timer<counting_policy> counted;
+    counted.subtract_overhead();
+    BOOST_TEST(counted_calls > 1000);
+    counted_calls = 0;
+    counted.stop();
+    BOOST_TEST_EQ(counted_calls, 1);
+
+    const boost::timer::overhead_calibration& real
+      = boost::timer::timer_overhead<cpu_timer::policy_type>();
+    cout << "  cpu_timer overhead " << real.overhead.wall << "ns (+/- "
+         << real.deviation.wall << "ns)" << endl;
+    BOOST_TEST(real.overhead.wall > 0);
+    BOOST_TEST(real.overhead.wall < 1000000);
+    BOOST_TEST(boost::timer::timer_overhead<boost::timer::wall_timer::policy_type>()
+      .overhead.user == 0);
+
+    std::stringstream ss;
+    {
+      auto_cpu_timer a(ss, 9, "%w");
+      a.subtract_overhead();
+      BOOST_TEST(a.subtracts_overhead());
+    }
+    cout << "  subtracted auto_cpu_timer: " << ss.str() << endl;
+    BOOST_TEST_EQ(ss.str().size(), 11u);
+  }
 
 }  // unnamed namespace
 
@@ -126,7 +602,13 @@ int cpp_main(int argc, char * argv[])
   cout << "----------  timer_test  ----------\n";
 
   format_test();
+  format_to_test();
   std_c_consistency_test();
+  cpu_clock_test();
+  wall_clock_test();
+  capture_policy_test();
+  thread_cpu_timer_test();
+  overhead_test();
 
   return ::boost::report_errors();
 }
@@ -0,0 +1,199 @@
+//  boost histogram_test.cpp  ----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/histogram.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <string>
+
+using std::string;
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::histogram;
+using boost::timer::cpu_times_histogram;
+
+namespace
+{
+  void bucket_test()
+  {
+    cout << "bucket test..." << endl;
+
+    // exact below 2^sub_bucket_bits
+    for (nanosecond_type v = 0; v < 128; ++v)
+    {
+      BOOST_TEST_EQ(histogram::bucket_index(v), std::size_t(v));
+      BOOST_TEST_EQ(histogram::bucket_lowest(std::size_t(v)), v);
+    }
+    BOOST_TEST_EQ(histogram::bucket_index(-1), 0u);
+
+    // every bucket covers the values that map to it, with bounded relative error
+    for (std::size_t i = 0; i < histogram::bucket_count; ++i)
+    {
+      nanosecond_type lo = histogram::bucket_lowest(i);
+      nanosecond_type hi = histogram::bucket_highest(i);
+      BOOST_TEST_EQ(histogram::bucket_index(lo), i);
+      BOOST_TEST_EQ(histogram::bucket_index(hi), i);
+      if (i + 1 < histogram::bucket_count)
+        BOOST_TEST_EQ(histogram::bucket_lowest(i + 1), hi + 1);
+      BOOST_TEST(hi - lo <= lo / 64);
+    }
+    BOOST_TEST_EQ(histogram::bucket_highest(histogram::bucket_count - 1),
+      (nanosecond_type(1) << histogram::magnitude_bits) - 1);
+    BOOST_TEST_EQ(histogram::bucket_index(nanosecond_type(1) << 60),
+      histogram::bucket_count - 1);
+
+    cout << "  bucket test complete" << endl;
+  }
+
+  void percentile_test()
+  {
+    cout << "percentile test..." << endl;
+
+    histogram h;
+    BOOST_TEST_EQ(h.count(), 0u);
+    BOOST_TEST_EQ(h.percentile(50.0), 0);
+
+    for (nanosecond_type v = 1; v <= 10000; ++v)
+      h.record(v * 1000);  // 1us to 10ms
+    BOOST_TEST_EQ(h.count(), 10000u);
+    BOOST_TEST_EQ(h.min(), 1000);
+    BOOST_TEST_EQ(h.max(), 10000000);
+    BOOST_TEST(h.mean() > 5000499.0 && h.mean() < 5000501.0);
+
+    const double ps[] = { 0.0, 10.0, 50.0, 90.0, 99.0, 99.9, 100.0 };
+    for (std::size_t i = 0; i < sizeof(ps)/sizeof(ps[0]); ++i)
+    {
+      nanosecond_type exact = nanosecond_type(ps[i] * 100.0 + 0.5) * 1000;
+      if (exact < 1000)
+        exact = 1000;
+      nanosecond_type p = h.percentile(ps[i]);
+      cout << "  p" << ps[i] << " = " << p << "ns (exact " << exact << "ns)\n";
+      BOOST_TEST(p >= exact);
+      BOOST_TEST(p <= exact + exact / 64);
+    }
+    BOOST_TEST_EQ(h.percentile(100.0), 10000000);
+
+    histogram big;
+    big.record(nanosecond_type(1) << 50, 3);
+    BOOST_TEST_EQ(big.percentile(50.0), nanosecond_type(1) << 50);
+
+    cout << "  percentile test complete" << endl;
+  }
+
+  void merge_test()
+  {
+    cout << "merge test..." << endl;
+
+    histogram a, b, all;
+    for (nanosecond_type v = 1; v <= 1000; ++v)
+    {
+      (v % 2 ? a : b).record(v * 7919);
+      all.record(v * 7919);
+    }
+    a.merge(b);
+    BOOST_TEST_EQ(a.count(), all.count());
+    BOOST_TEST_EQ(a.min(), all.min());
+    BOOST_TEST_EQ(a.max(), all.max());
+    BOOST_TEST_EQ(a.mean(), all.mean());
+    for (double p = 0.0; p <= 100.0; p += 2.5)
+      BOOST_TEST_EQ(a.percentile(p), all.percentile(p));
+
+    histogram empty;
+    empty.merge(a);
+    BOOST_TEST_EQ(empty.min(), a.min());
+
+    cout << "  merge test complete" << endl;
+  }
+
+  void serialize_test()
+  {
+    cout << "serialize test..." << endl;
+
+    cpu_times_histogram h;
+    for (nanosecond_type v = 0; v < 5000; ++v)
+    {
+      cpu_times t;
+      t.wall = v * v;
+      t.user = v * 3;
+      t.system = 1;
+      h.record(t);
+    }
+
+    string s;
+    h.serialize(s);
+    cout << "  serialized " << h.count() << " samples in " << s.size() << " bytes\n";
+    BOOST_TEST(s.size() < 3 * histogram::bucket_count);
+
+    cpu_times_histogram r;
+    std::size_t pos = 0;
+    BOOST_TEST(r.deserialize(s, pos));
+    BOOST_TEST_EQ(pos, s.size());
+    BOOST_TEST_EQ(r.count(), h.count());
+    for (double p = 0.0; p <= 100.0; p += 12.5)
+    {
+      BOOST_TEST_EQ(r.percentile(p).wall, h.percentile(p).wall);
+      BOOST_TEST_EQ(r.percentile(p).user, h.percentile(p).user);
+      BOOST_TEST_EQ(r.percentile(p).system, h.percentile(p).system);
+    }
+    BOOST_TEST_EQ(r.max().wall, h.max().wall);
+    BOOST_TEST_EQ(r.mean().user, h.mean().user);
+
+    // corrupt input is rejected and leaves the target unchanged
+    string bad(s, 0, s.size() / 2);
+    pos = 0;
+    BOOST_TEST(!r.deserialize(bad, pos));
+    BOOST_TEST_EQ(pos, 0u);
+    BOOST_TEST_EQ(r.count(), h.count());
+    bad = s;
+    bad[0] = 'X';
+    BOOST_TEST(!r.deserialize(bad, pos));
+    pos = s.size() + 1;  // past the end
+    BOOST_TEST(!r.deserialize(s, pos));
+    BOOST_TEST_EQ(pos, s.size() + 1);
+
+    cout << "  serialize test complete" << endl;
+  }
+
+  void format_test()
+  {
+    cout << "format test..." << endl;
+
+    cpu_times_histogram h;
+    for (nanosecond_type v = 1; v <= 100; ++v)
+    {
+      cpu_times t;
+      t.wall = v * 10000000;  // 10ms to 1s
+      t.user = v * 5000000;
+      t.system = 0;
+      h.record(t);
+    }
+    string s = boost::timer::format(h.percentile(99.0), 2, "p99 %ws wall, %ts CPU (%p%)");
+    cout << "  " << s << endl;
+    BOOST_TEST_EQ(s, string("p99 1.00s wall, 0.50s CPU (50.0%)"));
+
+    cout << "  format test complete" << endl;
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "----------  histogram_test  ----------\n";
+
+  bucket_test();
+  percentile_test();
+  merge_test();
+  serialize_test();
+  format_test();
+
+  return ::boost::report_errors();
+}
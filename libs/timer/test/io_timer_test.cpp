@@ -0,0 +1,173 @@
+//  boost io_timer_test.cpp  -----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/io_timer.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+# include <sys/wait.h>
+# include <unistd.h>
+#endif
+
+using std::string;
+using std::cout;
+using std::endl;
+using boost::timer::cpu_times;
+using boost::timer::format_extras;
+using boost::timer::io_counters;
+using boost::timer::io_timer;
+
+namespace
+{
+  const char* const path = "io_timer_test.tmp";
+
+  void format_test()
+  {
+    cout << "format test..." << endl;
+
+    cpu_times times;
+    times.wall = 500000000LL;
+    times.user = times.system = 0;
+    io_counters io;
+    io.read_chars = 50000000;
+    io.write_chars = 1234;
+    io.read_calls = 3;
+    io.write_calls = 4;
+    io.read_bytes = 5;
+    io.write_bytes = 6;
+
+    format_extras extras;
+    extras.io = &io;
+    BOOST_TEST_EQ(boost::timer::format(times, extras, 1, "%R %W %y %Y %d %D"),
+      "50000000 1234 3 4 5 6");
+    BOOST_TEST_EQ(boost::timer::format(times, extras, 1, "%a|%A"), "100.0|0.0");
+    times.wall = 3000000000LL;  // 16.666.. and 0.000411..
+    BOOST_TEST_EQ(boost::timer::format(times, extras, 1, "%a|%A"), "16.7|0.0");
+    times.wall = 0;
+    BOOST_TEST_EQ(boost::timer::format(times, extras, 1, "%a"), "n/a");
+    BOOST_TEST_EQ(boost::timer::format(times, 1, "%R|%a"), "%R|%a");
+
+    cout << "  format test complete" << endl;
+  }
+
+  void file_test()
+  {
+    cout << "file test..." << endl;
+
+    io_counters current;
+    bool available = boost::timer::current_io_counters(current);
+    io_timer t;
+    BOOST_TEST_EQ(t.has_io(), available);
+    if (!available)
+    {
+      cout << "  I/O counters not available; skipped" << endl;
+      BOOST_TEST_EQ(t.format(3, "%R"), "n/a");
+      return;
+    }
+    BOOST_TEST(current.read_calls > 0);  // reading the counters is one
+
+    const std::size_t size = 4 * 1024 * 1024;
+    std::vector<char> data(size, 'x');
+    {
+      std::ofstream out(path, std::ios_base::binary);
+      out.write(&data[0], size);
+    }
+    io_counters written = t.elapsed_io();
+    {
+      std::ifstream in(path, std::ios_base::binary);
+      in.read(&data[0], size);
+      BOOST_TEST_EQ(static_cast<std::size_t>(in.gcount()), size);
+    }
+    t.stop();
+    std::remove(path);
+    cout << "  " << t.format(3);
+
+    io_counters io = t.elapsed_io();
+    BOOST_TEST(written.write_chars >= static_cast<boost::int_least64_t>(size));
+    BOOST_TEST(io.write_chars >= static_cast<boost::int_least64_t>(size));
+    BOOST_TEST(io.read_chars >= static_cast<boost::int_least64_t>(size));
+    BOOST_TEST(io.write_calls >= 1);
+    BOOST_TEST(io.read_calls >= 2);  // elapsed_io() read the counters once
+    BOOST_TEST(io.read_bytes >= 0);
+    BOOST_TEST(t.format(1, "%a").find("n/a") == string::npos);
+
+    //  resumed, the intervals accumulate
+    t.resume();
+    t.stop();
+    BOOST_TEST(t.elapsed_io().write_chars >= io.write_chars);
+
+    cout << "  file test complete" << endl;
+  }
+
+  //  a child's counters are its own, not those of the file its parent opened
+  void fork_test()
+  {
+    cout << "fork test..." << endl;
+#if defined(__linux__)
+    io_counters parent;
+    if (!boost::timer::current_io_counters(parent))
+    {
+      cout << "  I/O counters not available; skipped" << endl;
+      return;
+    }
+    const std::size_t size = 4 * 1024 * 1024;
+    {
+      std::vector<char> data(size, 'x');
+      std::ofstream out(path, std::ios_base::binary);
+      out.write(&data[0], size);
+    }
+    std::remove(path);
+    boost::timer::current_io_counters(parent);
+    BOOST_TEST(parent.write_chars >= static_cast<boost::int_least64_t>(size));
+
+    std::cout.flush();
+    const pid_t child = ::fork();
+    if (child == 0)
+    {
+      io_counters counters;
+      bool ok = boost::timer::current_io_counters(counters)
+        && counters.write_chars < parent.write_chars;
+      io_timer t;  // and timers opened in the child use the same file
+      ok = ok && t.has_io() && t.elapsed_io().write_chars >= 0;
+      ::_exit(ok ? 0 : 1);
+    }
+    BOOST_TEST(child > 0);
+    int status = 0;
+    BOOST_TEST_EQ(::waitpid(child, &status, 0), child);
+    BOOST_TEST(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    //  and the parent's file is still its own
+    io_counters after;
+    BOOST_TEST(boost::timer::current_io_counters(after));
+    BOOST_TEST(after.write_chars >= parent.write_chars);
+#else
+    cout << "  fork() not available; skipped" << endl;
+#endif
+    cout << "  fork test complete" << endl;
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "----------  io_timer test  ----------" << endl;
+
+  format_test();
+  file_test();
+  fork_test();
+
+  cout << "----------  io_timer test complete  ----------" << endl;
+  return ::boost::report_errors();
+}
@@ -0,0 +1,157 @@
+//  boost perf_counter_timer_test.cpp  -------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/perf_counter_timer.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#if defined(__unix__)
+# include <unistd.h>
+#endif
+
+using std::string;
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::format_extras;
+using boost::timer::perf_counters;
+using boost::timer::perf_counter_timer;
+
+namespace
+{
+  void burn(nanosecond_type ns)
+  {
+    boost::timer::wall_timer t;
+    while (t.elapsed().wall < ns) {}
+  }
+
+  void format_test()
+  {
+    cout << "format test..." << endl;
+
+    cpu_times times;
+    times.wall = times.user = 1000000000LL;
+    times.system = 0;
+    perf_counters perf;
+    perf.clear();
+    perf.value[boost::timer::cycles_event] = 2000;
+    perf.value[boost::timer::instructions_event] = 3000;
+    perf.value[boost::timer::cache_misses_event] = 15;
+    perf.value[boost::timer::branch_misses_event] = 4;
+    perf.value[boost::timer::task_clock_event] = 500000000LL;
+    perf.value[boost::timer::page_faults_event] = 6;
+    perf.value[boost::timer::context_switches_event] = 7;
+    perf.available = (1u << boost::timer::perf_event_count) - 1;
+
+    format_extras extras;
+    extras.perf = &perf;
+    BOOST_TEST_EQ(boost::timer::format(times, extras, 1, "%K %I %P %M %H %B %Ts %G %S"),
+      "2000 3000 1.50 15 5.00 4 0.5s 6 7");
+
+    //  events not counted are n/a, as are ratios involving them
+    perf.available = 1u << boost::timer::instructions_event;
+    BOOST_TEST_EQ(boost::timer::format(times, extras, 1, "%K|%I|%P|%H"),
+      "n/a|3000|n/a|n/a");
+    perf.available |= 1u << boost::timer::cycles_event;
+    perf.value[boost::timer::cycles_event] = 0;
+    BOOST_TEST_EQ(boost::timer::format(times, extras, 1, "%P"), "n/a");
+    BOOST_TEST_EQ(boost::timer::format(times, 1, "%K|%T"), "%K|%T");
+
+    BOOST_TEST_EQ(string(boost::timer::perf_event_name(boost::timer::cycles_event)),
+      "cycles");
+    BOOST_TEST_EQ(string(boost::timer::perf_event_name(
+      boost::timer::context_switches_event)), "context-switches");
+
+    cout << "  format test complete" << endl;
+  }
+
+  void counter_test()
+  {
+    cout << "counter test..." << endl;
+
+    const unsigned available = boost::timer::perf_events_available();
+    cout << "  available:";
+    for (int e = 0; e != boost::timer::perf_event_count; ++e)
+      if (available & (1u << e))
+        cout << ' '
+             << boost::timer::perf_event_name(static_cast<boost::timer::perf_event_type>(e));
+    cout << (available ? "" : " none") << "; rdpmc "
+         << (boost::timer::perf_rdpmc_available() ? "available" : "not available")
+         << endl;
+
+    perf_counter_timer t;
+    BOOST_TEST_EQ(t.available(), available);
+    const std::size_t size = 8 * 1024 * 1024;
+    char* p = new char[size];
+    std::memset(p, 1, size);
+    burn(50000000);
+    t.stop();
+    BOOST_TEST(p[size / 2] == 1);
+    delete [] p;
+    cout << "  " << t.format(3);
+
+    perf_counters c = t.elapsed_counters();
+    BOOST_TEST_EQ(c.available, available);
+    if (c.has(boost::timer::task_clock_event))
+    {
+      cpu_times times = t.elapsed();
+      BOOST_TEST(c.value[boost::timer::task_clock_event] >= 20000000);
+      BOOST_TEST(c.value[boost::timer::task_clock_event]
+        <= times.wall + 10000000);
+    }
+    //  touching the pages faults at least once, and at most once a page plus the
+    //  timer's own; how many times between depends on the size of the kernel's folios
+    if (c.has(boost::timer::page_faults_event))
+    {
+      BOOST_TEST(c.value[boost::timer::page_faults_event] >= 1);
+      BOOST_TEST(c.value[boost::timer::page_faults_event]
+        <= static_cast<boost::int_least64_t>(size / 4096 + 1000));
+    }
+    if (c.has(boost::timer::instructions_event))
+      BOOST_TEST(c.value[boost::timer::instructions_event] > 1000000);
+    if (c.has(boost::timer::cycles_event))
+      BOOST_TEST(c.value[boost::timer::cycles_event] > 1000000);
+
+    //  resumed, the intervals accumulate
+    t.resume();
+    burn(10000000);
+    t.stop();
+    for (int e = 0; e != boost::timer::perf_event_count; ++e)
+      BOOST_TEST(t.elapsed_counters().value[e] >= c.value[e]);
+
+#if defined(__unix__)
+    //  each sleep gives up the CPU, which only the kernel sees
+    perf_counter_timer sleeper;
+    for (int i = 0; i < 5; ++i)
+      ::usleep(1000);
+    sleeper.stop();
+    if (sleeper.elapsed_counters().has(boost::timer::context_switches_event))
+      BOOST_TEST(sleeper.elapsed_counters().value[boost::timer::context_switches_event]
+        >= 1);
+#endif
+
+    cout << "  counter test complete" << endl;
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "----------  perf_counter_timer test  ----------" << endl;
+
+  format_test();
+  counter_test();
+
+  cout << "----------  perf_counter_timer test complete  ----------" << endl;
+  return ::boost::report_errors();
+}
@@ -0,0 +1,175 @@
+//  boost profiler_test.cpp  -----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/profiler.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using std::string;
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::profile_node;
+using boost::timer::profile_zone;
+
+//  count allocations, to check that zones do not allocate once warmed up
+std::atomic<long> allocations(0);
+
+void* operator new(std::size_t n)
+{
+  ++allocations;
+  if (void* p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+  void burn(nanosecond_type ns)
+  {
+    boost::timer::wall_timer t;
+    while (t.elapsed().wall < ns) {}
+  }
+
+  const profile_node* find(const profile_node& n, const string& name)
+  {
+    for (std::size_t i = 0; i < n.children.size(); ++i)
+      if (n.children[i].name == name)
+        return &n.children[i];
+    return 0;
+  }
+
+  void inner()
+  {
+    BOOST_TIMER_PROFILE_ZONE("inner");
+    burn(200000);
+  }
+
+  void outer()
+  {
+    BOOST_TIMER_PROFILE_ZONE("outer");
+    burn(500000);
+    for (int i = 0; i < 3; ++i)
+      inner();
+    {
+      BOOST_TIMER_PROFILE_ZONE("other; odd\nname");
+      burn(100000);
+    }
+  }
+
+  void tree_test()
+  {
+    cout << "tree test..." << endl;
+
+    boost::timer::reset_profile();
+    outer();
+    outer();
+    boost::timer::flush_thread_profile();
+    profile_node root = boost::timer::profile_snapshot();
+
+    BOOST_TEST_EQ(root.children.size(), 1u);
+    const profile_node* o = find(root, "outer");
+    BOOST_TEST(o != 0);
+    if (!o)
+      return;
+    BOOST_TEST_EQ(o->count, 2u);
+    BOOST_TEST_EQ(o->children.size(), 2u);
+    const profile_node* i = find(*o, "inner");
+    BOOST_TEST(i != 0);
+    if (!i)
+      return;
+    BOOST_TEST_EQ(i->count, 6u);
+    BOOST_TEST(i->inclusive.wall >= 6 * 200000);
+    BOOST_TEST_EQ(i->exclusive.wall, i->inclusive.wall);  // a leaf
+    BOOST_TEST(o->inclusive.wall >= 2 * 1200000);
+    BOOST_TEST(o->exclusive.wall >= 2 * 500000);
+    BOOST_TEST(o->exclusive.wall < o->inclusive.wall - i->inclusive.wall + 1);
+    BOOST_TEST_EQ(root.inclusive.wall, o->inclusive.wall);
+
+    // flushing zeroes the thread's times, so a second flush adds nothing
+    boost::timer::flush_thread_profile();
+    BOOST_TEST_EQ(boost::timer::profile_snapshot().children[0].count, 2u);
+
+    std::ostringstream report;
+    boost::timer::write_profile_report(report, root);
+    cout << report.str();
+    BOOST_TEST(report.str().find("outer: 2 calls, ") == 0);
+    BOOST_TEST(report.str().find("\n  inner: 6 calls, ") != string::npos);
+    BOOST_TEST(report.str().find(" inclusive, ") != string::npos);
+    BOOST_TEST(report.str().find("\n  other; odd_name: 2 calls, ") != string::npos);
+
+    std::ostringstream folded;
+    boost::timer::write_folded_stacks(folded, root);
+    cout << folded.str();
+    BOOST_TEST(folded.str().find("outer ") == 0);
+    BOOST_TEST(folded.str().find("\nouter;inner ") != string::npos);
+    BOOST_TEST(folded.str().find("\nouter;other_ odd_name ") != string::npos);
+
+    boost::timer::reset_profile();
+    BOOST_TEST(boost::timer::profile_snapshot().children.empty());
+  }
+
+  void allocation_test()
+  {
+    cout << "allocation test..." << endl;
+
+    outer();  // warm up: this thread's tree now has every node and enough stack
+    long before = allocations.load();
+    for (int i = 0; i < 10; ++i)
+    {
+      BOOST_TIMER_PROFILE_ZONE("outer");
+      inner();
+    }
+    outer();
+    BOOST_TEST_EQ(allocations.load() - before, 0);
+    boost::timer::flush_thread_profile();
+  }
+
+  void thread_test()
+  {
+    cout << "thread test..." << endl;
+
+    boost::timer::reset_profile();
+    std::thread a(outer);
+    std::thread b(outer);
+    a.join();
+    b.join();
+    profile_node root = boost::timer::profile_snapshot();  // merged at thread exit
+    const profile_node* o = find(root, "outer");
+    BOOST_TEST(o != 0);
+    if (o)
+    {
+      BOOST_TEST_EQ(o->count, 2u);
+      const profile_node* i = find(*o, "inner");
+      BOOST_TEST(i != 0 && i->count == 6u);
+    }
+  }
+}
+
+int cpp_main(int, char *[])
+{
+  cout << "----------  profiler_test  ----------\n";
+
+  tree_test();
+  allocation_test();
+  thread_test();
+
+  return ::boost::report_errors();
+}
@@ -0,0 +1,215 @@
+//  boost region_export_test.cpp  ------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/region_export.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__)
+# include <unistd.h>
+#endif
+
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::region;
+using boost::timer::region_stats;
+using boost::timer::export_snapshot;
+
+namespace
+{
+  std::string test_name()
+  {
+    char buf[48];
+    std::sprintf(buf, "/boost_timer_export_test.%ld", static_cast<long>(::getpid()));
+    return buf;
+  }
+
+  const region_stats* find(const std::vector<region_stats>& stats, const std::string& name)
+  {
+    for (std::size_t i = 0; i < stats.size(); ++i)
+      if (stats[i].name == name)
+        return &stats[i];
+    return 0;
+  }
+
+  cpu_times make_times(nanosecond_type wall, nanosecond_type user, nanosecond_type system)
+  {
+    cpu_times t;
+    t.wall = wall;
+    t.user = user;
+    t.system = system;
+    return t;
+  }
+
+  void publish_test()
+  {
+    cout << "publish test..." << endl;
+
+    const std::string name(test_name());
+    BOOST_TEST(!boost::timer::export_active());
+    BOOST_TEST(boost::timer::start_export(name, 0, 64));
+    BOOST_TEST(boost::timer::export_active());
+    BOOST_TEST_EQ(boost::timer::export_name(), name);
+
+    errno = 0;
+    BOOST_TEST(!boost::timer::start_export(name, 0, 64));
+    BOOST_TEST_EQ(errno, EBUSY);
+
+    region a("export.a");
+    region b("export.b");
+    region c("export.c", 16, boost::timer::random_sampling);
+    for (int i = 1; i <= 10; ++i)
+      a.add(make_times(10 * i, 2 * i, i));
+    b.add(make_times(500, 400, 100));
+    c.add(make_times(70, 60, 10));
+
+    export_snapshot snap;
+    BOOST_TEST(boost::timer::read_export(name, snap));
+    BOOST_TEST(find(snap.regions, "export.a") == 0);  // not yet published
+    const boost::uint64_t publications = snap.publications;
+    BOOST_TEST(publications >= 1);
+
+    boost::timer::publish_regions();
+    BOOST_TEST(boost::timer::read_export(name, snap));
+    BOOST_TEST_EQ(snap.pid, static_cast<boost::int_least64_t>(::getpid()));
+    BOOST_TEST_EQ(snap.minor_version, boost::timer::export_minor_version);
+    BOOST_TEST_EQ(snap.publications, publications + 1);
+    BOOST_TEST(snap.updated > 0);
+    BOOST_TEST(snap.region_count >= snap.regions.size());
+
+    const region_stats* s = find(snap.regions, "export.a");
+    BOOST_TEST(s != 0);
+    if (s)
+    {
+      BOOST_TEST_EQ(s->count, 10u);
+      BOOST_TEST_EQ(s->total.wall, 550);
+      BOOST_TEST_EQ(s->total.user, 110);
+      BOOST_TEST_EQ(s->total.system, 55);
+      BOOST_TEST_EQ(s->min.wall, 10);
+      BOOST_TEST_EQ(s->max.wall, 100);
+      BOOST_TEST_EQ(s->sampling_period, 1u);
+      BOOST_TEST(s->sampling == boost::timer::systematic_sampling);
+    }
+    s = find(snap.regions, "export.b");
+    BOOST_TEST(s != 0);
+    if (s)
+    {
+      BOOST_TEST_EQ(s->count, 1u);
+      BOOST_TEST_EQ(s->total.user, 400);
+    }
+    s = find(snap.regions, "export.c");  // a reader can extrapolate a sampled region
+    BOOST_TEST(s != 0);
+    if (s)
+    {
+      BOOST_TEST_EQ(s->sampling_period, 16u);
+      BOOST_TEST(s->sampling == boost::timer::random_sampling);
+    }
+
+    b.add(make_times(500, 400, 100));
+    boost::timer::stop_export(false);  // publishes once more
+    BOOST_TEST(!boost::timer::export_active());
+    BOOST_TEST(boost::timer::export_name().empty());
+
+    BOOST_TEST(boost::timer::read_export(name, snap));  // kept for readers
+    s = find(snap.regions, "export.b");
+    BOOST_TEST(s != 0);
+    if (s)
+      BOOST_TEST_EQ(s->count, 2u);
+
+    BOOST_TEST(boost::timer::start_export(name, 0, 64));  // replaces it
+    boost::timer::stop_export();
+    errno = 0;
+    BOOST_TEST(!boost::timer::read_export(name, snap));
+    BOOST_TEST_EQ(errno, ENOENT);
+
+    cout << "  publish test complete" << endl;
+  }
+
+  void concurrent_test()
+  {
+    cout << "concurrent test..." << endl;
+
+    const std::string name(test_name());
+    BOOST_TEST(boost::timer::start_export(name, 1, 64));
+
+    //  Every addition adds the same amount to each field, so a torn read would show
+    //  as totals that differ, or that are not a multiple of the count.
+    region r("export.concurrent");
+    std::atomic<bool> done(false);
+    std::thread writer([&r, &done]
+    {
+      for (int i = 0; i < 200000; ++i)
+        r.add(make_times(3, 3, 3));
+      done = true;
+    });
+
+    export_snapshot snap;
+    int reads = 0;
+    boost::uint64_t last = 0;
+    while (!done)
+    {
+      BOOST_TEST(boost::timer::read_export(name, snap));
+      ++reads;
+      const region_stats* s = find(snap.regions, "export.concurrent");
+      if (!s)
+        continue;
+      BOOST_TEST_EQ(s->total.wall, s->total.user);
+      BOOST_TEST_EQ(s->total.user, s->total.system);
+      BOOST_TEST_EQ(s->total.wall, static_cast<nanosecond_type>(3 * s->count));
+      BOOST_TEST(s->count >= last);
+      last = s->count;
+    }
+    writer.join();
+    boost::timer::stop_export();
+    cout << "  " << reads << " reads" << endl;
+
+    cout << "  concurrent test complete" << endl;
+  }
+
+  void error_test()
+  {
+    cout << "error test..." << endl;
+
+    errno = 0;
+    BOOST_TEST(!boost::timer::start_export(test_name(), 0, 0));
+    BOOST_TEST_EQ(errno, EINVAL);
+    BOOST_TEST(!boost::timer::export_active());
+
+    export_snapshot snap;
+    errno = 0;
+    BOOST_TEST(!boost::timer::read_export("/boost_timer_no_such_export", snap));
+    BOOST_TEST_EQ(errno, ENOENT);
+
+    boost::timer::stop_export();  // no effect
+    boost::timer::publish_regions();
+
+    cout << "  error test complete" << endl;
+  }
+
+} // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "---------------  region_export_test  ---------------\n";
+
+  publish_test();
+  concurrent_test();
+  error_test();
+
+  return ::boost::report_errors();
+}
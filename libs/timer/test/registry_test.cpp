@@ -0,0 +1,176 @@
+//  boost registry_test.cpp  -----------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/registry.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::region;
+using boost::timer::region_stats;
+
+namespace
+{
+  const region_stats* find(const std::vector<region_stats>& stats, const std::string& name)
+  {
+    for (std::size_t i = 0; i < stats.size(); ++i)
+      if (stats[i].name == name)
+        return &stats[i];
+    return 0;
+  }
+
+  cpu_times make_times(nanosecond_type wall, nanosecond_type user, nanosecond_type system)
+  {
+    cpu_times t;
+    t.wall = wall;
+    t.user = user;
+    t.system = system;
+    return t;
+  }
+
+  void registration_test()
+  {
+    cout << "registration test..." << endl;
+
+    region a("registration.a");
+    region b("registration.b");
+    region a2("registration.a");
+    BOOST_TEST_EQ(a.id(), a2.id());
+    BOOST_TEST(a.id() != b.id());
+    BOOST_TEST_EQ(a.name(), std::string("registration.a"));
+    BOOST_TEST(boost::timer::max_regions() > 0);
+
+    std::vector<region_stats> stats;
+    boost::timer::snapshot_regions(stats);
+    const region_stats* s = find(stats, "registration.b");
+    BOOST_TEST(s != 0);
+    if (s)
+    {
+      BOOST_TEST_EQ(s->count, 0u);
+      BOOST_TEST_EQ(s->total.wall, 0);
+    }
+
+    cout << "  registration test complete" << endl;
+  }
+
+  void accumulate(const region& r, int n, nanosecond_type base)
+  {
+    for (int i = 1; i <= n; ++i)
+      r.add(make_times(base + i, 2 * i, 3 * i));
+  }
+
+  void accumulation_test()
+  {
+    cout << "accumulation test..." << endl;
+
+    const int n = 10000;
+    const int threads = 4;
+    region r("accumulation");
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+      workers.push_back(std::thread(accumulate, std::cref(r), n, t * 1000));
+
+    // snapshots taken while the workers run must be internally consistent
+    for (int i = 0; i < 100; ++i)
+    {
+      std::vector<region_stats> stats;
+      boost::timer::snapshot_regions(stats);
+      const region_stats* s = find(stats, "accumulation");
+      BOOST_TEST(s != 0);
+      if (s && s->count)
+      {
+        BOOST_TEST(s->min.user <= s->max.user);
+        BOOST_TEST(s->total.system == s->total.user / 2 * 3);
+      }
+    }
+
+    for (std::size_t t = 0; t < workers.size(); ++t)
+      workers[t].join();
+
+    std::vector<region_stats> stats;
+    boost::timer::snapshot_regions(stats);
+    const region_stats* s = find(stats, "accumulation");
+    BOOST_TEST(s != 0);
+    if (s)
+    {
+      const nanosecond_type sum = nanosecond_type(n) * (n + 1) / 2;
+      BOOST_TEST_EQ(s->count, boost::uint64_t(n) * threads);
+      BOOST_TEST_EQ(s->total.user, 2 * sum * threads);
+      BOOST_TEST_EQ(s->total.system, 3 * sum * threads);
+      BOOST_TEST_EQ(s->total.wall, sum * threads + nanosecond_type(n) * 1000 * 6);
+      BOOST_TEST_EQ(s->min.wall, 1);
+      BOOST_TEST_EQ(s->max.wall, 3000 + n);
+      BOOST_TEST_EQ(s->min.user, 2);
+      BOOST_TEST_EQ(s->max.system, 3 * n);
+    }
+
+    // slots of exited threads are reused, without losing what they accumulated
+    std::thread(accumulate, std::cref(r), 1, 0).join();
+    boost::timer::snapshot_regions(stats);
+    s = find(stats, "accumulation");
+    BOOST_TEST(s != 0);
+    if (s)
+      BOOST_TEST_EQ(s->count, boost::uint64_t(n) * threads + 1);
+
+    cout << "  accumulation test complete" << endl;
+  }
+
+  void scoped_test()
+  {
+    cout << "scoped region test..." << endl;
+
+    for (int i = 0; i < 3; ++i)
+    {
+      BOOST_TIMER_SCOPED_REGION("scoped");
+      boost::timer::wall_timer t;
+      while (t.elapsed().wall < 1000000) {}
+    }
+    {
+      region r("scoped.thread");
+      boost::timer::scoped_thread_region_timer scope(r);
+      BOOST_TEST(!scope.timer().is_stopped());
+    }
+
+    std::vector<region_stats> stats;
+    boost::timer::snapshot_regions(stats);
+    const region_stats* s = find(stats, "scoped");
+    BOOST_TEST(s != 0);
+    if (s)
+    {
+      cout << "  scoped total:" << boost::timer::format(s->total);
+      BOOST_TEST_EQ(s->count, 3u);
+      BOOST_TEST(s->min.wall >= 1000000);
+      BOOST_TEST(s->total.wall >= 3000000);
+    }
+    s = find(stats, "scoped.thread");
+    BOOST_TEST(s != 0 && s->count == 1u);
+
+    cout << "  scoped region test complete" << endl;
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "----------  registry_test  ----------\n";
+
+  registration_test();
+  accumulation_test();
+  scoped_test();
+
+  return ::boost::report_errors();
+}
@@ -0,0 +1,194 @@
+//  boost resource_timer_test.cpp  -----------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/resource_timer.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+using std::string;
+using std::cout;
+using std::endl;
+using boost::timer::cpu_times;
+using boost::timer::format_extras;
+using boost::timer::resource_usage;
+using boost::timer::resource_timer;
+
+namespace
+{
+  void format_test()
+  {
+    cout << "format test..." << endl;
+
+    cpu_times times;
+    times.wall = 2000000000LL;
+    times.user = 1000000000LL;
+    times.system = 500000000LL;
+    resource_usage usage;
+    usage.minor_faults = 1;
+    usage.major_faults = 2;
+    usage.voluntary_switches = 3;
+    usage.involuntary_switches = 4;
+    usage.block_inputs = 5;
+    usage.block_outputs = 6;
+    usage.max_rss = -7;
+
+    format_extras extras;
+    extras.usage = &usage;
+    const string fmt("%ws %f %F %c %C %i %o %m %%f %x");
+    BOOST_TEST_EQ(boost::timer::format(times, extras, 1, fmt),
+      "2.0s 1 2 3 4 5 6 -7 %1 %x");
+    BOOST_TEST_EQ(boost::timer::format(times, extras, 1,
+      boost::timer::parsed_format(fmt).view()), "2.0s 1 2 3 4 5 6 -7 %1 %x");
+
+    //  without a resource_usage, its fields are n/a
+    const format_extras none;
+    BOOST_TEST_EQ(boost::timer::format(times, none, 1, "%f|%m|%t"), "n/a|n/a|1.5");
+
+    //  without extras, the extended fields are literal text, as they always were
+    BOOST_TEST_EQ(boost::timer::format(times, 1, "%f|%m|%t"), "%f|%m|1.5");
+    BOOST_TEST_EQ(boost::timer::format(times, 1,
+      boost::timer::parsed_format("%f|%m|%t").view()), "%f|%m|1.5");
+
+    boost::timer::parsed_format parsed("a%Cb");
+    BOOST_TEST_EQ(parsed.end() - parsed.begin(), 2);
+    BOOST_TEST_EQ(parsed.begin()->field, 'C');
+
+    char buf[8];
+    BOOST_TEST_EQ(boost::timer::format_to(buf, sizeof(buf), times, extras, 3,
+      string("%f faults")), 8u);
+    BOOST_TEST_EQ(string(buf), "1 fault");
+
+    cout << "  format test complete" << endl;
+  }
+
+  void process_test()
+  {
+    cout << "process test..." << endl;
+
+    resource_usage current;
+    if (!boost::timer::current_resource_usage(current))
+    {
+      cout << "  resource usage not available; skipped" << endl;
+      resource_timer t;
+      BOOST_TEST(!t.has_usage());
+      BOOST_TEST(t.format(3, "%f").find("n/a") == 0);
+      return;
+    }
+
+    resource_timer t;
+    BOOST_TEST(t.has_usage());
+    BOOST_TEST(t.scope() == boost::timer::process_resources);
+
+    //  touching fresh pages faults them in, and raises the peak resident set
+    const std::size_t size = 64 * 1024 * 1024;
+    char* p = new char[size];
+    std::memset(p, 1, size);
+    t.stop();
+    BOOST_TEST(p[size - 1] == 1);
+    delete [] p;
+
+    resource_usage usage = t.elapsed_usage();
+    cout << "  " << t.format(3);
+    BOOST_TEST(usage.minor_faults + usage.major_faults >= 1000);
+    BOOST_TEST(usage.max_rss >= 32 * 1024);
+    BOOST_TEST(usage.voluntary_switches >= 0);
+    BOOST_TEST(t.elapsed().wall > 0);
+
+    //  stopped timers report what they captured
+    resource_usage again = t.elapsed_usage();
+    BOOST_TEST_EQ(again.minor_faults, usage.minor_faults);
+    BOOST_TEST_EQ(again.max_rss, usage.max_rss);
+
+    //  resuming continues the count; no pages are touched while stopped
+    t.resume();
+    BOOST_TEST(!t.is_stopped());
+    BOOST_TEST(t.elapsed_usage().minor_faults >= usage.minor_faults);
+    t.stop();
+
+    cout << "  process test complete" << endl;
+  }
+
+  void thread_test()
+  {
+    cout << "thread test..." << endl;
+
+    resource_timer t(boost::timer::thread_resources);
+    BOOST_TEST(t.scope() == boost::timer::thread_resources);
+    if (!t.has_usage())
+    {
+      cout << "  thread resource usage not available; skipped" << endl;
+      return;
+    }
+    const std::size_t size = 16 * 1024 * 1024;
+    char* p = new char[size];
+    std::memset(p, 1, size);
+    t.stop();
+    BOOST_TEST(p[0] == 1);
+    delete [] p;
+    cout << "  " << t.format(3);
+    BOOST_TEST(t.elapsed_usage().minor_faults >= 100);
+
+    cout << "  thread test complete" << endl;
+  }
+
+  //  the actions and overhead subtraction shared by the counter timers
+  void actions_test()
+  {
+    cout << "actions test..." << endl;
+
+    resource_timer t;
+    BOOST_TEST(!t.subtracts_overhead());
+    const cpu_times& stopped = t.stop();
+    BOOST_TEST(t.is_stopped());
+    BOOST_TEST_EQ(stopped.wall, t.elapsed().wall);
+    BOOST_TEST_EQ(&t.stop(), &stopped);  // stopping again changes nothing
+    BOOST_TEST(stopped.wall >= 0);
+
+    //  overhead subtraction reaches zero for an empty region, as basic_cpu_timer's does
+    const cpu_times& overhead
+      = boost::timer::timer_overhead<boost::timer::process_times_policy>().overhead;
+    resource_timer empty;
+    empty.subtract_overhead();
+    BOOST_TEST(empty.subtracts_overhead());
+    cpu_times corrected = empty.stop();
+    cout << "  empty region: " << corrected.wall << "ns corrected wall, overhead "
+         << overhead.wall << "ns" << endl;
+    BOOST_TEST(corrected.wall >= 0);
+    BOOST_TEST(corrected.user >= 0);
+    BOOST_TEST(corrected.system >= 0);
+
+    //  resuming accumulates, and the thread scope corrects by thread_times_policy's
+    resource_timer r(boost::timer::thread_resources);
+    r.subtract_overhead();
+    r.stop();
+    cpu_times first = r.elapsed();
+    r.resume();
+    BOOST_TEST(!r.is_stopped());
+    BOOST_TEST(r.stop().wall >= first.wall);
+
+    cout << "  actions test complete" << endl;
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "----------  resource_timer test  ----------" << endl;
+
+  format_test();
+  process_test();
+  thread_test();
+  actions_test();
+
+  cout << "----------  resource_timer test complete  ----------" << endl;
+  return ::boost::report_errors();
+}
@@ -0,0 +1,283 @@
+//  boost sampled_timer_test.cpp  ------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/sampled_timer.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::region;
+using boost::timer::region_stats;
+using boost::timer::sampled_region;
+using boost::timer::sampled_estimate;
+
+namespace
+{
+  const region_stats* find(const std::vector<region_stats>& stats, const std::string& name)
+  {
+    for (std::size_t i = 0; i < stats.size(); ++i)
+      if (stats[i].name == name)
+        return &stats[i];
+    return 0;
+  }
+
+  //  a clock the test advances, so that durations are known exactly
+  nanosecond_type fake_now = 0;
+
+  struct fake_policy
+  {
+    static void get(cpu_times& current)
+    {
+      current.wall = fake_now;
+      current.user = fake_now / 2;
+      current.system = 0;
+    }
+  };
+
+  nanosecond_type duration(int i)  // varies, but not in step with the periods tested
+  {
+    return (i * 37 % 11 + 1) * 100;
+  }
+
+  void registration_test()
+  {
+    cout << "registration test..." << endl;
+
+    sampled_region a("sampled.registration", 8);
+    sampled_region a2("sampled.registration", 8);
+    BOOST_TEST_EQ(a.id(), a2.id());
+    BOOST_TEST_EQ(a.period(), 8u);
+    BOOST_TEST(a.method() == boost::timer::systematic_sampling);
+
+    bool thrown = false;
+    try { sampled_region b("sampled.registration", 4); }
+    catch (const std::invalid_argument&) { thrown = true; }
+    BOOST_TEST(thrown);
+    thrown = false;
+    try { region b("sampled.registration"); }
+    catch (const std::invalid_argument&) { thrown = true; }
+    BOOST_TEST(thrown);
+    thrown = false;
+    try { sampled_region b("sampled.zero", 0); }
+    catch (const std::invalid_argument&) { thrown = true; }
+    BOOST_TEST(thrown);
+
+    std::vector<region_stats> stats;
+    boost::timer::snapshot_regions(stats);
+    const region_stats* s = find(stats, "sampled.registration");
+    BOOST_TEST(s != 0);
+    if (s)
+    {
+      BOOST_TEST_EQ(s->sampling_period, 8u);
+      BOOST_TEST(s->sampling == boost::timer::systematic_sampling);
+    }
+
+    cout << "  registration test complete" << endl;
+  }
+
+  void interval_test()
+  {
+    cout << "interval test..." << endl;
+
+    sampled_region every("interval.systematic", 16);
+    BOOST_TEST_EQ(every.next_interval(), 16);
+
+    sampled_region random("interval.random", 16, boost::timer::random_sampling);
+    const int draws = 100000;
+    double sum = 0.0;
+    boost::int_least32_t least = 16;
+    for (int i = 0; i < draws; ++i)
+    {
+      boost::int_least32_t k = random.next_interval();
+      sum += k;
+      if (k < least)
+        least = k;
+    }
+    cout << "  mean random interval " << sum / draws << endl;
+    BOOST_TEST_EQ(least, 1);
+    BOOST_TEST(std::fabs(sum / draws - 16.0) < 0.5);
+
+    sampled_region always("interval.always", 1, boost::timer::random_sampling);
+    BOOST_TEST_EQ(always.next_interval(), 1);
+
+    cout << "  interval test complete" << endl;
+  }
+
+  void countdown_test()
+  {
+    cout << "countdown test..." << endl;
+
+    sampled_region r("countdown", 4);
+    boost::int_least32_t countdown = 0;
+    int sampled = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+      boost::timer::basic_scoped_sampled_timer<fake_policy> t(r, countdown);
+      if (t.is_sampled())
+      {
+        BOOST_TEST_EQ(i % 4, 0);
+        ++sampled;
+      }
+      fake_now += 100;
+    }
+    BOOST_TEST_EQ(sampled, 25);
+
+    std::vector<region_stats> stats;
+    boost::timer::snapshot_regions(stats);
+    const region_stats* s = find(stats, "countdown");
+    BOOST_TEST(s != 0);
+    if (s)
+    {
+      BOOST_TEST_EQ(s->count, 25u);
+      BOOST_TEST_EQ(s->total.wall, 2500);
+      BOOST_TEST_EQ(s->sum_of_squares[0], 25 * 100.0 * 100.0);
+    }
+
+    cout << "  countdown test complete" << endl;
+  }
+
+  void estimate_test()
+  {
+    cout << "estimate test..." << endl;
+
+    region_stats s;
+    s.count = 100;
+    s.total.wall = 100 * 1000;
+    s.total.user = 0;
+    s.total.system = 0;
+    s.sum_of_squares[0] = 100 * 1000.0 * 1000.0;
+    s.sum_of_squares[1] = s.sum_of_squares[2] = 0.0;
+    s.sampling_period = 10;
+    s.sampling = boost::timer::systematic_sampling;
+
+    sampled_estimate e = boost::timer::estimate_totals(s);
+    BOOST_TEST_EQ(e.executions, 1000.0);
+    BOOST_TEST_EQ(e.total.wall, 1000000);
+    BOOST_TEST_EQ(e.error.wall, 0);  // every sample the same
+
+    s.sampling = boost::timer::random_sampling;
+    e = boost::timer::estimate_totals(s);
+    BOOST_TEST_EQ(e.total.wall, 1000000);
+    BOOST_TEST_EQ(e.error.wall,
+      static_cast<nanosecond_type>(1.96 * std::sqrt(10.0 * 9.0 * 1e8)));
+
+    s.sampling_period = 1;
+    e = boost::timer::estimate_totals(s);
+    BOOST_TEST_EQ(e.executions, 100.0);
+    BOOST_TEST_EQ(e.total.wall, 100000);
+    BOOST_TEST_EQ(e.error.wall, 0);
+
+    cout << "  estimate test complete" << endl;
+  }
+
+  //  Times the same executions both in full and sampled, and checks that the
+  //  extrapolation agrees with the full totals within its error bounds. Random
+  //  sampling is seeded differently each run, so is allowed twice the 95% bound.
+  void comparison_test(const char* name, boost::timer::sampling_method method)
+  {
+    cout << "comparison test, " << name << "..." << endl;
+
+    const std::string full_name = std::string(name) + ".full";
+    region full(full_name);
+    sampled_region sampled(name, 8, method);
+    boost::int_least32_t countdown = 0;
+    const int executions = 80000;
+
+    for (int i = 0; i < executions; ++i)
+    {
+      boost::timer::basic_scoped_region_timer<fake_policy> f(full);
+      boost::timer::basic_scoped_sampled_timer<fake_policy> t(sampled, countdown);
+      fake_now += duration(i);
+    }
+
+    std::vector<region_stats> stats;
+    boost::timer::snapshot_regions(stats);
+    const region_stats* fs = find(stats, full_name);
+    const region_stats* ss = find(stats, name);
+    BOOST_TEST(fs != 0 && ss != 0);
+    if (!fs || !ss)
+      return;
+
+    sampled_estimate e = boost::timer::estimate_totals(*ss);
+    const nanosecond_type slack = method == boost::timer::random_sampling ? 2 : 1;
+    cout << "  full:    " << fs->count << " executions,"
+         << boost::timer::format(fs->total, 6, " %w s wall, %u s user") << endl;
+    cout << "  sampled: " << ss->count << " samples, estimated " << e.executions
+         << " executions," << boost::timer::format(e.total, 6, " %w s wall, %u s user")
+         << ", +/-" << boost::timer::format(e.error, 6, " %w s wall, %u s user") << endl;
+
+    BOOST_TEST(e.error.wall > 0);
+    BOOST_TEST(std::fabs(e.executions - executions) <= 4.0 * std::sqrt(8.0 * executions));
+    BOOST_TEST(std::llabs(e.total.wall - fs->total.wall) <= slack * e.error.wall);
+    BOOST_TEST(std::llabs(e.total.user - fs->total.user) <= slack * e.error.user + 8);
+    BOOST_TEST(e.error.wall < fs->total.wall / 20);  // and the bound is useful
+
+    cout << "  comparison test complete" << endl;
+  }
+
+  void macro_test()
+  {
+    cout << "macro test..." << endl;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+      BOOST_TIMER_SAMPLED_REGION("macro", 10);
+    }
+
+    std::vector<region_stats> stats;
+    boost::timer::snapshot_regions(stats);
+    const region_stats* s = find(stats, "macro");
+    BOOST_TEST(s != 0);
+    if (s)
+    {
+      BOOST_TEST_EQ(s->count, 100u);
+      BOOST_TEST_EQ(s->sampling_period, 10u);
+    }
+
+    for (int i = 0; i < 1000; ++i)
+    {
+      BOOST_TIMER_RANDOMLY_SAMPLED_REGION("macro.random", 10);
+    }
+    boost::timer::snapshot_regions(stats);
+    s = find(stats, "macro.random");
+    BOOST_TEST(s != 0);
+    if (s)
+    {
+      BOOST_TEST(s->count > 0 && s->count < 1000);
+      BOOST_TEST(s->sampling == boost::timer::random_sampling);
+    }
+
+    cout << "  macro test complete" << endl;
+  }
+
+} // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "---------------  sampled_timer_test  ---------------\n";
+
+  registration_test();
+  interval_test();
+  countdown_test();
+  estimate_test();
+  comparison_test("comparison.systematic", boost::timer::systematic_sampling);
+  comparison_test("comparison.random", boost::timer::random_sampling);
+  macro_test();
+
+  return ::boost::report_errors();
+}
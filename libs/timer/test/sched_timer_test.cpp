@@ -0,0 +1,126 @@
+//  boost sched_timer_test.cpp  --------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/sched_timer.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <boost/system/api_config.hpp>
+#include <iostream>
+#include <string>
+
+# if defined(BOOST_POSIX_API)
+#   include <unistd.h>
+# else
+#   include <windows.h>
+# endif
+
+using std::string;
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::format_extras;
+using boost::timer::sched_times;
+using boost::timer::sched_timer;
+
+namespace
+{
+  void burn(nanosecond_type ns)
+  {
+    boost::timer::wall_timer t;
+    while (t.elapsed().wall < ns) {}
+  }
+
+  void nap(unsigned ms)
+  {
+# if defined(BOOST_POSIX_API)
+    ::usleep(ms * 1000);
+# else
+    ::Sleep(ms);
+# endif
+  }
+
+  void format_test()
+  {
+    cout << "format test..." << endl;
+
+    cpu_times times;
+    times.wall = 3000000000LL;
+    times.user = 1000000000LL;
+    times.system = 0;
+    sched_times sched;
+    sched.running = 1000000000LL;
+    sched.runnable = 500000000LL;
+    sched.blocked = 1500000000LL;
+
+    format_extras extras;
+    extras.sched = &sched;
+    BOOST_TEST_EQ(boost::timer::format(times, extras, 1, "%ws %es %qs %bs %f"),
+      "3.0s 1.0s 0.5s 1.5s n/a");
+    BOOST_TEST_EQ(boost::timer::format(times, 1, "%e|%q|%b"), "%e|%q|%b");
+
+    cout << "  format test complete" << endl;
+  }
+
+  void breakdown_test()
+  {
+    cout << "breakdown test..." << endl;
+
+    sched_times current;
+    bool available = boost::timer::current_sched_times(current);
+    sched_timer t;
+    BOOST_TEST_EQ(t.has_sched(), available);
+    if (!available)
+    {
+      cout << "  scheduler statistics not available; skipped" << endl;
+      BOOST_TEST_EQ(t.format(3, "%e"), "n/a");
+      return;
+    }
+    BOOST_TEST(current.running >= 0);
+    BOOST_TEST_EQ(current.blocked, 0);
+
+    //  spinning is running, or runnable if the CPUs are busy; sleeping is blocked.
+    //  Time taken by a hypervisor shows as blocked, so spinning may too.
+    burn(100000000);
+    nap(200);
+    t.stop();
+    cout << "  " << t.format(3);
+
+    cpu_times times = t.elapsed();
+    sched_times sched = t.elapsed_sched();
+    BOOST_TEST(sched.running >= times.user + times.system - 20000000);
+    BOOST_TEST(sched.running <= times.user + times.system + 20000000);
+    BOOST_TEST(sched.running + sched.runnable < 200000000);
+    BOOST_TEST(sched.blocked >= 150000000);
+    BOOST_TEST(sched.running + sched.runnable + sched.blocked >= times.wall - 10000000);
+    BOOST_TEST(sched.running + sched.runnable + sched.blocked <= times.wall + 10000000);
+
+    //  resumed, the intervals accumulate
+    t.resume();
+    nap(100);
+    t.stop();
+    sched_times more = t.elapsed_sched();
+    BOOST_TEST(more.blocked >= sched.blocked + 80000000);
+    BOOST_TEST(more.running >= sched.running);
+
+    cout << "  breakdown test complete" << endl;
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "----------  sched_timer test  ----------" << endl;
+
+  format_test();
+  breakdown_test();
+
+  cout << "----------  sched_timer test complete  ----------" << endl;
+  return ::boost::report_errors();
+}
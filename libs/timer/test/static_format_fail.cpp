@@ -0,0 +1,18 @@
+//  boost static_format_fail.cpp  ------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+//  Must not compile: %x is not a format field.
+
+#include <boost/timer/static_format.hpp>
+
+int main()
+{
+  boost::timer::format_view v = boost::timer::fmt<" %ws wall, %xs CPU\n">;
+  return v.text != 0;
+}
@@ -0,0 +1,123 @@
+//  boost static_format_test.cpp  ------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/static_format.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using std::string;
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::format_view;
+using boost::timer::parsed_format;
+using boost::timer::fmt;
+
+namespace
+{
+  template <class Static>
+  void check_segments(const Static& f, const string& text)
+  {
+    const format_view sv = f;
+    parsed_format parsed(text);
+    BOOST_TEST_EQ(string(sv.text), text);
+    BOOST_TEST_EQ(sv.last - sv.first, parsed.end() - parsed.begin());
+    for (std::size_t i = 0;
+      i < static_cast<std::size_t>(sv.last - sv.first)
+        && i < static_cast<std::size_t>(parsed.end() - parsed.begin()); ++i)
+    {
+      BOOST_TEST_EQ(sv.first[i].literal_begin, parsed.begin()[i].literal_begin);
+      BOOST_TEST_EQ(sv.first[i].literal_size, parsed.begin()[i].literal_size);
+      BOOST_TEST_EQ(sv.first[i].field, parsed.begin()[i].field);
+    }
+  }
+
+  void parse_test()
+  {
+    cout << "parse test..." << endl;
+
+    // segments are computed at compile time
+    static_assert(fmt<"%w">.view().last - fmt<"%w">.view().first == 1, "");
+    static_assert(fmt<"">.view().last == fmt<"">.view().first, "");
+    static_assert(fmt<"a%wb%p%">.view().first[1].field == 'p', "");
+
+    check_segments(fmt<"">, "");
+    check_segments(fmt<"%w">, "%w");
+    check_segments(fmt<"%w%u%s%t%p">, "%w%u%s%t%p");
+    check_segments(fmt<"%f %F %c %C %i %o %m">, "%f %F %c %C %i %o %m");
+    check_segments(fmt<"%e %q %b">, "%e %q %b");
+    check_segments(fmt<"%R%W%d%D%y%Y%a%A">, "%R%W%d%D%y%Y%a%A");
+    check_segments(fmt<"%K%I%P%M%H%B%T%G%S">, "%K%I%P%M%H%B%T%G%S");
+    check_segments(fmt<"literal">, "literal");
+    check_segments(fmt<"100% %%p 5%">, "100% %%p 5%");
+    check_segments(fmt<"%">, "%");
+    check_segments(fmt<" %ws wall, %us user + %ss system = %ts CPU (%p%)\n">,
+      boost::timer::default_format());
+  }
+
+  void format_test()
+  {
+    cout << "format test..." << endl;
+
+    cpu_times times;
+    times.wall = 5123456789LL;
+    times.user = 2123456789LL;
+    times.system = 1234567890LL;
+    char buf[128];
+
+    for (short places = -1; places <= 10; ++places)
+    {
+      boost::timer::format_to(buf, sizeof(buf), times, places,
+        fmt<" %ws wall, %us user + %ss system = %ts CPU (%p%)\n">);
+      BOOST_TEST_EQ(string(buf), format(times, places));
+      BOOST_TEST_EQ(format(times, places, fmt<"%t/%w %%, 5%.">),
+        format(times, places, string("%t/%w %%, 5%.")));
+    }
+    BOOST_TEST_EQ(boost::timer::format_to(buf, 4, times, 3, fmt<"%w">), 5u);
+    BOOST_TEST_EQ(string(buf), string("5.1"));
+  }
+
+  void auto_timer_test()
+  {
+    cout << "auto_cpu_timer test..." << endl;
+
+    std::stringstream ss;
+    {
+      boost::timer::auto_cpu_timer t(ss, 2, fmt<"[%w %t]">);
+    }
+    const string s = ss.str();
+    BOOST_TEST_EQ(s[0], '[');
+    BOOST_TEST_EQ(s[s.size() - 1], ']');
+    BOOST_TEST(s.find(' ') != string::npos);
+    BOOST_TEST(s.find('%') == string::npos);
+
+    std::stringstream ts;
+    {
+      boost::timer::auto_thread_cpu_timer t(ts, 0, fmt<"%u">);
+      t.report();
+      t.stop();  // no second report from the destructor
+    }
+    BOOST_TEST_EQ(ts.str(), string("0"));
+  }
+}
+
+int cpp_main(int, char *[])
+{
+  cout << "----------  static_format_test  ----------\n";
+
+  parse_test();
+  format_test();
+  auto_timer_test();
+
+  return ::boost::report_errors();
+}
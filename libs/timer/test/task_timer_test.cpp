@@ -0,0 +1,240 @@
+//  boost task_timer_test.cpp  ---------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/task_timer.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <chrono>
+#include <coroutine>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using std::cout;
+using std::endl;
+using boost::timer::nanosecond_type;
+using boost::timer::cpu_times;
+using boost::timer::task_times;
+using boost::timer::task_timer;
+
+namespace
+{
+  const nanosecond_type ms = 1000000LL;
+
+  //  spins for at least n milliseconds of wall-clock time
+  void spin(int n)
+  {
+    boost::timer::wall_timer t;
+    volatile unsigned long x = 0;
+    while (t.elapsed().wall < n * ms)
+      for (int i = 0; i < 10000; ++i)
+        x = x + i;
+  }
+
+  void sleep(int n)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(n));
+  }
+
+  //  A task that starts eagerly and is left suspended at its end, for its timer to be
+  //  read.
+  struct task
+  {
+    struct promise_type : boost::timer::task_timer_promise
+    {
+      task get_return_object()
+      {
+        return task(std::coroutine_handle<promise_type>::from_promise(*this));
+      }
+      std::suspend_never initial_suspend() noexcept { return std::suspend_never(); }
+      std::suspend_always final_suspend() noexcept
+      {
+        timer().stop();
+        return std::suspend_always();
+      }
+      void return_void() {}
+      void unhandled_exception() { throw; }
+    };
+
+    explicit task(std::coroutine_handle<promise_type> h) : handle(h) {}
+    task(task&& t) : handle(t.handle)  { t.handle = 0; }
+   ~task()                             { if (handle) handle.destroy(); }
+
+    const task_timer& timer() const    { return handle.promise().timer(); }
+    bool done() const                  { return handle.done(); }
+
+    std::coroutine_handle<promise_type> handle;
+  };
+
+  //  Suspends, leaving the coroutine in a queue for the test to resume on a thread of
+  //  its choosing.
+  struct queue_awaiter
+  {
+    std::vector<std::coroutine_handle<> >& queue;
+
+    bool await_ready()                           { return false; }
+    void await_suspend(std::coroutine_handle<> h) { queue.push_back(h); }
+    int await_resume()                           { return 42; }
+  };
+
+  struct queue_awaitable  // awaited through its operator co_await
+  {
+    std::vector<std::coroutine_handle<> >& queue;
+    queue_awaiter operator co_await() const      { return queue_awaiter{queue}; }
+  };
+
+  struct declining_awaiter  // decides in await_suspend() not to suspend
+  {
+    bool await_ready()                           { return false; }
+    bool await_suspend(std::coroutine_handle<>)  { return false; }
+    void await_resume()                          {}
+  };
+
+  std::coroutine_handle<> pop(std::vector<std::coroutine_handle<> >& queue)
+  {
+    std::coroutine_handle<> h = queue.back();
+    queue.pop_back();
+    return h;
+  }
+
+  void timer_test()
+  {
+    cout << "timer test..." << endl;
+
+    task_timer t;
+    BOOST_TEST(t.is_running());
+    spin(20);
+    t.on_suspend();
+    BOOST_TEST(t.is_suspended());
+    t.on_suspend();  // no effect
+    sleep(30);
+    task_times times = t.elapsed();
+    BOOST_TEST_EQ(times.suspensions, 1u);
+    BOOST_TEST(times.suspended >= 30 * ms);
+    BOOST_TEST(times.active.wall >= 20 * ms);
+    BOOST_TEST(times.active.wall < 30 * ms + times.suspended);
+
+    t.on_resume();
+    BOOST_TEST(t.is_running());
+    t.on_resume();  // no effect
+    t.stop();
+    BOOST_TEST(t.is_stopped());
+    const task_times stopped = t.elapsed();
+    sleep(10);
+    times = t.elapsed();
+    BOOST_TEST_EQ(times.suspended, stopped.suspended);
+    BOOST_TEST_EQ(times.active.wall, stopped.active.wall);
+    t.on_resume();  // after stop(), not a suspension
+    t.stop();
+    BOOST_TEST_EQ(t.elapsed().suspensions, 1u);
+    BOOST_TEST_EQ(t.elapsed().suspended, stopped.suspended);
+
+    t.on_suspend();  // withdrawn
+    t.on_resume(false);
+    BOOST_TEST_EQ(t.elapsed().suspensions, 1u);
+
+    t.start(false);
+    BOOST_TEST(t.is_stopped());
+    BOOST_TEST_EQ(t.elapsed().active.wall, 0);
+    BOOST_TEST_EQ(t.elapsed().suspensions, 0u);
+
+    cout << "  timer test complete" << endl;
+  }
+
+  std::vector<std::coroutine_handle<> > queue;
+
+  task migrating(int& result)
+  {
+    spin(30);
+    result = co_await queue_awaiter{queue};     // resumed on another thread
+    spin(30);
+    result += co_await queue_awaitable{queue};  // resumed on this thread
+    spin(30);
+    co_await std::suspend_never();              // ready; no suspension
+    co_await declining_awaiter();               // suspension withdrawn
+  }
+
+  void migration_test()
+  {
+    cout << "migration test..." << endl;
+
+    int result = 0;
+    task t = migrating(result);
+    BOOST_TEST_EQ(queue.size(), 1u);
+    BOOST_TEST(t.timer().is_suspended());
+    sleep(50);
+
+    std::thread other([]
+    {
+      spin(50);  // not charged to the task
+      pop(queue).resume();
+    });
+    other.join();
+    BOOST_TEST_EQ(queue.size(), 1u);
+    sleep(50);
+    pop(queue).resume();
+    BOOST_TEST(t.done());
+    BOOST_TEST(t.timer().is_stopped());
+    BOOST_TEST_EQ(result, 84);
+
+    const task_times times = t.timer().elapsed();
+    const nanosecond_type cpu = times.active.user + times.active.system;
+    cout << "  active " << times.active.wall / ms << " ms wall, " << cpu / ms
+         << " ms CPU; suspended " << times.suspended / ms << " ms, "
+         << times.suspensions << " times" << endl;
+    BOOST_TEST_EQ(times.suspensions, 2u);
+    BOOST_TEST(times.suspended >= 150 * ms);  // 50 + 50 spinning + 50
+    BOOST_TEST(times.active.wall >= 90 * ms);
+
+    //  The CPU time charged is the task's own, at most its active wall time, allowing
+    //  for a coarse thread clock, and not the other thread's spinning.
+    BOOST_TEST(cpu <= times.active.wall + 20 * ms);
+    BOOST_TEST(cpu < 130 * ms || times.active.wall >= 130 * ms);
+    cout << "  " << t.timer().format(3, "  %ws wall, %ts CPU (%p%)\n");
+
+    cout << "  migration test complete" << endl;
+  }
+
+  task awaiting_lvalue(queue_awaiter& a, task_timer& manual)
+  {
+    co_await a;  // the awaiter is used in place
+    co_await boost::timer::timed(manual, queue_awaitable{queue});
+  }
+
+  void timed_test()
+  {
+    cout << "timed test..." << endl;
+
+    queue_awaiter a{queue};
+    task_timer manual(false);
+    task t = awaiting_lvalue(a, manual);
+    BOOST_TEST_EQ(queue.size(), 1u);
+    pop(queue).resume();
+    BOOST_TEST_EQ(t.timer().elapsed().suspensions, 2u);  // transformed twice
+    BOOST_TEST(manual.is_stopped());  // on_suspend() had no effect
+    pop(queue).resume();
+    BOOST_TEST(t.done());
+    BOOST_TEST(manual.is_running());
+    BOOST_TEST_EQ(manual.elapsed().suspensions, 0u);
+
+    cout << "  timed test complete" << endl;
+  }
+
+} // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "---------------  task_timer_test  ---------------\n";
+
+  timer_test();
+  migration_test();
+  timed_test();
+
+  return ::boost::report_errors();
+}
@@ -0,0 +1,194 @@
+//  boost trace_test.cpp  --------------------------------------------------------------//
+
+//  Copyright Beman Dawes 2011
+
+//  Distributed under the Boost Software License, Version 1.0.
+//  See http://www.boost.org/LICENSE_1_0.txt
+
+//  See http://www.boost.org/libs/timer for documentation.
+
+#include <boost/timer/trace.hpp>
+#include <boost/detail/lightweight_main.hpp>
+#include <boost/detail/lightweight_test.hpp>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::cout;
+using std::endl;
+
+namespace
+{
+  const char* const path = "trace_test.bttrace";
+
+  std::size_t count(const string& s, const string& what)
+  {
+    std::size_t n = 0;
+    for (string::size_type pos = s.find(what); pos != string::npos;
+         pos = s.find(what, pos + what.size()))
+      ++n;
+    return n;
+  }
+
+  string convert()
+  {
+    std::ifstream in(path, std::ios_base::binary);
+    std::ostringstream out;
+    BOOST_TEST(boost::timer::write_chrome_trace(in, out));
+    return out.str();
+  }
+
+  void work(int n)
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      BOOST_TIMER_TRACE_SCOPE("work \"item\"");
+      BOOST_TIMER_TRACE_SCOPE("inner");
+    }
+  }
+
+  void inactive_test()
+  {
+    cout << "inactive test..." << endl;
+
+    BOOST_TEST(!boost::timer::trace_active());
+    work(10);  // records nothing, and does not fail
+    std::istringstream not_a_trace("not a trace file, but long enough for a header");
+    std::ostringstream out;
+    BOOST_TEST(!boost::timer::write_chrome_trace(not_a_trace, out));
+    BOOST_TEST(out.str().empty());
+
+    errno = 0;
+    BOOST_TEST(!boost::timer::start_trace(path, 16));
+    BOOST_TEST_EQ(errno, EINVAL);
+    BOOST_TEST(!boost::timer::start_trace("no-such-directory/trace.bttrace"));
+    BOOST_TEST(!boost::timer::trace_active());
+
+    cout << "  inactive test complete" << endl;
+  }
+
+  void threads_test()
+  {
+    cout << "threads test..." << endl;
+
+    BOOST_TEST(boost::timer::start_trace(path));
+    BOOST_TEST(boost::timer::trace_active());
+    errno = 0;
+    BOOST_TEST(!boost::timer::start_trace(path));
+    BOOST_TEST_EQ(errno, EBUSY);
+
+    static const boost::timer::trace_name mark("mark");
+    boost::timer::trace_instant(mark);
+
+    //  enough records to fill some buffers, and leave some for thread exit
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+      threads.push_back(std::thread(work, 3000));
+    work(100);
+    for (std::size_t i = 0; i < threads.size(); ++i)
+      threads[i].join();
+    boost::timer::stop_trace();
+    BOOST_TEST(!boost::timer::trace_active());
+    BOOST_TEST_EQ(boost::timer::trace_dropped(), 0u);
+
+    string json = convert();
+    BOOST_TEST_EQ(json.find("{\"displayTimeUnit\": \"ns\", \"traceEvents\": ["), 0u);
+    BOOST_TEST_EQ(count(json, "\"ph\": \"B\""), 2u * 12100);
+    BOOST_TEST_EQ(count(json, "\"ph\": \"E\""), 2u * 12100);
+    BOOST_TEST_EQ(count(json, "\"name\": \"work \\\"item\\\"\", \"ph\": \"B\""), 12100u);
+    BOOST_TEST_EQ(count(json, "\"name\": \"inner\", \"ph\": \"E\""), 12100u);
+    BOOST_TEST_EQ(count(json, "\"name\": \"mark\", \"ph\": \"i\""), 1u);
+    BOOST_TEST_EQ(count(json, "\"s\": \"t\""), 1u);
+    for (int tid = 1; tid <= 5; ++tid)  // in some order
+    {
+      std::ostringstream ss;
+      ss << "\"tid\": " << tid << '}';
+      BOOST_TEST(count(json, ss.str()) > 0);
+    }
+    BOOST_TEST_EQ(json.substr(json.size() - 4), "\n]}\n");
+
+    cout << "  threads test complete" << endl;
+  }
+
+  //  The file written by threads_test, with a name record appended
+  bool convert_with_name(boost::uint32_t id, boost::uint8_t size)
+  {
+    std::ifstream in(path, std::ios_base::binary);
+    std::ostringstream file;
+    file << in.rdbuf();
+    boost::timer::trace_record r;
+    r.kind = boost::timer::name_record;
+    r.size = size;
+    r.thread = 0;
+    r.name = id;
+    r.time = 0;
+    file.write(reinterpret_cast<const char*>(&r), sizeof(r));
+    std::istringstream trace(file.str());
+    std::ostringstream out;
+    return boost::timer::write_chrome_trace(trace, out);
+  }
+
+  void corrupt_test()
+  {
+    cout << "corrupt test..." << endl;
+
+    BOOST_TEST(convert_with_name(1, 8));      // more of the first name
+    BOOST_TEST(convert_with_name(4, 0));      // the next name
+    BOOST_TEST(!convert_with_name(0, 1));
+    BOOST_TEST(!convert_with_name(5, 1));     // ids are written in order
+    BOOST_TEST(!convert_with_name(0xffffffffu, 1));
+    BOOST_TEST(!convert_with_name(1, 9));     // longer than a record holds
+
+    cout << "  corrupt test complete" << endl;
+  }
+
+  void overflow_test()
+  {
+    cout << "overflow test..." << endl;
+
+    //  room for the header, the names so far, and few events; work(1000) fills no
+    //  buffer, so its records are all appended, and mostly dropped, by stop_trace()
+    BOOST_TEST(boost::timer::start_trace(path, 32 + 16 * 40));
+    work(1000);
+    boost::timer::stop_trace();
+    BOOST_TEST(boost::timer::trace_dropped() > 0u);
+
+    std::ifstream in(path, std::ios_base::binary | std::ios_base::ate);
+    BOOST_TEST(static_cast<long>(in.tellg()) <= 32 + 16 * 40);
+    in.close();
+    string json = convert();  // the records that fit are still usable
+    BOOST_TEST(count(json, "\"ph\": \"B\"") <= 40u);
+
+    //  a later trace starts afresh
+    BOOST_TEST(boost::timer::start_trace(path));
+    BOOST_TEST_EQ(boost::timer::trace_dropped(), 0u);
+    work(1);
+    boost::timer::stop_trace();
+    json = convert();
+    BOOST_TEST_EQ(count(json, "\"ph\": \"B\""), 2u);
+    BOOST_TEST_EQ(count(json, "\"name\": \"mark\""), 0u);  // registered, but unused
+
+    cout << "  overflow test complete" << endl;
+  }
+
+}  // unnamed namespace
+
+int cpp_main(int, char *[])
+{
+  cout << "----------  trace test  ----------" << endl;
+
+  inactive_test();
+  threads_test();
+  corrupt_test();
+  overflow_test();
+  std::remove(path);
+
+  cout << "----------  trace test complete  ----------" << endl;
+  return ::boost::report_errors();
+}